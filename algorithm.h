@@ -0,0 +1,199 @@
+/***********************************************************************
+ * Header:
+ *    ALGORITHM
+ * Summary:
+ *    Segmented versions of the standard algorithms. A deque iterator
+ *    knows the contiguous blocks between itself and another iterator,
+ *    so these algorithms hand each block to the standard algorithm as
+ *    a pair of pointers. The inner loops are then plain pointer loops
+ *    the compiler can vectorize. Any other iterator goes straight to
+ *    the standard algorithm.
+ *
+ *    This will contain the definition of:
+ *        custom::copy       : std::copy one block at a time
+ *        custom::fill       : std::fill one block at a time
+ *        custom::for_each   : std::for_each one block at a time
+ *        custom::find       : std::find one block at a time
+ *        custom::accumulate : std::accumulate one block at a time
+ *        custom::equal      : std::equal one block at a time
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>   // for std::copy, std::fill, std::find, ...
+#include <numeric>     // for std::accumulate
+#include <iterator>    // for std::iterator_traits
+#include <type_traits> // for std::true_type
+#include <functional>  // for std::plus, std::ref
+
+namespace custom
+{
+
+/******************************************************
+ * IS SEGMENTED
+ * Does an iterator hand out its contiguous segments,
+ * that is, does it.segments(last) exist?
+ *****************************************************/
+   template <typename It, typename = void>
+   struct is_segmented : std::false_type {};
+
+   template <typename It>
+   struct is_segmented<It, decltype((void)std::declval<const It&>().segments(std::declval<const It&>()))>
+      : std::true_type {};
+
+   /*****************************************
+    * COPY
+    * Copy [first, last) to out
+    ****************************************/
+   template <typename InputIt, typename OutputIt>
+   OutputIt copy(InputIt first, InputIt last, OutputIt out)
+   {
+      if constexpr (is_segmented<InputIt>::value)
+      {
+         for (auto seg : first.segments(last))
+            out = custom::copy(seg.begin(), seg.end(), out);
+         return out;
+      }
+      else if constexpr (is_segmented<OutputIt>::value &&
+                         std::is_base_of<std::random_access_iterator_tag,
+                            typename std::iterator_traits<InputIt>::iterator_category>::value)
+      {
+         OutputIt outLast = out + (last - first);
+         for (auto seg : out.segments(outLast))
+         {
+            std::copy(first, first + seg.size(), seg.begin());
+            first += seg.size();
+         }
+         return outLast;
+      }
+      else
+         return std::copy(first, last, out);
+   }
+
+   /*****************************************
+    * FILL
+    * Assign value to every element of [first, last)
+    ****************************************/
+   template <typename ForwardIt, typename T>
+   void fill(ForwardIt first, ForwardIt last, const T& value)
+   {
+      if constexpr (is_segmented<ForwardIt>::value)
+      {
+         for (auto seg : first.segments(last))
+            std::fill(seg.begin(), seg.end(), value);
+      }
+      else
+         std::fill(first, last, value);
+   }
+
+   /*****************************************
+    * FOR EACH
+    * Call f on every element of [first, last)
+    ****************************************/
+   template <typename InputIt, typename F>
+   F for_each(InputIt first, InputIt last, F f)
+   {
+      if constexpr (is_segmented<InputIt>::value)
+      {
+         for (auto seg : first.segments(last))
+            std::for_each(seg.begin(), seg.end(), std::ref(f));
+         return f;
+      }
+      else
+         return std::for_each(first, last, std::move(f));
+   }
+
+   /*****************************************
+    * FIND
+    * The first element of [first, last) equal to value
+    ****************************************/
+   template <typename InputIt, typename T>
+   InputIt find(InputIt first, InputIt last, const T& value)
+   {
+      if constexpr (is_segmented<InputIt>::value)
+      {
+         for (auto seg : first.segments(last))
+         {
+            auto it = std::find(seg.begin(), seg.end(), value);
+            if (it != seg.end())
+               return first + (it - seg.begin());
+            first += seg.size();
+         }
+         return last;
+      }
+      else
+         return std::find(first, last, value);
+   }
+
+   /*****************************************
+    * ACCUMULATE
+    * Fold [first, last) into init with op
+    ****************************************/
+   template <typename InputIt, typename T, typename BinaryOp>
+   T accumulate(InputIt first, InputIt last, T init, BinaryOp op)
+   {
+      if constexpr (is_segmented<InputIt>::value)
+      {
+         for (auto seg : first.segments(last))
+            init = std::accumulate(seg.begin(), seg.end(), std::move(init), op);
+         return init;
+      }
+      else
+         return std::accumulate(first, last, std::move(init), op);
+   }
+
+   template <typename InputIt, typename T>
+   T accumulate(InputIt first, InputIt last, T init)
+   {
+      return custom::accumulate(first, last, std::move(init), std::plus<>());
+   }
+
+   /*****************************************
+    * EQUAL
+    * Do [first1, last1) and the range at first2 match?
+    ****************************************/
+   template <typename InputIt1, typename InputIt2>
+   bool equal(InputIt1 first1, InputIt1 last1, InputIt2 first2)
+   {
+      if constexpr (is_segmented<InputIt1>::value)
+      {
+         for (auto seg : first1.segments(last1))
+         {
+            // a segmented first2 is random access, so it is walked by copy
+            if constexpr (is_segmented<InputIt2>::value)
+            {
+               if (!custom::equal(seg.begin(), seg.end(), first2))
+                  return false;
+               first2 += seg.size();
+            }
+            // anything else may be single-pass: carry on from where the
+            // comparison stopped
+            else
+            {
+               auto its = std::mismatch(seg.begin(), seg.end(), first2);
+               if (its.first != seg.end())
+                  return false;
+               first2 = its.second;
+            }
+         }
+         return true;
+      }
+      else if constexpr (is_segmented<InputIt2>::value &&
+                         std::is_base_of<std::random_access_iterator_tag,
+                            typename std::iterator_traits<InputIt1>::iterator_category>::value)
+      {
+         for (auto seg : first2.segments(first2 + (last1 - first1)))
+         {
+            if (!std::equal(first1, first1 + seg.size(), seg.begin()))
+               return false;
+            first1 += seg.size();
+         }
+         return true;
+      }
+      else
+         return std::equal(first1, last1, first2);
+   }
+
+} // namespace custom
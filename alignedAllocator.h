@@ -0,0 +1,355 @@
+/***********************************************************************
+ * Header:
+ *    ALIGNED ALLOCATOR
+ * Summary:
+ *    Allocators that control where a deque's blocks land. The aligned
+ *    allocator starts every block on an Align boundary (a cache line
+ *    by default) so a block's first SIMD load does not straddle two
+ *    lines. The huge page allocator does the same and carves large
+ *    blocks out of 2 MiB regions that the kernel is asked to back
+ *    with huge pages, so walking a multi-gigabyte deque takes one TLB
+ *    entry per 2 MiB rather than per 4 KiB.
+ *
+ *    Huge pages need mmap and madvise(MADV_HUGEPAGE). Without them
+ *    (Windows, or a kernel without transparent huge pages) the huge
+ *    page allocator is just the aligned allocator.
+ *
+ *    This will contain the definition of:
+ *        aligned_allocator   : Every allocation on an Align boundary
+ *        huge_page_arena     : 2 MiB regions carved into blocks
+ *        huge_page_allocator : Large blocks from the arena
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>     // for size_t
+#include <new>         // for ::operator new, std::align_val_t
+#include <mutex>       // for std::mutex
+#include <map>         // for the free lists and the regions
+#include <utility>     // for std::pair
+#include <cassert>
+#include <type_traits> // for std::true_type
+
+#if !defined(_WIN32)
+#include <sys/mman.h>  // for mmap, madvise
+#if defined(MADV_HUGEPAGE)
+#define DEQUE_HUGE_PAGES
+#endif
+#endif
+
+class TestAlignedAllocator;   // forward declaration for the unit tests
+
+namespace custom
+{
+
+/******************************************************
+ * ALIGNED ALLOCATOR
+ * Every allocation starts on an Align boundary. Align
+ * must be a power of two
+ *****************************************************/
+   template <typename T, size_t Align = 64>
+   class aligned_allocator
+   {
+      static_assert(Align > 0 && (Align & (Align - 1)) == 0, "alignment must be a power of two");
+   public:
+      typedef T value_type;
+      typedef std::true_type is_always_equal;
+      static constexpr size_t alignment = Align < alignof(T) ? alignof(T) : Align;
+
+      template <typename U>
+      struct rebind { typedef aligned_allocator<U, Align> other; };
+
+      aligned_allocator() noexcept {}
+      template <typename U>
+      aligned_allocator(const aligned_allocator<U, Align>&) noexcept {}
+
+      T* allocate(size_t n)
+      {
+         return (T*)::operator new(n * sizeof(T), std::align_val_t(alignment));
+      }
+      void deallocate(T* p, size_t) noexcept
+      {
+         ::operator delete(p, std::align_val_t(alignment));
+      }
+
+      template <typename U>
+      bool operator == (const aligned_allocator<U, Align>&) const { return true; }
+      template <typename U>
+      bool operator != (const aligned_allocator<U, Align>&) const { return false; }
+   };
+
+/******************************************************
+ * HUGE PAGE ARENA
+ * The process's 2 MiB regions. A request up to a region
+ * is carved from the current region, or failing that
+ * from the uncarved end of an earlier one, and a freed
+ * block waits on a free list for the next request of
+ * its size and alignment. Once every block of a region
+ * is free the region goes back to the kernel, except
+ * the current one, which is carved again from the
+ * start. Anything bigger than a region is its own run
+ * of regions, returned to the kernel when freed.
+ *****************************************************/
+   class huge_page_arena
+   {
+   public:
+      static constexpr size_t regionBytes = 2 * 1024 * 1024;
+
+      // never destroyed, so a block freed by another static's
+      // destructor at exit still has an arena to go back to
+      static huge_page_arena& instance()
+      {
+         static huge_page_arena* arena = new huge_page_arena;
+         return *arena;
+      }
+
+      huge_page_arena(const huge_page_arena&) = delete;
+      huge_page_arena& operator = (const huge_page_arena&) = delete;
+
+      void* allocate(size_t bytes, size_t align);
+      void deallocate(void* p, size_t bytes, size_t align) noexcept;
+
+   private:
+      friend class ::TestAlignedAllocator;
+
+      huge_page_arena() : pCurrent(nullptr) {}
+
+      struct node { node* next; };
+      typedef std::pair<size_t, size_t> size_class;  // bytes, alignment
+
+      // a region we carve blocks from
+      struct region
+      {
+         size_t numLive;     // blocks handed out and not yet freed
+         size_t tailBytes;   // the uncarved end of the region
+      };
+
+#ifdef DEQUE_HUGE_PAGES
+      static void* mapRegions(size_t bytes);
+      char* carve(char* base, size_t bytes, size_t align);
+      void releaseRegion(char* base) noexcept;
+
+      // the region a carved block sits in
+      static char* baseOf(void* p)
+      {
+         return (char*)((size_t)p & ~(regionBytes - 1));
+      }
+#endif
+
+      std::mutex mutex;                          // guards everything below
+      std::map<size_class, node*> freeLists;     // freed blocks by size class
+      std::map<char*, region> regions;           // every carved region by address
+      std::multimap<size_t, char*> tails;        // earlier regions' uncarved ends by size
+      char* pCurrent;                            // the region new blocks come from
+   };
+
+#ifdef DEQUE_HUGE_PAGES
+   /*****************************************
+    * HUGE PAGE ARENA :: MAP REGIONS
+    * Map bytes (a multiple of 2 MiB) on a 2 MiB
+    * boundary: map an extra region and trim the
+    * ends. The kernel only backs aligned 2 MiB
+    * ranges with huge pages
+    ****************************************/
+   inline void* huge_page_arena::mapRegions(size_t bytes)
+   {
+      size_t bytesMapped = bytes + regionBytes;
+      char* p = (char*)mmap(nullptr, bytesMapped, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == (char*)MAP_FAILED)
+         throw std::bad_alloc();
+
+      char* pAligned = (char*)(((size_t)p + regionBytes - 1) & ~(regionBytes - 1));
+      if (pAligned != p)
+         munmap(p, pAligned - p);
+      if (pAligned + bytes != p + bytesMapped)
+         munmap(pAligned + bytes, (p + bytesMapped) - (pAligned + bytes));
+
+      madvise(pAligned, bytes, MADV_HUGEPAGE);
+      return pAligned;
+   }
+
+   /*****************************************
+    * HUGE PAGE ARENA :: CARVE
+    * The next bytes on an align boundary from the
+    * uncarved end of the region at base, or null if
+    * they do not fit
+    ****************************************/
+   inline char* huge_page_arena::carve(char* base, size_t bytes, size_t align)
+   {
+      region& r = regions[base];
+      char* pEnd = base + regionBytes;
+      char* p = (char*)(((size_t)(pEnd - r.tailBytes) + align - 1) & ~(align - 1));
+      if (p + bytes > pEnd)
+         return nullptr;
+      r.tailBytes = pEnd - (p + bytes);
+      r.numLive++;
+      return p;
+   }
+
+   /*****************************************
+    * HUGE PAGE ARENA :: RELEASE REGION
+    * Every block of the region at base is free: take
+    * them off the free lists, then carve the current
+    * region again from the start or unmap any other
+    ****************************************/
+   inline void huge_page_arena::releaseRegion(char* base) noexcept
+   {
+      for (std::pair<const size_class, node*>& freeList : freeLists)
+         for (node** pp = &freeList.second; *pp; )
+            if (baseOf(*pp) == base)
+               *pp = (*pp)->next;
+            else
+               pp = &(*pp)->next;
+
+      region& r = regions[base];
+      if (base == pCurrent)
+      {
+         r.tailBytes = regionBytes;
+         return;
+      }
+
+      std::pair<std::multimap<size_t, char*>::iterator,
+                std::multimap<size_t, char*>::iterator> range = tails.equal_range(r.tailBytes);
+      for (std::multimap<size_t, char*>::iterator it = range.first; it != range.second; ++it)
+         if (it->second == base)
+         {
+            tails.erase(it);
+            break;
+         }
+      regions.erase(base);
+      munmap(base, regionBytes);
+   }
+#endif
+
+   /*****************************************
+    * HUGE PAGE ARENA :: ALLOCATE
+    * A block of bytes on an align boundary
+    ****************************************/
+   inline void* huge_page_arena::allocate(size_t bytes, size_t align)
+   {
+#ifdef DEQUE_HUGE_PAGES
+      bytes = (bytes + align - 1) & ~(align - 1);
+
+      // too big to carve: a run of regions of its own
+      if (bytes > regionBytes)
+         return mapRegions((bytes + regionBytes - 1) & ~(regionBytes - 1));
+
+      std::lock_guard<std::mutex> lock(mutex);
+      node*& freeList = freeLists[size_class(bytes, align)];
+      if (freeList)
+      {
+         node* p = freeList;
+         freeList = p->next;
+         regions[baseOf(p)].numLive++;
+         return p;
+      }
+
+      // 1. Carve from the current region
+      if (pCurrent)
+         if (char* p = carve(pCurrent, bytes, align))
+            return p;
+
+      // 2. Carve from the smallest earlier region's end that surely fits
+      std::multimap<size_t, char*>::iterator it = tails.lower_bound(bytes + align - 1);
+      if (it != tails.end())
+      {
+         char* base = it->second;
+         tails.erase(it);
+         char* p = carve(base, bytes, align);
+         assert(p != nullptr);
+         if (regions[base].tailBytes)
+            tails.insert(std::make_pair(regions[base].tailBytes, base));
+         return p;
+      }
+
+      // 3. Start a new region. The current one's end waits for a smaller request
+      char* base = (char*)mapRegions(regionBytes);
+      regions[base] = region{ 0, regionBytes };
+      if (pCurrent && regions[pCurrent].tailBytes)
+         tails.insert(std::make_pair(regions[pCurrent].tailBytes, pCurrent));
+      pCurrent = base;
+      return carve(base, bytes, align);
+#else
+      return ::operator new(bytes, std::align_val_t(align));
+#endif
+   }
+
+   /*****************************************
+    * HUGE PAGE ARENA :: DEALLOCATE
+    * Give back a block from allocate(bytes, align)
+    ****************************************/
+   inline void huge_page_arena::deallocate(void* p, size_t bytes, size_t align) noexcept
+   {
+#ifdef DEQUE_HUGE_PAGES
+      bytes = (bytes + align - 1) & ~(align - 1);
+      if (bytes > regionBytes)
+      {
+         munmap(p, (bytes + regionBytes - 1) & ~(regionBytes - 1));
+         return;
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      node*& freeList = freeLists[size_class(bytes, align)];
+      node* n = (node*)p;
+      n->next = freeList;
+      freeList = n;
+
+      region& r = regions[baseOf(p)];
+      assert(r.numLive > 0);
+      if (--r.numLive == 0)
+         releaseRegion(baseOf(p));
+#else
+      (void)bytes;
+      ::operator delete(p, std::align_val_t(align));
+#endif
+   }
+
+/******************************************************
+ * HUGE PAGE ALLOCATOR
+ * Allocations of HugeBytes or more come from the huge
+ * page arena, smaller ones (the map, small blocks) from
+ * the heap. Either way they start on an Align boundary.
+ * Give the deque blocks of at least HugeBytes:
+ *    deque<int, huge_page_allocator<int>, 65536>
+ *****************************************************/
+   template <typename T, size_t Align = 64, size_t HugeBytes = 64 * 1024>
+   class huge_page_allocator
+   {
+      static_assert(Align > 0 && (Align & (Align - 1)) == 0, "alignment must be a power of two");
+      static_assert(HugeBytes >= sizeof(void*), "huge blocks must hold a free list pointer");
+   public:
+      typedef T value_type;
+      typedef std::true_type is_always_equal;
+      static constexpr size_t alignment = Align < alignof(T) ? alignof(T) : Align;
+
+      template <typename U>
+      struct rebind { typedef huge_page_allocator<U, Align, HugeBytes> other; };
+
+      huge_page_allocator() noexcept {}
+      template <typename U>
+      huge_page_allocator(const huge_page_allocator<U, Align, HugeBytes>&) noexcept {}
+
+      T* allocate(size_t n)
+      {
+         if (n * sizeof(T) >= HugeBytes)
+            return (T*)huge_page_arena::instance().allocate(n * sizeof(T), alignment);
+         return (T*)::operator new(n * sizeof(T), std::align_val_t(alignment));
+      }
+      void deallocate(T* p, size_t n) noexcept
+      {
+         if (n * sizeof(T) >= HugeBytes)
+            huge_page_arena::instance().deallocate(p, n * sizeof(T), alignment);
+         else
+            ::operator delete(p, std::align_val_t(alignment));
+      }
+
+      template <typename U>
+      bool operator == (const huge_page_allocator<U, Align, HugeBytes>&) const { return true; }
+      template <typename U>
+      bool operator != (const huge_page_allocator<U, Align, HugeBytes>&) const { return false; }
+   };
+
+} // namespace custom
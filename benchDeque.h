@@ -0,0 +1,895 @@
+/***********************************************************************
+ * Header:
+ *    BENCH DEQUE
+ * Summary:
+ *    Timings for the deque. Build with BENCHMARK defined (and with
+ *    optimizations on) to run them from main.
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "deque.h"
+#include "algorithm.h"
+#include "blockPool.h"
+#include "alignedAllocator.h"
+#include "spscDeque.h"
+#include "workStealingDeque.h"
+#include "boundedDeque.h"
+#include "ringDeque.h"
+#include "mappedDeque.h"
+#include "spillDeque.h"
+#include "byteBuffer.h"
+
+#include <chrono>      // for std::chrono::steady_clock
+#include <iostream>    // for std::cout
+#include <iomanip>     // for std::setw
+#include <vector>
+#include <random>      // for std::mt19937
+#include <thread>      // for std::thread
+#include <mutex>       // for std::mutex
+#include <atomic>      // for std::atomic
+#include <memory>      // for std::unique_ptr
+#include <string>      // for std::to_string
+#include <cstdio>      // for std::remove
+#if defined(__linux__)
+#include <pthread.h>   // for pthread_setaffinity_np
+#endif
+
+/***********************************************
+ * BENCH DEQUE
+ * Each benchmark reports the best of a few runs
+ ***********************************************/
+class BenchDeque
+{
+public:
+   void run()
+   {
+      std::cout << "Deque benchmarks, " << numElements << " elements\n";
+
+      // Segmented algorithms
+      bench_accumulate();
+      bench_find();
+      bench_fill();
+      bench_forEach();
+      bench_copy();
+      bench_equal();
+
+      // Bulk insert
+      bench_append();
+
+      // Pipeline handoff
+      bench_splice();
+
+      // Copy
+      bench_copyConstruct();
+
+      // Many small deques
+      bench_blockPool();
+
+      // Huge pages
+      bench_hugePages();
+
+      // Sliding window
+      bench_window();
+
+      // Restart
+#ifdef DEQUE_POSIX
+      bench_mapped();
+      bench_snapshot();
+#endif
+
+      // Backlog past the memory budget
+#ifdef DEQUE_POSIX
+      bench_spill();
+#endif
+
+      // Socket buffer
+#ifdef DEQUE_POSIX
+      bench_relay();
+#endif
+
+      // Concurrent
+      bench_spsc();
+      bench_forkJoin();
+      bench_mpmc();
+   }
+
+private:
+   static const int numElements = 10000000;
+   static const int numRuns = 5;
+
+   /***************************************
+    * SEGMENTED ALGORITHMS
+    * std:: walks the deque an element at a time
+    * through its iterator, custom:: a block at a time
+    ***************************************/
+
+   void bench_accumulate()
+   {
+      custom::deque<int> d;
+      setup(d);
+      long long sum1 = 0;
+      long long sum2 = 0;
+      double msElement = time([&] { sum1 = std::accumulate(d.begin(), d.end(), 0LL); });
+      double msSegment = time([&] { sum2 = custom::accumulate(d.begin(), d.end(), 0LL); });
+      report("accumulate", msElement, msSegment, sum1 == sum2);
+   }
+
+   void bench_find()
+   {
+      custom::deque<int> d;
+      setup(d);
+      int missing = -1;
+      bool same = true;
+      double msElement = time([&] { same &= std::find(d.begin(), d.end(), missing) == d.end(); });
+      double msSegment = time([&] { same &= custom::find(d.begin(), d.end(), missing) == d.end(); });
+      report("find", msElement, msSegment, same);
+   }
+
+   void bench_fill()
+   {
+      custom::deque<int> d;
+      setup(d);
+      double msElement = time([&] { std::fill(d.begin(), d.end(), 7); });
+      double msSegment = time([&] { custom::fill(d.begin(), d.end(), 8); });
+      report("fill", msElement, msSegment, d.front() == 8 && d.back() == 8);
+   }
+
+   void bench_forEach()
+   {
+      custom::deque<int> d;
+      setup(d);
+      double msElement = time([&] { std::for_each(d.begin(), d.end(), [](int& v) { v *= 3; }); });
+      double msSegment = time([&] { custom::for_each(d.begin(), d.end(), [](int& v) { v *= 3; }); });
+      report("for_each", msElement, msSegment, true);
+   }
+
+   void bench_copy()
+   {
+      custom::deque<int> d;
+      setup(d);
+      std::vector<int> v1(numElements);
+      std::vector<int> v2(numElements);
+      double msElement = time([&] { std::copy(d.begin(), d.end(), v1.begin()); });
+      double msSegment = time([&] { custom::copy(d.begin(), d.end(), v2.begin()); });
+      report("copy", msElement, msSegment, v1 == v2);
+   }
+
+   void bench_equal()
+   {
+      custom::deque<int> d1;
+      setup(d1);
+      custom::deque<int> d2;
+      setup(d2);
+      bool same1 = false;
+      bool same2 = false;
+      double msElement = time([&] { same1 = std::equal(d1.begin(), d1.end(), d2.begin()); });
+      double msSegment = time([&] { same2 = custom::equal(d1.begin(), d1.end(), d2.begin()); });
+      report("equal", msElement, msSegment, same1 && same2);
+   }
+
+   /***************************************
+    * BULK INSERT
+    * push_back a batch one element at a time
+    * against append of the whole batch
+    ***************************************/
+
+   void bench_append()
+   {
+      std::vector<int> batch(100000);
+      for (int i = 0; i < (int)batch.size(); i++)
+         batch[i] = i;
+      const int numBatches = numElements / 100000;
+      size_t size1 = 0;
+      size_t size2 = 0;
+      double msElement = time([&]
+      {
+         custom::deque<int> d;
+         for (int b = 0; b < numBatches; b++)
+            for (int v : batch)
+               d.push_back(v);
+         size1 = d.size();
+      });
+      double msBulk = time([&]
+      {
+         custom::deque<int> d;
+         for (int b = 0; b < numBatches; b++)
+            d.append(batch.begin(), batch.end());
+         size2 = d.size();
+      });
+      report("append", msElement, msBulk, size1 == size2);
+   }
+
+   /***************************************
+    * PIPELINE HANDOFF
+    * A stage builds a batch and passes it on to
+    * the next stage's queue: an element at a time
+    * against splice_back
+    ***************************************/
+
+   void bench_splice()
+   {
+      std::vector<int> values(1000000);
+      for (int i = 0; i < (int)values.size(); i++)
+         values[i] = i;
+      const int numBatches = numElements / 1000000;
+      long long sum1 = 0;
+      long long sum2 = 0;
+      double msElement = time([&]
+      {
+         custom::deque<int> q;
+         for (int b = 0; b < numBatches; b++)
+         {
+            custom::deque<int> batch;
+            batch.append(values.begin(), values.end());
+            for (; !batch.empty(); batch.pop_front())
+               q.push_back(batch.front());
+         }
+         sum1 = custom::accumulate(q.begin(), q.end(), 0LL);
+      });
+      double msSplice = time([&]
+      {
+         custom::deque<int> q;
+         for (int b = 0; b < numBatches; b++)
+         {
+            custom::deque<int> batch;
+            batch.append(values.begin(), values.end());
+            q.splice_back(batch);
+         }
+         sum2 = custom::accumulate(q.begin(), q.end(), 0LL);
+      });
+      report("splice", msElement, msSplice, sum1 == sum2);
+   }
+
+   /***************************************
+    * COPY
+    * push_back every element of the source
+    * against the block-wise copy constructor
+    ***************************************/
+
+   void bench_copyConstruct()
+   {
+      custom::deque<int> dSrc;
+      setup(dSrc);
+      size_t size1 = 0;
+      size_t size2 = 0;
+      double msElement = time([&]
+      {
+         custom::deque<int> d;
+         for (int v : dSrc)
+            d.push_back(v);
+         size1 = d.size();
+      });
+      double msBlock = time([&]
+      {
+         custom::deque<int> d(dSrc);
+         size2 = d.size();
+      });
+      report("copy ctor", msElement, msBlock, size1 == size2);
+   }
+
+   /***************************************
+    * MANY SMALL DEQUES
+    * One short queue per connection, blocks
+    * from the heap against a shared pool
+    ***************************************/
+
+   void bench_blockPool()
+   {
+      const int numDeques = 20000;
+      long long sum1 = 0;
+      long long sum2 = 0;
+      double msHeap = time([&]
+      {
+         std::vector<custom::deque<int>> deques(numDeques);
+         sum1 = churn(deques);
+      });
+      custom::deque_block_pool pool(sizeof(int) * custom::deque_block<int>::numCells, 256);
+      double msPool = time([&]
+      {
+         std::vector<custom::pooled_deque<int>> deques;
+         deques.reserve(numDeques);
+         for (int i = 0; i < numDeques; i++)
+            deques.emplace_back(&pool);
+         sum2 = churn(deques);
+      });
+      report("block pool", msHeap, msPool, sum1 == sum2);
+   }
+
+   // traffic on every queue: a burst in, half of it out, then drain
+   template <typename Deque>
+   static long long churn(std::vector<Deque>& deques)
+   {
+      long long sum = 0;
+      for (int round = 0; round < 4; round++)
+         for (Deque& d : deques)
+         {
+            for (int i = 0; i < 300; i++)
+               d.push_back(i);
+            for (int i = 0; i < 150; i++)
+            {
+               sum += d.front();
+               d.pop_front();
+            }
+         }
+      for (Deque& d : deques)
+         d.clear();
+      return sum;
+   }
+
+   /***************************************
+    * HUGE PAGES
+    * Random reads across a deque too big for the
+    * TLB to cover with 4 KiB pages, against the
+    * same deque on 2 MiB pages
+    ***************************************/
+
+   void bench_hugePages()
+   {
+      const int numHuge = 128 * 1024 * 1024;  // 512 MiB of ints
+      std::vector<int> ids(numElements);
+      std::mt19937 random(42);
+      for (int& id : ids)
+         id = (int)(random() % numHuge);
+
+      long long sum1 = 0;
+      long long sum2 = 0;
+      double msSmall = 0.0;
+      double msHuge = 0.0;
+      {
+         custom::deque<int, std::allocator<int>, 65536> d;
+         d.append((size_t)numHuge, 1);
+         msSmall = time([&] { sum1 = gather(d, ids); });
+      }
+      {
+         custom::deque<int, custom::huge_page_allocator<int>, 65536> d;
+         d.append((size_t)numHuge, 1);
+         msHuge = time([&] { sum2 = gather(d, ids); });
+      }
+      report("huge pages", msSmall, msHuge, sum1 == sum2);
+   }
+
+   template <typename Deque>
+   static long long gather(const Deque& d, const std::vector<int>& ids)
+   {
+      long long sum = 0;
+      for (int id : ids)
+         sum += d[id];
+      return sum;
+   }
+
+   /***************************************
+    * SLIDING WINDOW
+    * Keep the last 1000 samples: push_back and
+    * pop_front once full against the ring deque
+    * overwriting its oldest
+    ***************************************/
+
+   void bench_window()
+   {
+      const size_t numWindow = 1000;
+      long long sum1 = 0;
+      long long sum2 = 0;
+      double msDeque = time([&]
+      {
+         custom::deque<int> d;
+         for (int i = 0; i < numElements; i++)
+         {
+            d.push_back(i);
+            if (d.size() > numWindow)
+               d.pop_front();
+         }
+         sum1 = custom::accumulate(d.begin(), d.end(), 0LL);
+      });
+      double msRing = time([&]
+      {
+         custom::ring_deque<int> d(numWindow);
+         for (int i = 0; i < numElements; i++)
+            d.push_back(i);
+         sum2 = 0;
+         for (size_t id = 0; id < d.size(); id++)
+            sum2 += d[id];
+      });
+      report("window", msDeque, msRing, sum1 == sum2);
+   }
+
+#ifdef DEQUE_POSIX
+   /***************************************
+    * RESTART
+    * Get the deque back after a restart: replay
+    * every element into a new deque against
+    * reopening the mapped file. Both then sum it
+    ***************************************/
+
+   void bench_mapped()
+   {
+      const char* path = "benchMappedDeque.tmp";
+      const size_t maxBlocks = 2 * numElements / custom::deque_block<int>::numCells;
+      std::remove(path);
+      {
+         custom::mapped_deque<int> d(path, maxBlocks);
+         for (int i = 0; i < numElements; i++)
+            d.push_back(i);
+         d.sync();
+      }
+      long long sum1 = 0;
+      long long sum2 = 0;
+      double msReplay = time([&]
+      {
+         custom::deque<int> d;
+         for (int i = 0; i < numElements; i++)
+            d.push_back(i);
+         sum1 = custom::accumulate(d.begin(), d.end(), 0LL);
+      });
+      double msReopen = time([&]
+      {
+         custom::mapped_deque<int> d(path);
+         sum2 = 0;
+         for (size_t id = 0; id < d.size(); id++)
+            sum2 += d[id];
+      });
+      std::remove(path);
+      report("reopen", msReplay, msReopen, sum1 == sum2);
+   }
+#endif
+
+#ifdef DEQUE_POSIX
+   /***************************************
+    * SNAPSHOT
+    * Checkpoint and restore through a file: an
+    * element at a time through stdio against
+    * save() and load()
+    ***************************************/
+
+   void bench_snapshot()
+   {
+      const char* path = "benchSnapshot.tmp";
+      custom::deque<int> d;
+      setup(d);
+      double msSaveElement = time([&]
+      {
+         FILE* file = std::fopen(path, "wb");
+         for (int value : d)
+            std::fwrite(&value, sizeof(value), 1, file);
+         std::fclose(file);
+      });
+      double msSave = time([&]
+      {
+         FILE* file = std::fopen(path, "wb");
+         d.save(fileno(file));
+         std::fclose(file);
+      });
+      report("save", msSaveElement, msSave, true);
+
+      custom::deque<int> d1;
+      custom::deque<int> d2;
+      double msLoadElement = time([&]
+      {
+         FILE* file = std::fopen(path, "rb");
+         std::fseek(file, sizeof(custom::deque<int>::snapshot_header), SEEK_SET);
+         d1.clear();
+         int value;
+         while (std::fread(&value, sizeof(value), 1, file) == 1)
+            d1.push_back(value);
+         std::fclose(file);
+      });
+      double msLoad = time([&]
+      {
+         FILE* file = std::fopen(path, "rb");
+         d2.load(fileno(file));
+         std::fclose(file);
+      });
+      std::remove(path);
+      report("load", msLoadElement, msLoad,
+             d1.size() == d.size() && custom::equal(d1.begin(), d1.end(), d2.begin()));
+   }
+#endif
+
+#ifdef DEQUE_POSIX
+   /***************************************
+    * BACKLOG
+    * Queue up every element, then drain it: all
+    * in memory against a spill deque holding a
+    * tenth of it in memory
+    ***************************************/
+
+   void bench_spill()
+   {
+      long long sum1 = 0;
+      long long sum2 = 0;
+      size_t numResident = 0;
+      double msMemory = time([&]
+      {
+         custom::deque<int> d;
+         for (int i = 0; i < numElements; i++)
+            d.push_back(i);
+         sum1 = 0;
+         for (; !d.empty(); d.pop_front())
+            sum1 += d.front();
+      });
+      double msSpill = time([&]
+      {
+         custom::spill_deque<int> d(numElements * sizeof(int) / 10, 4);
+         for (int i = 0; i < numElements; i++)
+            d.push_back(i);
+         numResident = d.numBlocksResident();
+         sum2 = 0;
+         for (; !d.empty(); d.pop_front())
+            sum2 += d.front();
+      });
+      report("spill", msMemory, msSpill,
+             sum1 == sum2 && numResident * custom::deque_block<int>::numCells <= numElements / 10);
+   }
+#endif
+
+#ifdef DEQUE_POSIX
+   /***************************************
+    * RELAY
+    * Pass a stream from one pipe to another
+    * through a buffer: read() and write() with
+    * the bytes copied in and out of a deque<char>
+    * a byte at a time, against read_from() and
+    * write_to() on a byte buffer
+    ***************************************/
+
+   void bench_relay()
+   {
+      const size_t chunk = 64 * 1024;
+      const int numChunks = 1024;
+      std::vector<char> payload(chunk);
+      for (size_t i = 0; i < chunk; i++)
+         payload[i] = (char)i;
+      std::vector<char> scratch(chunk);
+      int in[2];
+      int out[2];
+      if (pipe(in) != 0 || pipe(out) != 0)
+         return;
+
+      // the source fills the in pipe; the sink drains the out pipe
+      long long sum1 = 0;
+      long long sum2 = 0;
+      auto sink = [&](long long& sum)
+      {
+         ssize_t numBytes = ::read(out[0], scratch.data(), chunk);
+         for (ssize_t i = 0; i < numBytes; i++)
+            sum += scratch[i];
+      };
+
+      double msCopy = time([&]
+      {
+         custom::deque<char> d;
+         std::vector<char> buffer(chunk);
+         sum1 = 0;
+         for (int i = 0; i < numChunks; i++)
+         {
+            ssize_t numIn = ::write(in[1], payload.data(), chunk);
+            ssize_t numRead = ::read(in[0], buffer.data(), (size_t)numIn);
+            for (ssize_t j = 0; j < numRead; j++)
+               d.push_back(buffer[j]);
+            size_t numOut = 0;
+            for (; !d.empty(); d.pop_front())
+               buffer[numOut++] = d.front();
+            ::write(out[1], buffer.data(), numOut);
+            sink(sum1);
+         }
+      });
+      double msBlocks = time([&]
+      {
+         custom::byte_buffer<> b;
+         sum2 = 0;
+         for (int i = 0; i < numChunks; i++)
+         {
+            ssize_t numIn = ::write(in[1], payload.data(), chunk);
+            b.read_from(in[0], (size_t)numIn);
+            b.write_to(out[1]);
+            sink(sum2);
+         }
+      });
+      close(in[0]);
+      close(in[1]);
+      close(out[0]);
+      close(out[1]);
+      report("relay", msCopy, msBlocks, sum1 == sum2 && sum1 != 0);
+   }
+#endif
+
+   /***************************************
+    * CONCURRENT
+    * One producer and one consumer on their own
+    * cores, a deque behind a mutex against the
+    * lock-free SPSC deque
+    ***************************************/
+
+   void bench_spsc()
+   {
+      long long sum1 = 0;
+      long long sum2 = 0;
+      double msMutex = time([&]
+      {
+         custom::deque<int> d;
+         std::mutex m;
+         sum1 = 0;
+         std::thread consumer([&]
+         {
+            pin(1);
+            for (int popped = 0; popped < numElements; )
+            {
+               std::lock_guard<std::mutex> lock(m);
+               if (!d.empty())
+               {
+                  sum1 += d.front();
+                  d.pop_front();
+                  popped++;
+               }
+            }
+         });
+         pin(0);
+         for (int i = 0; i < numElements; i++)
+         {
+            std::lock_guard<std::mutex> lock(m);
+            d.push_back(i);
+         }
+         consumer.join();
+      });
+      double msSpsc = time([&]
+      {
+         custom::spsc_deque<int> d;
+         sum2 = 0;
+         std::thread consumer([&]
+         {
+            pin(1);
+            int value;
+            for (int popped = 0; popped < numElements; )
+               if (d.pop_front(value))
+               {
+                  sum2 += value;
+                  popped++;
+               }
+         });
+         pin(0);
+         for (int i = 0; i < numElements; i++)
+            d.push_back(i);
+         consumer.join();
+      });
+      report("spsc", msMutex, msSpsc, sum1 == sum2);
+      std::cout << "\t            " << std::setw(10) << numElements / msMutex / 1000.0 << " Mops/s"
+                << std::setw(7) << numElements / msSpsc / 1000.0 << " Mops/s\n";
+   }
+
+   /***************************************
+    * FORK-JOIN
+    * A recursive sum split down to 4096 elements.
+    * Each worker pushes the right half on its own
+    * work-stealing deque and recurses into the left;
+    * idle workers steal. One worker against 2, 4, ...
+    ***************************************/
+
+   struct sum_task
+   {
+      const int* p;
+      int num;
+      long long sum;
+      std::atomic<bool> done;
+   };
+
+   struct fork_join
+   {
+      std::vector<std::unique_ptr<custom::ws_deque<sum_task*>>> deques;
+
+      explicit fork_join(int numWorkers)
+      {
+         for (int i = 0; i < numWorkers; i++)
+            deques.emplace_back(new custom::ws_deque<sum_task*>);
+      }
+
+      // run one task, or steal one from a random victim
+      bool help(int self, std::mt19937& random)
+      {
+         sum_task* pTask = nullptr;
+         if (!deques[self]->pop_back(pTask))
+         {
+            int victim = (int)(random() % deques.size());
+            if (victim == self || !deques[victim]->steal(pTask))
+               return false;
+         }
+         execute(*pTask, self, random);
+         return true;
+      }
+
+      void execute(sum_task& task, int self, std::mt19937& random)
+      {
+         if (task.num <= 4096)
+         {
+            long long sum = 0;
+            for (int i = 0; i < task.num; i++)
+               sum += task.p[i];
+            task.sum = sum;
+         }
+         else
+         {
+            int numLeft = task.num / 2;
+            sum_task left  = { task.p, numLeft, 0, {false} };
+            sum_task right = { task.p + numLeft, task.num - numLeft, 0, {false} };
+            deques[self]->push_back(&right);
+            execute(left, self, random);
+            while (!right.done.load(std::memory_order_acquire))
+               help(self, random);
+            task.sum = left.sum + right.sum;
+         }
+         task.done.store(true, std::memory_order_release);
+      }
+   };
+
+   void bench_forkJoin()
+   {
+      std::vector<int> v(numElements);
+      for (int i = 0; i < numElements; i++)
+         v[i] = i;
+      long long sum1 = sumForkJoin(v, 1);
+      double msOne = time([&] { sum1 = sumForkJoin(v, 1); });
+
+      int numCores = (int)std::max(2u, std::thread::hardware_concurrency());
+      for (int numWorkers = 2; numWorkers <= numCores; numWorkers *= 2)
+      {
+         long long sum2 = 0;
+         double msMany = time([&] { sum2 = sumForkJoin(v, numWorkers); });
+         std::string name = "fork-join " + std::to_string(numWorkers);
+         report(name.c_str(), msOne, msMany, sum1 == sum2);
+      }
+   }
+
+   // the calling thread is worker 0; the rest steal until the root is done
+   static long long sumForkJoin(const std::vector<int>& v, int numWorkers)
+   {
+      fork_join pool(numWorkers);
+      std::atomic<bool> stop(false);
+      std::vector<std::thread> workers;
+      for (int self = 1; self < numWorkers; self++)
+         workers.emplace_back([&, self]
+         {
+            pin(self);
+            std::mt19937 random(self);
+            while (!stop.load(std::memory_order_relaxed))
+               if (!pool.help(self, random))
+                  std::this_thread::yield();
+         });
+      pin(0);
+      std::mt19937 random(0);
+      sum_task root = { v.data(), (int)v.size(), 0, {false} };
+      pool.execute(root, 0, random);
+      stop.store(true);
+      for (std::thread& worker : workers)
+         worker.join();
+      return root.sum;
+   }
+
+   /***************************************
+    * MANY PRODUCERS, MANY CONSUMERS
+    * N producers and N consumers through one
+    * bounded deque in batches of 32. Each element
+    * is the time it was pushed, so the consumers
+    * measure how long it waited
+    ***************************************/
+
+   void bench_mpmc()
+   {
+      const int numTotal = numElements / 10;
+      const size_t numBatch = 32;
+      int numCores = (int)std::max(2u, std::thread::hardware_concurrency());
+      for (int numThreads = 1; numThreads <= numCores; numThreads *= 2)
+      {
+         custom::bounded_deque<long long> d(4096);
+         std::vector<std::vector<long long>> latencies(numThreads);
+         std::vector<std::thread> threads;
+         auto start = std::chrono::steady_clock::now();
+         for (int t = 0; t < numThreads; t++)
+         {
+            threads.emplace_back([&, t]
+            {
+               pin(2 * t);
+               long long batch[numBatch];
+               for (int i = 0; i < numTotal / numThreads; i += (int)numBatch)
+               {
+                  long long ns = nowNs();
+                  for (size_t j = 0; j < numBatch; j++)
+                     batch[j] = ns;
+                  d.push_back_n(batch, numBatch);
+               }
+            });
+            threads.emplace_back([&, t]
+            {
+               pin(2 * t + 1);
+               std::vector<long long>& latency = latencies[t];
+               latency.reserve(2 * numTotal / numThreads);
+               long long batch[numBatch];
+               size_t count;
+               while ((count = d.pop_front_n(batch, numBatch)) > 0)
+               {
+                  long long ns = nowNs();
+                  for (size_t j = 0; j < count; j++)
+                     latency.push_back(ns - batch[j]);
+               }
+            });
+         }
+         for (int t = 0; t < numThreads; t++)
+            threads[2 * t].join();
+         d.close();
+         for (int t = 0; t < numThreads; t++)
+            threads[2 * t + 1].join();
+         std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+
+         std::vector<long long> all;
+         for (std::vector<long long>& latency : latencies)
+            all.insert(all.end(), latency.begin(), latency.end());
+         std::vector<long long>::iterator p99 = all.begin() + all.size() * 99 / 100;
+         std::nth_element(all.begin(), p99, all.end());
+         std::cout << "\tmpmc " << std::left << std::setw(7) << numThreads << std::right
+                   << std::setw(10) << all.size() / ms.count() / 1000.0 << " Mops/s"
+                   << std::setw(10) << *p99 / 1000.0 << " us p99\n";
+      }
+   }
+
+   static long long nowNs()
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   // run the calling thread on one core (where we know how)
+   static void pin(int core)
+   {
+#if defined(__linux__)
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &set);
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+      (void)core;
+#endif
+   }
+
+   /***************************************
+    * UTILITIES
+    ***************************************/
+
+   // fill d with 0 ... numElements-1, front wrapped past the map's start
+   static void setup(custom::deque<int>& d)
+   {
+      for (int i = numElements / 2; i < numElements; i++)
+         d.push_back(i);
+      for (int i = numElements / 2 - 1; i >= 0; i--)
+         d.push_front(i);
+   }
+
+   // best wall-clock time of f in milliseconds
+   template <typename F>
+   static double time(F f)
+   {
+      double best = 0.0;
+      for (int run = 0; run < numRuns; run++)
+      {
+         auto start = std::chrono::steady_clock::now();
+         f();
+         std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+         if (run == 0 || ms.count() < best)
+            best = ms.count();
+      }
+      return best;
+   }
+
+   static void report(const char* name, double msBaseline, double msCustom, bool agree)
+   {
+      std::cout << "\t" << std::left << std::setw(12) << name << std::right
+                << std::fixed << std::setprecision(2)
+                << std::setw(10) << msBaseline << " ms"
+                << std::setw(10) << msCustom << " ms"
+                << std::setw(8) << msBaseline / msCustom << "x"
+                << (agree ? "" : "  RESULTS DIFFER") << "\n";
+   }
+};
+
+#endif // BENCHMARK
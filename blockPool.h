@@ -0,0 +1,328 @@
+/***********************************************************************
+ * Header:
+ *    BLOCK POOL
+ * Summary:
+ *    A pool of fixed-size blocks that many deques can share. Blocks
+ *    are carved out of large slabs, so thousands of small deques do
+ *    not each go to the heap for every block. Each thread keeps a
+ *    short free list of its own, so most allocations and frees take
+ *    no lock. The shared free list behind it is guarded by a mutex.
+ *
+ *    This will contain the definition of:
+ *        deque_block_pool     : The slabs and the shared free list
+ *        deque_pool_allocator : An allocator that draws from a pool
+ *        pooled_deque         : A deque whose blocks come from a pool
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>       // for size_t, std::max_align_t
+#include <cstdint>       // for uint64_t
+#include <new>           // for ::operator new
+#include <mutex>         // for std::mutex
+#include <atomic>        // for std::atomic
+#include <vector>        // for the slabs
+#include <unordered_set> // for the live pools
+#include <type_traits>   // for std::true_type
+#include "deque.h"
+
+class TestBlockPool;    // forward declaration for TestBlockPool unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * DEQUE BLOCK POOL
+ * Hands out blocks of blockBytes, blocksPerSlab at a
+ * time from the heap. A block goes back to the pool
+ * when freed and the slabs go back when the pool dies,
+ * so every block must be freed before the pool is.
+ *
+ * A thread's free list belongs to the last pool it
+ * used. Switching to another pool hands the blocks
+ * back first, so one thread juggling two pools pays
+ * for a lock on each switch.
+ *****************************************************/
+   class deque_block_pool
+   {
+      friend class ::TestBlockPool; // give unit tests access to the privates
+   public:
+      explicit deque_block_pool(size_t blockBytes, size_t blocksPerSlab = 64)
+         : blockBytes(roundUp(blockBytes)),
+           blocksPerSlab(blocksPerSlab ? blocksPerSlab : 1),
+           freeList(nullptr), id(nextId()++)
+      {
+         std::lock_guard<std::mutex> lock(registryMutex());
+         registry().insert(id);
+      }
+      deque_block_pool(const deque_block_pool&) = delete;
+      deque_block_pool& operator = (const deque_block_pool&) = delete;
+      ~deque_block_pool()
+      {
+         {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            registry().erase(id);
+         }
+         if (localCache().id == id)
+            localCache().drop();
+         for (void* slab : slabs)
+            ::operator delete(slab);
+      }
+
+      void* allocate();
+      void deallocate(void* p) noexcept;
+
+      size_t block_size() const { return blockBytes; }
+      size_t num_slabs() const
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         return slabs.size();
+      }
+
+   private:
+      struct node { node* next; };
+
+      // the calling thread's free list, for the last pool it used
+      struct local_cache
+      {
+         deque_block_pool* pool = nullptr;
+         uint64_t id = 0;
+         node* head = nullptr;
+         size_t count = 0;
+
+         ~local_cache() { flush(); }
+         void flush();
+         void drop() { pool = nullptr; id = 0; head = nullptr; count = 0; }
+      };
+
+      static const size_t numBatch = 16;  // blocks moved to or from a thread at once
+
+      // blocks are at least a node and keep the heap's alignment
+      static size_t roundUp(size_t n)
+      {
+         const size_t align = alignof(std::max_align_t);
+         n = n < sizeof(node) ? sizeof(node) : n;
+         return (n + align - 1) / align * align;
+      }
+
+      static local_cache& localCache()
+      {
+         static thread_local local_cache cache;
+         return cache;
+      }
+      static std::atomic<uint64_t>& nextId()
+      {
+         static std::atomic<uint64_t> counter(1);
+         return counter;
+      }
+
+      // the pools that are still alive: a thread's free list can only
+      // go back to a pool on this list
+      static std::mutex& registryMutex()
+      {
+         static std::mutex m;
+         return m;
+      }
+      static std::unordered_set<uint64_t>& registry()
+      {
+         static std::unordered_set<uint64_t> live;
+         return live;
+      }
+
+      void claim(local_cache& cache);
+      void refill(local_cache& cache);
+      void giveBack(node* head, size_t count) noexcept;
+
+      size_t blockBytes;           // size of every block
+      size_t blocksPerSlab;        // blocks carved from each slab
+      node* freeList;              // blocks shared by every thread
+      std::vector<void*> slabs;    // everything we got from the heap
+      mutable std::mutex mutex;    // guards freeList and slabs
+      uint64_t id;                 // never reused, unlike our address
+   };
+
+   /*****************************************
+    * DEQUE BLOCK POOL :: ALLOCATE
+    * Pop a block off this thread's free list,
+    * refilling it from the pool as needed
+    ****************************************/
+   inline void* deque_block_pool::allocate()
+   {
+      local_cache& cache = localCache();
+      if (cache.id != id)
+         claim(cache);
+      if (!cache.head)
+         refill(cache);
+
+      node* p = cache.head;
+      cache.head = p->next;
+      cache.count--;
+      return p;
+   }
+
+   /*****************************************
+    * DEQUE BLOCK POOL :: DEALLOCATE
+    * Push a block onto this thread's free list. A
+    * long list gives a batch back to the pool so a
+    * thread that only frees does not hoard blocks
+    ****************************************/
+   inline void deque_block_pool::deallocate(void* p) noexcept
+   {
+      local_cache& cache = localCache();
+      if (cache.id != id)
+         claim(cache);
+
+      node* n = (node*)p;
+      n->next = cache.head;
+      cache.head = n;
+      cache.count++;
+
+      if (cache.count >= 2 * numBatch)
+      {
+         node* head = cache.head;
+         node* tail = head;
+         for (size_t i = 1; i < numBatch; i++)
+            tail = tail->next;
+         cache.head = tail->next;
+         cache.count -= numBatch;
+         tail->next = nullptr;
+         giveBack(head, numBatch);
+      }
+   }
+
+   /*****************************************
+    * DEQUE BLOCK POOL :: CLAIM
+    * Make this thread's free list ours, handing
+    * whatever it held back to its old pool
+    ****************************************/
+   inline void deque_block_pool::claim(local_cache& cache)
+   {
+      cache.flush();
+      cache.pool = this;
+      cache.id = id;
+   }
+
+   /*****************************************
+    * DEQUE BLOCK POOL :: REFILL
+    * Move a batch from the shared list to this
+    * thread, carving a new slab if it is empty
+    ****************************************/
+   inline void deque_block_pool::refill(local_cache& cache)
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!freeList)
+      {
+         char* slab = (char*)::operator new(blockBytes * blocksPerSlab);
+         slabs.push_back(slab);
+         for (size_t i = blocksPerSlab; i-- > 0; )
+         {
+            node* n = (node*)(slab + i * blockBytes);
+            n->next = freeList;
+            freeList = n;
+         }
+      }
+
+      // the most recently freed blocks, still in order
+      node* tail = freeList;
+      size_t count = 1;
+      for (; count < numBatch && tail->next; count++)
+         tail = tail->next;
+      cache.head = freeList;
+      cache.count = count;
+      freeList = tail->next;
+      tail->next = nullptr;
+   }
+
+   /*****************************************
+    * DEQUE BLOCK POOL :: GIVE BACK
+    * Put a list of count blocks on the shared list
+    ****************************************/
+   inline void deque_block_pool::giveBack(node* head, size_t count) noexcept
+   {
+      if (!head)
+         return;
+      node* tail = head;
+      while (--count && tail->next)
+         tail = tail->next;
+
+      std::lock_guard<std::mutex> lock(mutex);
+      tail->next = freeList;
+      freeList = head;
+   }
+
+   /*****************************************
+    * DEQUE BLOCK POOL :: LOCAL CACHE :: FLUSH
+    * Hand the thread's blocks back to their pool
+    * if it is still alive. A dead pool already
+    * freed the slabs they came from
+    ****************************************/
+   inline void deque_block_pool::local_cache::flush()
+   {
+      if (head)
+      {
+         std::lock_guard<std::mutex> lock(registryMutex());
+         if (registry().count(id))
+            pool->giveBack(head, count);
+      }
+      drop();
+   }
+
+/******************************************************
+ * DEQUE POOL ALLOCATOR
+ * Allocations that fit in a block come from the pool,
+ * anything larger (a big map) from the heap. Deques
+ * copied or moved from one another share the pool.
+ *****************************************************/
+   template <typename T>
+   class deque_pool_allocator
+   {
+      template <typename U>
+      friend class deque_pool_allocator;
+      static_assert(alignof(T) <= alignof(std::max_align_t), "the pool only aligns to max_align_t");
+   public:
+      typedef T value_type;
+      typedef std::true_type propagate_on_container_copy_assignment;
+      typedef std::true_type propagate_on_container_move_assignment;
+      typedef std::true_type propagate_on_container_swap;
+
+      deque_pool_allocator(deque_block_pool* pool) noexcept : pool(pool) {}
+      template <typename U>
+      deque_pool_allocator(const deque_pool_allocator<U>& rhs) noexcept : pool(rhs.pool) {}
+
+      T* allocate(size_t n)
+      {
+         if (n * sizeof(T) <= pool->block_size())
+            return (T*)pool->allocate();
+         return (T*)::operator new(n * sizeof(T));
+      }
+      void deallocate(T* p, size_t n) noexcept
+      {
+         if (n * sizeof(T) <= pool->block_size())
+            pool->deallocate(p);
+         else
+            ::operator delete(p);
+      }
+
+      deque_block_pool* resource() const { return pool; }
+
+      template <typename U>
+      bool operator == (const deque_pool_allocator<U>& rhs) const { return pool == rhs.pool; }
+      template <typename U>
+      bool operator != (const deque_pool_allocator<U>& rhs) const { return pool != rhs.pool; }
+
+   private:
+      deque_block_pool* pool;
+   };
+
+/******************************************************
+ * POOLED DEQUE
+ * A deque whose blocks come from a shared pool. Size
+ * the pool for the deque's blocks:
+ *    deque_block_pool pool(sizeof(T) * deque_block<T>::numCells);
+ *****************************************************/
+   template <typename T, size_t BS = deque_block<T>::numCells>
+   using pooled_deque = deque<T, deque_pool_allocator<T>, BS>;
+
+} // namespace custom
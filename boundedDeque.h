@@ -0,0 +1,308 @@
+/***********************************************************************
+ * Header:
+ *    BOUNDED DEQUE
+ * Summary:
+ *    A deque of at most a fixed number of elements that any number of
+ *    threads may push on the back of and pop off the front of: a
+ *    fan-in or fan-out queue. The elements live in a custom::deque,
+ *    so blocks freed at the front are reused at the back from its
+ *    spare cache, and a mutex guards it.
+ *
+ *    The mutex is the cost, so the batch operations take it once for
+ *    many elements: push_back_n appends a whole run with one growth
+ *    of the map, and pop_front_n moves a run out a block at a time.
+ *
+ *    A thread that has to wait spins first, backing off each time,
+ *    watching an unlocked copy of the size. Only after that does it
+ *    sleep on a condition variable, and the other side only notifies
+ *    when someone is asleep. close() wakes every waiter.
+ *
+ *    This will contain the class definition of:
+ *        bounded_deque : A bounded many-producer, many-consumer deque
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>              // for std::atomic
+#include <mutex>               // for std::mutex
+#include <condition_variable>  // for std::condition_variable
+#include <thread>              // for std::this_thread::yield
+#include <iterator>            // for std::next
+#include <algorithm>           // for std::min, std::move
+#include <cstddef>             // for size_t
+#include <utility>             // for std::move
+#include "deque.h"             // for the storage
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>         // for _mm_pause
+#endif
+
+class TestBoundedDeque;    // forward declaration for TestBoundedDeque unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * BOUNDED DEQUE
+ * try_ operations never wait. The others wait for room
+ * or for an element and only fail once it is closed.
+ *****************************************************/
+   template <typename T, typename A = std::allocator<T>,
+             size_t BS = deque_block<T>::numCells>
+   class bounded_deque
+   {
+      friend class ::TestBoundedDeque; // give unit tests access to the privates
+
+   public:
+      explicit bounded_deque(size_t capacity, const A& a = A())
+         : d(a), numCapacity(capacity), numElements(0), closed(false),
+           numWaitingPush(0), numWaitingPop(0) {}
+      bounded_deque(const bounded_deque&) = delete;
+      bounded_deque& operator = (const bounded_deque&) = delete;
+
+      //
+      // One element
+      //
+      bool try_push_back(const T& t)  { return try_push_back_n(&t, 1) == 1;     }
+      bool try_push_back(T&& t)       { return try_push_back_n(std::make_move_iterator(&t), 1) == 1; }
+      bool try_pop_front(T& t)        { return try_pop_front_n(&t, 1) == 1;      }
+      bool push_back(const T& t)      { return push_back_n(&t, 1);               }
+      bool push_back(T&& t)           { return push_back_n(std::make_move_iterator(&t), 1); }
+      bool pop_front(T& t)            { return pop_front_n(&t, 1) == 1;          }
+
+      //
+      // Batches
+      //
+      template <typename ForwardIt>
+      size_t try_push_back_n(ForwardIt first, size_t n);
+      template <typename ForwardIt>
+      bool push_back_n(ForwardIt first, size_t n);
+      template <typename OutputIt>
+      size_t try_pop_front_n(OutputIt out, size_t n);
+      template <typename OutputIt>
+      size_t pop_front_n(OutputIt out, size_t n);
+
+      //
+      // Shut down: pushes fail, pops drain what is left, waiters wake
+      //
+      void close();
+
+      //
+      // Status: a snapshot
+      //
+      size_t size()     const { return numElements.load(std::memory_order_relaxed); }
+      bool   empty()    const { return size() == 0;                                  }
+      size_t capacity() const { return numCapacity;                                  }
+      bool   is_closed() const { return closed.load(std::memory_order_relaxed);      }
+
+   private:
+      template <typename ForwardIt>
+      size_t pushLocked(ForwardIt& first, size_t n);
+      template <typename OutputIt>
+      size_t popLocked(OutputIt& out, size_t n);
+      template <typename Ready>
+      void wait(std::unique_lock<std::mutex>& lock, std::condition_variable& cv,
+                size_t& numWaiting, Ready ready);
+
+      static const int maxSpins = 1024;   // pauses before yielding
+      static const int maxBackoffs = 16;  // rounds before sleeping
+
+      std::mutex mutex;                   // guards d and the waiter counts
+      std::condition_variable notFull;
+      std::condition_variable notEmpty;
+      deque<T, A, BS> d;
+      const size_t numCapacity;
+      std::atomic<size_t> numElements;    // d.size(), for waiters to watch unlocked
+      std::atomic<bool> closed;
+      size_t numWaitingPush;              // asleep on notFull
+      size_t numWaitingPop;               // asleep on notEmpty
+   };
+
+   /*****************************************
+    * BOUNDED DEQUE :: TRY PUSH BACK N
+    * Append as many of the n elements from first
+    * as fit now. Return how many
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename ForwardIt>
+   size_t bounded_deque <T, A, BS> ::try_push_back_n(ForwardIt first, size_t n)
+   {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (closed.load(std::memory_order_relaxed))
+         return 0;
+      size_t count = pushLocked(first, n);
+      bool wake = count && numWaitingPop;
+      lock.unlock();
+      if (wake)
+         count > 1 ? notEmpty.notify_all() : notEmpty.notify_one();
+      return count;
+   }
+
+   /*****************************************
+    * BOUNDED DEQUE :: PUSH BACK N
+    * Append all n elements from first, waiting
+    * for room as needed. False if it was closed
+    * before they all went in
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename ForwardIt>
+   bool bounded_deque <T, A, BS> ::push_back_n(ForwardIt first, size_t n)
+   {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (n > 0)
+      {
+         wait(lock, notFull, numWaitingPush, [this]
+         {
+            return closed.load(std::memory_order_relaxed)
+                || numElements.load(std::memory_order_relaxed) < numCapacity;
+         });
+         if (closed.load(std::memory_order_relaxed))
+            return false;
+
+         size_t count = pushLocked(first, n);
+         n -= count;
+         if (numWaitingPop)
+         {
+            lock.unlock();
+            count > 1 ? notEmpty.notify_all() : notEmpty.notify_one();
+            lock.lock();
+         }
+      }
+      return true;
+   }
+
+   /*****************************************
+    * BOUNDED DEQUE :: TRY POP FRONT N
+    * Move up to n elements off the front into out.
+    * Return how many
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename OutputIt>
+   size_t bounded_deque <T, A, BS> ::try_pop_front_n(OutputIt out, size_t n)
+   {
+      std::unique_lock<std::mutex> lock(mutex);
+      size_t count = popLocked(out, n);
+      bool wake = count && numWaitingPush;
+      lock.unlock();
+      if (wake)
+         count > 1 ? notFull.notify_all() : notFull.notify_one();
+      return count;
+   }
+
+   /*****************************************
+    * BOUNDED DEQUE :: POP FRONT N
+    * Wait for at least one element, then move up
+    * to n off the front into out. Return how many:
+    * zero only once it is closed and empty
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename OutputIt>
+   size_t bounded_deque <T, A, BS> ::pop_front_n(OutputIt out, size_t n)
+   {
+      if (n == 0)
+         return 0;
+      std::unique_lock<std::mutex> lock(mutex);
+      wait(lock, notEmpty, numWaitingPop, [this]
+      {
+         return closed.load(std::memory_order_relaxed)
+             || numElements.load(std::memory_order_relaxed) > 0;
+      });
+      size_t count = popLocked(out, n);
+      bool wake = count && numWaitingPush;
+      lock.unlock();
+      if (wake)
+         count > 1 ? notFull.notify_all() : notFull.notify_one();
+      return count;
+   }
+
+   /*****************************************
+    * BOUNDED DEQUE :: CLOSE
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void bounded_deque <T, A, BS> ::close()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         closed.store(true, std::memory_order_relaxed);
+      }
+      notFull.notify_all();
+      notEmpty.notify_all();
+   }
+
+   /*****************************************
+    * BOUNDED DEQUE :: PUSH LOCKED
+    * Append what fits of n elements with one
+    * append, advancing first past them
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename ForwardIt>
+   size_t bounded_deque <T, A, BS> ::pushLocked(ForwardIt& first, size_t n)
+   {
+      size_t count = std::min(n, numCapacity - std::min(numCapacity, d.size()));
+      ForwardIt last = std::next(first, count);
+      d.append(first, last);
+      first = last;
+      numElements.store(d.size(), std::memory_order_relaxed);
+      return count;
+   }
+
+   /*****************************************
+    * BOUNDED DEQUE :: POP LOCKED
+    * Move up to n elements out a block at a time,
+    * then drop them all at once, advancing out
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename OutputIt>
+   size_t bounded_deque <T, A, BS> ::popLocked(OutputIt& out, size_t n)
+   {
+      size_t count = std::min(n, d.size());
+      for (span<T> seg : d.segments(d.begin(), d.begin() + (int)count))
+         out = std::move(seg.begin(), seg.end(), out);
+      d.drop_front(count);
+      numElements.store(d.size(), std::memory_order_relaxed);
+      return count;
+   }
+
+   /*****************************************
+    * BOUNDED DEQUE :: WAIT
+    * Return holding the lock once ready() is true.
+    * Spin with the lock released, pausing twice as
+    * long each round and then yielding, before
+    * sleeping on cv
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename Ready>
+   void bounded_deque <T, A, BS> ::wait(std::unique_lock<std::mutex>& lock,
+                                        std::condition_variable& cv,
+                                        size_t& numWaiting, Ready ready)
+   {
+      if (ready())
+         return;
+
+      lock.unlock();
+      int spins = 1;
+      for (int round = 0; round < maxBackoffs && !ready(); round++)
+      {
+         if (spins < maxSpins)
+         {
+            for (int i = 0; i < spins; i++)
+            {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+               _mm_pause();
+#endif
+            }
+            spins *= 2;
+         }
+         else
+            std::this_thread::yield();
+      }
+      lock.lock();
+
+      numWaiting++;
+      cv.wait(lock, ready);
+      numWaiting--;
+   }
+
+} // namespace custom
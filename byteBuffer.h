@@ -0,0 +1,207 @@
+/***********************************************************************
+ * Header:
+ *    BYTE BUFFER
+ * Summary:
+ *    A deque of bytes for socket I/O. read_from() reads from a file
+ *    descriptor straight into the free cells at the back, across as
+ *    many blocks as it takes, with one readv. write_to() writes the
+ *    front out of the blocks where it sits with one writev. consume()
+ *    drops bytes off the front a block at a time. No byte is copied
+ *    through an intermediate buffer.
+ *
+ *    Blocks that consume() empties, and those read_from() set up but
+ *    the read did not reach, wait on a stash for the next read, so a
+ *    steady stream of reads and writes does not allocate.
+ *
+ *    read_from() and write_to() return what readv and writev do: a
+ *    byte count, or -1 with errno set, so a non-blocking socket's
+ *    EAGAIN is not an exception. Needs readv and writev, so not on
+ *    Windows.
+ *
+ *    This will contain the class definition of:
+ *        byte_buffer : A deque of bytes filled and drained by the block
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include "deque.h"     // for the storage and DEQUE_POSIX
+
+#ifdef DEQUE_POSIX
+
+#include <cstddef>     // for size_t
+#include <cerrno>      // for errno
+#include <vector>      // for the iovecs and the stash
+#include <sys/uio.h>   // for readv, writev
+
+class TestByteBuffer;    // forward declaration for TestByteBuffer unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * BYTE BUFFER
+ * A deque<char> with block-at-a-time I/O. BS bytes
+ * to a block
+ *****************************************************/
+   template <typename A = std::allocator<char>,
+             size_t BS = deque_block<char>::numCells>
+   class byte_buffer
+   {
+      friend class ::TestByteBuffer; // give unit tests access to the privates
+      typedef deque<char, A, BS> container;
+      typedef std::allocator_traits<A> alloc_traits;
+
+   public:
+      typedef typename container::const_iterator const_iterator;
+
+      byte_buffer(const A& a = A()) : alloc(a), d(a) {}
+      byte_buffer(const byte_buffer&) = delete;
+      byte_buffer& operator = (const byte_buffer&) = delete;
+      ~byte_buffer();
+
+      //
+      // Access
+      //
+      const char& operator [] (size_t id) const { return d[(int)id]; }
+      const_iterator begin() const              { return d.begin(); }
+      const_iterator end()   const              { return d.end();   }
+      typename container::template segment_range<const char> segments() const
+      {
+         return d.segments();
+      }
+
+      //
+      // In at the back
+      //
+      ssize_t read_from(int fd, size_t maxBytes = 64 * 1024);
+      void append(const char* p, size_t n) { d.append(p, p + n); }
+
+      //
+      // Out at the front
+      //
+      ssize_t write_to(int fd);
+      void consume(size_t n);
+      void clear() { consume(d.size()); }
+
+      //
+      // Status
+      //
+      size_t size()  const { return d.size();  }
+      bool   empty() const { return d.empty(); }
+
+   private:
+      // a block for the back: off the stash, or a new one
+      char* takeBlock()
+      {
+         if (stash.empty())
+            return alloc_traits::allocate(alloc, BS);
+         char* p = stash.back();
+         stash.pop_back();
+         return p;
+      }
+
+      // a block we are done with: back on the stash if there is room
+      void stashBlock(char* p)
+      {
+         if (stash.size() < maxStash)
+            stash.push_back(p);
+         else
+            alloc_traits::deallocate(alloc, p, BS);
+      }
+
+      static const size_t maxStash = 64;
+
+      A alloc;                       // equal to the deque's, for the stash
+      container d;
+      std::vector<char*> stash;      // empty blocks, for the next read
+   };
+
+   /*****************************************
+    * BYTE BUFFER :: DESTRUCTOR
+    * The deque frees its own blocks
+    ****************************************/
+   template <typename A, size_t BS>
+   byte_buffer <A, BS> ::~byte_buffer()
+   {
+      for (char* p : stash)
+         alloc_traits::deallocate(alloc, p, BS);
+   }
+
+   /*****************************************
+    * BYTE BUFFER :: READ FROM
+    * Set up blocks for maxBytes past the back and
+    * readv into them, free cells of the back block
+    * first. Blocks the read did not reach go back
+    * on the stash
+    ****************************************/
+   template <typename A, size_t BS>
+   ssize_t byte_buffer <A, BS> ::read_from(int fd, size_t maxBytes)
+   {
+      // the first span may start part way into a block
+      maxBytes = std::min(maxBytes, (size_t)(IOV_MAX - 1) * BS);
+      if (maxBytes == 0)
+         return 0;
+
+      // 1. A block under every cell we read into, an iovec per block
+      std::vector<struct iovec> iov;
+      for (span<char> seg : d.back_free(maxBytes, [this]() { return takeBlock(); }))
+         iov.push_back({ seg.data(), seg.size() });
+
+      // 2. Read
+      ssize_t numBytes;
+      do
+         numBytes = ::readv(fd, iov.data(), (int)iov.size());
+      while (numBytes < 0 && errno == EINTR);
+      int error = errno;
+
+      // 3. The blocks the read did not reach are not part of the deque
+      d.commit_back(numBytes > 0 ? (size_t)numBytes : 0,
+                    [this](char* p) { stashBlock(p); });
+      errno = error;
+      return numBytes;
+   }
+
+   /*****************************************
+    * BYTE BUFFER :: WRITE TO
+    * One writev straight from the blocks. The
+    * bytes written are consumed
+    ****************************************/
+   template <typename A, size_t BS>
+   ssize_t byte_buffer <A, BS> ::write_to(int fd)
+   {
+      if (d.empty())
+         return 0;
+
+      std::vector<struct iovec> iov;
+      for (span<char> seg : d.segments())
+      {
+         if (iov.size() == (size_t)IOV_MAX)
+            break;
+         iov.push_back({ seg.data(), seg.size() });
+      }
+
+      ssize_t numBytes;
+      do
+         numBytes = ::writev(fd, iov.data(), (int)iov.size());
+      while (numBytes < 0 && errno == EINTR);
+      if (numBytes > 0)
+         consume((size_t)numBytes);
+      return numBytes;
+   }
+
+   /*****************************************
+    * BYTE BUFFER :: CONSUME
+    * Drop n bytes off the front, a block at a
+    * time: each block emptied goes on the stash
+    ****************************************/
+   template <typename A, size_t BS>
+   void byte_buffer <A, BS> ::consume(size_t n)
+   {
+      d.drop_front(n, [this](char* p) { stashBlock(p); });
+   }
+
+} // namespace custom
+
+#endif // DEQUE_POSIX
@@ -13,6 +13,9 @@
  *    This will contain the class definition of:
  *        deque                 : A class that represents a deque
  *        deque::iterator       : An iterator through a deque
+ *        deque::const_iterator : A read-only iterator through a deque
+ *        deque::segment_range  : The contiguous runs of a deque
+ *        pmr::deque            : A deque on a std::pmr::memory_resource
  * Author
  *    Nathan Bird, Brock Hoskins
  ************************************************************************/
@@ -23,43 +26,192 @@
 // Debug stuff
 #include <cassert>
 #include <memory>   // for std::allocator
+#include <cstddef>  // for ptrdiff_t
+#include <iterator> // for std::reverse_iterator
+#include <type_traits>
+#include <algorithm> // for std::min
+#include <cstring>   // for std::memcpy
+#include <vector>    // for is_contiguous
+#include <string>    // for is_contiguous
+#include <utility>   // for std::swap
+#include "algorithm.h" // for custom::copy
+#if __has_include(<memory_resource>)
+#include <memory_resource> // for std::pmr::polymorphic_allocator
+#endif
+#if __cplusplus > 201703L || (defined(_MSVC_LANG) && _MSVC_LANG > 201703L)
+#include <span>
+#endif
+#if !defined(_WIN32)
+#include <sys/uio.h>     // for writev, readv
+#include <climits>       // for IOV_MAX
+#include <cstdint>       // for uint64_t
+#include <cerrno>        // for errno
+#include <stdexcept>     // for std::runtime_error
+#include <system_error>  // for std::system_error
+#ifndef IOV_MAX
+#define IOV_MAX 16       // the least POSIX allows
+#endif
+#define DEQUE_POSIX      // snapshots and the headers built on POSIX I/O
+#endif
 
 class TestDeque;    // forward declaration for TestDeque unit test class
 
+// target size of a block in bytes. Define before including to change it
+#ifndef DEQUE_BLOCK_BYTES
+#define DEQUE_BLOCK_BYTES 512
+#endif
+
+// how many emptied blocks a deque keeps for reuse rather than freeing
+#ifndef DEQUE_SPARE_BLOCKS
+#define DEQUE_SPARE_BLOCKS 2
+#endif
+
 namespace custom
 {
 
+#if __cplusplus > 201703L || (defined(_MSVC_LANG) && _MSVC_LANG > 201703L)
+   template <typename T>
+   using span = std::span<T>;
+#else
+/******************************************************
+ * SPAN
+ * Just enough of C++20's std::span to hand out a run of
+ * contiguous cells when building as C++17
+ *****************************************************/
+   template <typename T>
+   class span
+   {
+   public:
+      span() : p(nullptr), n(0) {}
+      span(T* p, size_t n) : p(p), n(n) {}
+
+      T* data()  const { return p;     }
+      T* begin() const { return p;     }
+      T* end()   const { return p + n; }
+      size_t size() const { return n;  }
+      bool  empty() const { return n == 0; }
+      T& operator [] (size_t i) const { return p[i]; }
+
+   private:
+      T* p;
+      size_t n;
+   };
+#endif
+
+   // Do the Ts of It sit next to each other in memory? C++20 says so
+   // outright. Before that, pointers (which is what std::array hands out
+   // on the libraries we build with) and vector and string iterators do;
+   // nothing else is assumed to.
+#if __cplusplus > 201703L || (defined(_MSVC_LANG) && _MSVC_LANG > 201703L)
+   template <typename It, typename T>
+   struct is_contiguous : std::integral_constant<bool,
+      std::contiguous_iterator<It> &&
+      std::is_same<std::iter_value_t<It>, T>::value> {};
+#else
+   // a string of T when T is a character type, otherwise nothing
+   template <typename T>
+   struct is_char : std::integral_constant<bool,
+      std::is_same<T, char>::value || std::is_same<T, wchar_t>::value ||
+      std::is_same<T, char16_t>::value || std::is_same<T, char32_t>::value> {};
+
+   template <typename It, typename T, bool = is_char<T>::value>
+   struct is_string_iterator : std::integral_constant<bool,
+      std::is_same<It, typename std::basic_string<T>::iterator>::value ||
+      std::is_same<It, typename std::basic_string<T>::const_iterator>::value> {};
+
+   template <typename It, typename T>
+   struct is_string_iterator<It, T, false> : std::false_type {};
+
+   template <typename It, typename T>
+   struct is_contiguous : std::integral_constant<bool,
+      std::is_same<It, T*>::value ||
+      std::is_same<It, const T*>::value ||
+      std::is_same<It, typename std::vector<T>::iterator>::value ||
+      std::is_same<It, typename std::vector<T>::const_iterator>::value ||
+      is_string_iterator<It, T>::value> {};
+#endif
+
+   // largest power of two that is not bigger than n (at least 1)
+   constexpr size_t floorPowerOfTwo(size_t n)
+   {
+      return n < 2 ? 1 : 2 * floorPowerOfTwo(n / 2);
+   }
+
+   // is n a power of two?
+   constexpr bool isPowerOfTwo(size_t n)
+   {
+      return n > 0 && (n & (n - 1)) == 0;
+   }
+
+   // log2 of a power of two: the shift that multiplies by n
+   constexpr int log2PowerOfTwo(size_t n)
+   {
+      return n < 2 ? 0 : 1 + log2PowerOfTwo(n / 2);
+   }
+
+/******************************************************
+ * DEQUE BLOCK
+ * How many cells the deque puts in a block of T: as many
+ * as fit in DEQUE_BLOCK_BYTES, rounded down to a power of
+ * two. Specialize this to pick the block size of a type.
+ *****************************************************/
+   template <typename T>
+   struct deque_block
+   {
+      static constexpr size_t numCells = floorPowerOfTwo(DEQUE_BLOCK_BYTES / sizeof(T));
+   };
+
 /******************************************************
  * DEQUE
+ * BS is the number of cells in a block. It must be a
+ * power of two so index translation is a shift and a mask.
  *****************************************************/
-   template <typename T, typename A = std::allocator<T>>
+   template <typename T, typename A = std::allocator<T>,
+             size_t BS = deque_block<T>::numCells>
    class deque
    {
       friend class ::TestDeque; // give unit tests access to the privates
+      static_assert(isPowerOfTwo(BS), "block size must be a power of two");
+      // the map is allocated with A rebound to T*
+      typedef std::allocator_traits<A>                               alloc_traits;
+      typedef typename alloc_traits::template rebind_alloc<T*>       map_allocator;
+      typedef std::allocator_traits<map_allocator>                   map_traits;
    public:
+      typedef A allocator_type;
 
       // 
       // Construct
       //
       deque(const A& a = A())
          : alloc(a), data(nullptr),
-         numCells(16), numBlocks(0), numElements(0), iaFront(0)
+         numBlocks(0), numElements(0), iaFront(0), numSpare(0)
       {}
-      deque(deque& rhs);
+      deque(const deque& rhs);
+      deque(deque&& rhs) noexcept;
       ~deque()
       {
-         clear();
+         release();
       }
 
       //
       // Assign
       //
-      deque& operator = (deque& rhs);
+      deque& operator = (const deque& rhs);
+      deque& operator = (deque&& rhs)
+         noexcept(alloc_traits::propagate_on_container_move_assignment::value
+                  || alloc_traits::is_always_equal::value);
+      void swap(deque& rhs) noexcept;
+      A get_allocator() const { return alloc; }
 
       // 
       // Iterator
       //
-      class iterator;
+      template <typename V>
+      class basic_iterator;
+      typedef basic_iterator<T>                     iterator;
+      typedef basic_iterator<const T>               const_iterator;
+      typedef std::reverse_iterator<iterator>       reverse_iterator;
+      typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
       iterator begin()
       {
          return iterator(0, this);
@@ -68,6 +220,38 @@ namespace custom
       {
          return iterator(numElements, this);
       }
+      const_iterator begin() const  { return const_iterator(0, this);           }
+      const_iterator end()   const  { return const_iterator(numElements, this); }
+      const_iterator cbegin() const { return begin();                           }
+      const_iterator cend()   const { return end();                             }
+      reverse_iterator       rbegin()        { return reverse_iterator(end());         }
+      reverse_iterator       rend()          { return reverse_iterator(begin());       }
+      const_reverse_iterator rbegin()  const { return const_reverse_iterator(end());   }
+      const_reverse_iterator rend()    const { return const_reverse_iterator(begin()); }
+      const_reverse_iterator crbegin() const { return rbegin();                        }
+      const_reverse_iterator crend()   const { return rend();                          }
+
+      //
+      // Segments: the deque as a run of contiguous spans, one per block
+      //
+      template <typename V>
+      class segment_range;
+      segment_range<T> segments()
+      {
+         return segment_range<T>(this, 0, (int)numElements);
+      }
+      segment_range<const T> segments() const
+      {
+         return segment_range<const T>(this, 0, (int)numElements);
+      }
+      segment_range<T> segments(iterator first, iterator last)
+      {
+         return segment_range<T>(this, first.id, last.id);
+      }
+      segment_range<const T> segments(const_iterator first, const_iterator last) const
+      {
+         return segment_range<const T>(this, first.id, last.id);
+      }
 
       // 
       // Access
@@ -100,31 +284,80 @@ namespace custom
       //
       // Insert
       //
-      void push_back(const T& t);
-      void push_back(T&& t);
-      void push_front(const T& t);
-      void push_front(T&& t);
+      void push_back(const T& t)  { emplace_back(t);             }
+      void push_back(T&& t)       { emplace_back(std::move(t));  }
+      void push_front(const T& t) { emplace_front(t);            }
+      void push_front(T&& t)      { emplace_front(std::move(t)); }
+      template <typename ... Args>
+      T& emplace_back(Args&& ... args);
+      template <typename ... Args>
+      T& emplace_front(Args&& ... args);
+      template <typename InputIt,
+                typename = typename std::iterator_traits<InputIt>::iterator_category>
+      void append(InputIt first, InputIt last);
+      void append(size_t n, const T& t);
+      template <typename InputIt,
+                typename = typename std::iterator_traits<InputIt>::iterator_category>
+      void prepend(InputIt first, InputIt last);
+      void splice_back(deque& other);
+      void splice_front(deque& other);
 
       //
       // Remove
       //
       void pop_front();
       void pop_back();
+      void drop_front(size_t n)
+      {
+         drop_front(n, [this](T* block) { releaseBlock(block); });
+      }
       void clear();
 
+      //
+      // Blocks: fill the back and drain the front a block at a time. The
+      // caller hands in the blocks and takes the emptied ones back, from
+      // and to an allocator equal to ours
+      //
+      template <typename NewBlock>
+      segment_range<T> back_free(size_t n, NewBlock newBlock);
+      template <typename FreeBlock>
+      void commit_back(size_t n, FreeBlock freeBlock);
+      template <typename FreeBlock>
+      void drop_front(size_t n, FreeBlock freeBlock);
+
       //
       // Status
       //
       size_t size()  const { return numElements; }
       bool   empty() const { return numElements == 0; }
 
+#ifdef DEQUE_POSIX
+      //
+      // Snapshot: the elements as bytes, for trivially copyable T
+      //
+      // what save() writes ahead of the elements
+      struct snapshot_header
+      {
+         char magic[8];          // "CDQSNAP1"
+         uint64_t cellBytes;     // sizeof(T)
+         uint64_t numElements;   // how many follow
+      };
+      void save(int fd) const;
+      void load(int fd);
+#endif
+
    private:
-      // array index from deque index
+      static constexpr int cellShift = log2PowerOfTwo(BS);
+      static constexpr size_t numCells = BS;   // number of cells in a block
+
+      // array index from deque index. The map is always a power of two
+      // blocks long, so wrapping around it is a mask
       int iaFromID(int id) const
       {
          //assert(0 <= id && id < numElements); // tests don't take numElements into account
          assert(0 <= iaFront && iaFront < numCells * numBlocks);
-         int ia = ((id + iaFront) % (numBlocks * numCells));
+         assert((numBlocks & (numBlocks - 1)) == 0);
+         int ia = (id + iaFront) & (int)(numBlocks * BS - 1);
          assert(0 <= ia && ia < numCells * numBlocks);
          return ia;
       }
@@ -132,7 +365,7 @@ namespace custom
       // block index from deque index
       int ibFromID(int id) const
       {
-         int ib = iaFromID(id) / numCells;
+         int ib = iaFromID(id) >> cellShift;
          assert(0 <= ib && ib < numBlocks);
          return ib;
       }
@@ -140,7 +373,7 @@ namespace custom
       // cell index from deque index
       int icFromID(int id) const
       {
-         int ic = iaFromID(id) % numCells;
+         int ic = iaFromID(id) & (int)(BS - 1);
          assert(0 <= ic && ic < numCells);
          return ic;
       }
@@ -148,324 +381,1215 @@ namespace custom
       // reallocate
       void reallocate(int numBlocksNew);
 
+      // a block to put cells in: a spare one if we have it
+      T* allocateBlock()
+      {
+         if (numSpare)
+            return spare[--numSpare];
+         return alloc_traits::allocate(alloc, numCells);
+      }
+
+      // done with an empty block: keep it as a spare if there is room
+      void releaseBlock(T* block)
+      {
+         if (numSpare < DEQUE_SPARE_BLOCKS)
+            spare[numSpare++] = block;
+         else
+            alloc_traits::deallocate(alloc, block, numCells);
+      }
+
+      // give every block and the map back to the allocator
+      void release();
+
+      // hand our map and blocks to rhs and take its, keeping the allocators
+      void swapStorage(deque& rhs) noexcept;
+
+      // grow the map so numBack more elements fit at the back and numFront at the front
+      void reserveBlocks(size_t numBack, size_t numFront = 0);
+
+      // destroy every element past the first numKeep and release their blocks
+      void trimBack(size_t numKeep);
+
+      // release the blocks under [numElements, idLast) that hold no element
+      void releaseBackBlocks(size_t idLast);
+
+      // construct count cells at dest from first, return first's new position.
+      // Nothing is left constructed if a copy throws
+      template <typename InputIt>
+      InputIt copyCells(InputIt first, size_t count, T* dest);
+
+#ifdef DEQUE_POSIX
+      // all of num iovecs, however many calls it takes
+      static void writevAll(int fd, struct iovec* iov, size_t num);
+      static void readvAll(int fd, struct iovec* iov, size_t num);
+#endif
+
       A alloc;               // use alloacator for memory allocation
-      size_t numCells;       // number of cells in a block
       size_t numBlocks;      // number of blocks in the data array
       size_t numElements;    // number of elements in the deque
       int iaFront;           // array-centered index of the front of the deque
       T** data;              // array of arrays
+      T* spare[DEQUE_SPARE_BLOCKS ? DEQUE_SPARE_BLOCKS : 1]; // emptied blocks kept for reuse
+      size_t numSpare;       // number of blocks in spare
    };
 
    /**************************************************
     * DEQUE ITERATOR
-    * An iterator through deque.  You only need to
-    * support the following:
-    *   1. Constructors (default and copy)
-    *   2. Not equals operator
-    *   3. Increment (prefix and postfix)
-    *   4. Dereference
-    * This particular iterator is a bi-directional meaning
-    * that ++ and -- both work.  Not all iterators are that way.
+    * A random-access iterator through deque. V is T for
+    * the iterator and const T for the const_iterator.
+    *
+    * The iterator caches the block it is in: pCur is the
+    * cell, [pFirst, pLast) is the block. Walking within a
+    * block is pointer arithmetic. Stepping off the block
+    * clears pCur and the next dereference finds the new
+    * block through the index translators, so a jump of
+    * any distance is constant time.
     *************************************************/
-   template <typename T, typename A>
-   class deque <T, A> ::iterator
+   template <typename T, typename A, size_t BS>
+   template <typename V>
+   class deque <T, A, BS> ::basic_iterator
    {
       friend class ::TestDeque; // give unit tests access to the privates
+      template <typename W>
+      friend class basic_iterator;
+      typedef typename std::conditional<std::is_const<V>::value,
+                                        const deque, deque>::type container;
    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef typename std::remove_const<V>::type value_type;
+      typedef ptrdiff_t difference_type;
+      typedef V* pointer;
+      typedef V& reference;
+
       // 
       // Construct
       //
-      iterator()
+      basic_iterator() : id(0), d(nullptr), pCur(nullptr), pFirst(nullptr), pLast(nullptr)
+      {}
+      basic_iterator(int id, container* d) : id(id), d(d), pCur(nullptr), pFirst(nullptr), pLast(nullptr)
       {}
-      iterator(int id, deque* d) : id(id), d(d)
+      basic_iterator(const basic_iterator& rhs) : id(rhs.id), d(rhs.d),
+         pCur(rhs.pCur), pFirst(rhs.pFirst), pLast(rhs.pLast)
       {}
-      iterator(const iterator& rhs) : id(rhs.id), d(rhs.d)
+      // an iterator converts to a const_iterator, but not back
+      template <typename W,
+                typename = typename std::enable_if<std::is_convertible<W*, V*>::value>::type>
+      basic_iterator(const basic_iterator<W>& rhs) : id(rhs.id), d(rhs.d),
+         pCur(rhs.pCur), pFirst(rhs.pFirst), pLast(rhs.pLast)
       {}
 
       //
       // Assign
       //
-      iterator& operator = (const iterator& rhs)
+      basic_iterator& operator = (const basic_iterator& rhs)
       {
          id = rhs.id;
          d = rhs.d;
+         pCur = rhs.pCur;
+         pFirst = rhs.pFirst;
+         pLast = rhs.pLast;
          return *this;
       }
 
       // 
       // Compare
       //
-      bool operator != (const iterator& rhs) const { return id != rhs.id || d != rhs.d; }
-      bool operator == (const iterator& rhs) const { return id == rhs.id && d == rhs.d; }
+      template <typename W>
+      bool operator != (const basic_iterator<W>& rhs) const { return id != rhs.id || d != rhs.d; }
+      template <typename W>
+      bool operator == (const basic_iterator<W>& rhs) const { return id == rhs.id && d == rhs.d; }
+      template <typename W>
+      bool operator <  (const basic_iterator<W>& rhs) const { return id <  rhs.id; }
+      template <typename W>
+      bool operator >  (const basic_iterator<W>& rhs) const { return id >  rhs.id; }
+      template <typename W>
+      bool operator <= (const basic_iterator<W>& rhs) const { return id <= rhs.id; }
+      template <typename W>
+      bool operator >= (const basic_iterator<W>& rhs) const { return id >= rhs.id; }
 
       // 
       // Access
       //
-      T& operator * ()
+      V& operator * () const
       {
-         return (*d)[id];
+         if (!pCur)
+            seek();
+         return *pCur;
+      }
+      V* operator -> () const
+      {
+         return &**this;
+      }
+      V& operator [] (difference_type offset) const
+      {
+         return *(*this + offset);
       }
 
       // 
       // Arithmetic
       //
-      int operator - (iterator it) const
+      template <typename W>
+      difference_type operator - (const basic_iterator<W>& it) const
       {
          return id - it.id;
       }
-      iterator& operator += (int offset)
+      basic_iterator& operator += (difference_type offset)
       {
-         if (offset > 0)
-         {
-            while (offset--)
-               ++(*this);
-         }
-         else if (offset < 0)
+         id += (int)offset;
+         if (pCur)
          {
-            while (offset++)
-               --(*this);
+            ptrdiff_t ic = (pCur - pFirst) + offset;
+            pCur = (0 <= ic && ic < pLast - pFirst) ? pFirst + ic : nullptr;
          }
          return *this;
       }
-      iterator& operator ++ ()
+      basic_iterator& operator -= (difference_type offset)
+      {
+         return *this += -offset;
+      }
+      basic_iterator operator + (difference_type offset) const
+      {
+         basic_iterator temp(*this);
+         return temp += offset;
+      }
+      basic_iterator operator - (difference_type offset) const
+      {
+         basic_iterator temp(*this);
+         return temp += -offset;
+      }
+      friend basic_iterator operator + (difference_type offset, const basic_iterator& it)
+      {
+         return it + offset;
+      }
+      basic_iterator& operator ++ ()
       {
          ++id;
+         if (pCur && ++pCur == pLast)
+            pCur = nullptr;
          return *this;
       }
-      iterator operator ++ (int postfix)
+      basic_iterator operator ++ (int postfix)
       {
-         iterator temp(*this);
-         ++id;
+         basic_iterator temp(*this);
+         ++(*this);
          return temp;
       }
-      iterator& operator -- ()
+      basic_iterator& operator -- ()
       {
          --id;
+         if (pCur)
+            pCur = (pCur == pFirst) ? nullptr : pCur - 1;
          return *this;
       }
-      iterator operator -- (int postfix)
+      basic_iterator operator -- (int postfix)
       {
-         iterator temp(*this);
-         --id;
+         basic_iterator temp(*this);
+         --(*this);
          return temp;
       }
 
+      // 
+      // Segments: [*this, last) one block at a time, see algorithm.h
+      //
+      typedef typename deque::template segment_range<V> segment_range;
+      segment_range segments(const basic_iterator& last) const
+      {
+         return segment_range(d, id, last.id);
+      }
+
       int id;
    private:
-      deque* d;
+      // find the block holding id and cache it
+      void seek() const
+      {
+         pFirst = d->data[d->ibFromID(id)];
+         pLast = pFirst + d->numCells;
+         pCur = pFirst + d->icFromID(id);
+      }
+
+      container* d;
+      mutable V* pCur;       // the cell at id, or nullptr if not cached yet
+      mutable V* pFirst;     // the first cell of pCur's block
+      mutable V* pLast;      // one past the last cell of pCur's block
+   };
+
+   /**************************************************
+    * DEQUE SEGMENT RANGE
+    * The elements [idFirst, idLast) as contiguous spans in
+    * deque order. Every span lies inside one block, so the
+    * wrap of the map never splits a span.
+    *
+    *      0     1    2       0    1    2
+    *    +----+----+----+  +----+----+----+
+    *    |    | 31 | 49 |  | 55 | 67 |    |   ==>  [31, 49] [55, 67]
+    *    +----+----+----+  +----+----+----+
+    *************************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename V>
+   class deque <T, A, BS> ::segment_range
+   {
+      friend class ::TestDeque; // give unit tests access to the privates
+      typedef typename std::conditional<std::is_const<V>::value,
+                                        const deque, deque>::type container;
+   public:
+      class iterator
+      {
+      public:
+         typedef std::forward_iterator_tag iterator_category;
+         typedef span<V> value_type;
+         typedef ptrdiff_t difference_type;
+         typedef const span<V>* pointer;
+         typedef span<V> reference;
+
+         iterator(container* d, int id, int idLast) : d(d), id(id), idLast(idLast) {}
+
+         bool operator != (const iterator& rhs) const { return id != rhs.id; }
+         bool operator == (const iterator& rhs) const { return id == rhs.id; }
+
+         // the span from id to the end of its block or of the range
+         span<V> operator * () const
+         {
+            int ic = d->icFromID(id);
+            return span<V>(d->data[d->ibFromID(id)] + ic,
+                           std::min((int)d->numCells - ic, idLast - id));
+         }
+
+         iterator& operator ++ ()
+         {
+            id = std::min(id + (int)d->numCells - d->icFromID(id), idLast);
+            return *this;
+         }
+         iterator operator ++ (int postfix)
+         {
+            iterator temp(*this);
+            ++(*this);
+            return temp;
+         }
+
+      private:
+         container* d;
+         int id;
+         int idLast;
+      };
+
+      segment_range(container* d, int idFirst, int idLast)
+         : d(d), idFirst(idFirst), idLast(idLast)
+      {
+         // back_free() hands out the cells past the back too
+         assert(0 <= idFirst && idFirst <= idLast && idLast <= (int)(d->numBlocks * numCells));
+      }
+
+      iterator begin() const { return iterator(d, idFirst, idLast); }
+      iterator end()   const { return iterator(d, idLast,  idLast); }
+
+   private:
+      container* d;
+      int idFirst;
+      int idLast;
    };
 
    /*****************************************
     * DEQUE :: COPY CONSTRUCTOR
-    * Allocate the space for the elements and
-    * call the copy constructor on each element
+    * Size the map once and copy rhs in a block at
+    * a time
     ****************************************/
-   template <typename T, typename A>
-   deque <T, A> ::deque(deque& rhs) : deque()
+   template <typename T, typename A, size_t BS>
+   deque <T, A, BS> ::deque(const deque& rhs)
+      : deque(alloc_traits::select_on_container_copy_construction(rhs.alloc))
    {
       *this = rhs;
    }
 
+   /*****************************************
+    * DEQUE :: MOVE CONSTRUCTOR
+    * Take rhs's map and blocks, leaving it empty
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   deque <T, A, BS> ::deque(deque&& rhs) noexcept : deque(rhs.alloc)
+   {
+      swapStorage(rhs);
+   }
+
    /*****************************************
     * DEQUE :: COPY-ASSIGN
-    * Allocate the space for the elements and
-    * call the copy constructor on each element
+    * Assign over the elements we share with rhs, then
+    * trim ours or append the rest of rhs's. Both sides
+    * go a block at a time even when their blocks do not
+    * line up, so trivially copyable Ts are block copies
     ****************************************/
-   template <typename T, typename A>
-   deque <T, A>& deque <T, A> :: operator = (deque& rhs)
+   template <typename T, typename A, size_t BS>
+   deque <T, A, BS>& deque <T, A, BS> :: operator = (const deque& rhs)
    {
-      alloc = rhs.alloc;
+      if (this == &rhs)
+         return *this;
 
-      iterator itLHS = begin();
-      iterator itRHS = rhs.begin();
+      // taking rhs's allocator: ours must free what it allocated first
+      if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+      {
+         if (alloc != rhs.alloc)
+            release();
+         alloc = rhs.alloc;
+      }
 
-      // Create end iterators now because deques will change.
-      iterator lhs_end = end();
-      iterator rhs_end = rhs.end();
+      // assign over the elements both deques have
+      size_t numCommon = std::min(numElements, rhs.numElements);
+      custom::copy(rhs.begin(), rhs.begin() + numCommon, begin());
 
-      for (; itLHS != lhs_end && itRHS != rhs_end; ++itLHS, ++itRHS)
-         *itLHS = *itRHS;
+      // lhs longer, remove the extra elements
+      if (numElements > rhs.numElements)
+         trimBack(rhs.numElements);
 
+      // rhs longer, size the map once and add the extra elements
+      if (rhs.numElements > numCommon)
+      {
+         reserveBlocks(rhs.numElements - numCommon);
+         for (span<const T> seg : rhs.segments(rhs.begin() + numCommon, rhs.end()))
+            append(seg.begin(), seg.end());
+      }
 
-      // lhs longer, remove the extra elements
-      for (; itLHS != lhs_end; ++itLHS)
-         pop_back();
+      return *this;
+   }
 
-      // rhs longer, add the extra elements
-      for (; itRHS != rhs_end; ++itRHS)
-         push_back(*itRHS);
+   /*****************************************
+    * DEQUE :: MOVE-ASSIGN
+    * Free our storage and take rhs's. An allocator that
+    * does not follow the elements and is not equal to
+    * rhs's cannot free rhs's blocks, so then the
+    * elements are moved over one at a time
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   deque <T, A, BS>& deque <T, A, BS> :: operator = (deque&& rhs)
+      noexcept(alloc_traits::propagate_on_container_move_assignment::value
+               || alloc_traits::is_always_equal::value)
+   {
+      if (this == &rhs)
+         return *this;
 
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+      {
+         release();
+         alloc = std::move(rhs.alloc);
+         swapStorage(rhs);
+      }
+      else
+      {
+         if (alloc == rhs.alloc)
+         {
+            release();
+            swapStorage(rhs);
+         }
+         else
+         {
+            clear();
+            append(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+            rhs.clear();
+         }
+      }
       return *this;
    }
 
    /*****************************************
-    * DEQUE :: PUSH_BACK
-    * add an element to the back of the deque
+    * DEQUE :: SWAP
+    * Exchange the maps and the bookkeeping. No
+    * element or block moves. The allocators only
+    * trade places if they follow the elements
     ****************************************/
-   template <typename T, typename A>
-   void deque <T, A> ::push_back(const T& t)
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::swap(deque& rhs) noexcept
    {
-      // 1. Reallocate the array of blocks as needed
-      if (numElements == numBlocks * numCells
-          || icFromID(numElements) == 0 && numBlocks <= (numElements + numCells) / numCells)
-         reallocate(numBlocks ? numBlocks * 2 : 1);
+      if constexpr (alloc_traits::propagate_on_container_swap::value)
+      {
+         using std::swap;
+         swap(alloc, rhs.alloc);
+      }
+      swapStorage(rhs);
+   }
 
-      // 2. Allocate a new block as needed
-      int ib = ibFromID(numElements);
-      if (!data[ib])
-         data[ib] = alloc.allocate(sizeof(T) * numCells);
+   /*****************************************
+    * DEQUE :: SWAP STORAGE
+    * Exchange everything but the allocators
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::swapStorage(deque& rhs) noexcept
+   {
+      std::swap(data,        rhs.data);
+      std::swap(numBlocks,   rhs.numBlocks);
+      std::swap(numElements, rhs.numElements);
+      std::swap(iaFront,     rhs.iaFront);
+      std::swap(spare,       rhs.spare);
+      std::swap(numSpare,    rhs.numSpare);
+   }
 
-      // 3. Assign the value into the block
-      new ((void*)(&(data[ib][icFromID(numElements)]))) T(t);
-      numElements++;
+   template <typename T, typename A, size_t BS>
+   void swap(deque <T, A, BS>& lhs, deque <T, A, BS>& rhs) noexcept
+   {
+      lhs.swap(rhs);
    }
 
    /*****************************************
-    * DEQUE :: PUSH_BACK - move
-    * add an element to the back of the deque
+    * DEQUE :: EMPLACE_BACK
+    * add an element to the back of the deque,
+    * constructed in place from args
     ****************************************/
-   template <typename T, typename A>
-   void deque <T, A> ::push_back(T&& t)
+   template <typename T, typename A, size_t BS>
+   template <typename ... Args>
+   T& deque <T, A, BS> ::emplace_back(Args&& ... args)
    {
-      // 1. Reallocate the array of blocks as needed
-      if (numElements == numBlocks * numCells
-          || icFromID(numElements) == 0 && numBlocks <= (numElements + numCells) / numCells)
-         reallocate(numBlocks ? numBlocks * 2 : 1);
+      // 1. Grow the array of blocks only when a new block has no free slot
+      if (numElements == 0 || icFromID(numElements) == 0)
+         reserveBlocks(1);
 
       // 2. Allocate a new block as needed
       int ib = ibFromID(numElements);
       if (!data[ib])
-         data[ib] = alloc.allocate(sizeof(T) * numCells);
+         data[ib] = allocateBlock();
 
-      // 3. Move the value into the block
-      new ((void*)(&(data[ib][icFromID(numElements)]))) T(std::move(t));
+      // 3. Construct the value in the block
+      T* p = &data[ib][icFromID(numElements)];
+      alloc_traits::construct(alloc, p, std::forward<Args>(args)...);
       numElements++;
+      return *p;
    }
 
    /*****************************************
-    * DEQUE :: PUSH_FRONT
-    * add an element to the front of the deque
+    * DEQUE :: EMPLACE_FRONT
+    * add an element to the front of the deque,
+    * constructed in place from args
     ****************************************/
-   template <typename T, typename A>
-   void deque <T, A> ::push_front(const T& t)
+   template <typename T, typename A, size_t BS>
+   template <typename ... Args>
+   T& deque <T, A, BS> ::emplace_front(Args&& ... args)
    {
-      // 1. Reallocate the array of blocks as needed
-      if (numElements == numBlocks * numCells || numBlocks <= (numElements + numCells) / numCells)
-         reallocate(numBlocks ? numBlocks * 2 : 1);
-      // ^ puts iaFront into first block with unwrapping
+      // 1. Grow the array of blocks only when a new block has no free slot.
+      //    The front's own block may still have room before the front.
+      if (numElements == 0 || icFromID(0) == 0)
+         reserveBlocks(0, 1);
+
+      // The new front goes in the cell just before the current front
+      int idBefore = (int)(numBlocks * numCells) - 1;
+      int ib = ibFromID(idBefore);
+      int ic = icFromID(idBefore);
 
-      // Calculate new front position
-      iaFront = (iaFront - 1 + numBlocks * numCells) % (numBlocks * numCells);
-      
       // 2. Allocate a new block as needed
-      int ib = iaFront / numCells;
       if (!data[ib])
-         data[ib] = alloc.allocate(sizeof(T) * numCells);
+         data[ib] = allocateBlock();
 
-      // 3. Assign the value into the block
-      int ic = iaFront % numCells;
-      new ((void*)(&(data[ib][ic]))) T(t);
+      // 3. Construct the value in the block, then it is the front
+      T* p = &data[ib][ic];
+      alloc_traits::construct(alloc, p, std::forward<Args>(args)...);
+      iaFront = iaFromID(idBefore);
       numElements++;
+      return *p;
    }
 
    /*****************************************
-    * DEQUE :: PUSH_FRONT - move
-    * add an element to the front of the deque
+    * DEQUE :: APPEND
+    * add [first, last) to the back of the deque. Grow
+    * the map once, allocate the blocks, then fill them
+    * a block at a time
     ****************************************/
-   template <typename T, typename A>
-   void deque <T, A> ::push_front(T&& t)
+   template <typename T, typename A, size_t BS>
+   template <typename InputIt, typename>
+   void deque <T, A, BS> ::append(InputIt first, InputIt last)
    {
-      // 1. Reallocate the array of blocks as needed
-      if (numElements == numBlocks * numCells || numBlocks <= (numElements + numCells) / numCells)
-         reallocate(numBlocks ? numBlocks * 2 : 1);
-      // ^ puts iaFront into first block with unwrapping
+      // a single-pass range cannot be measured first
+      if constexpr (!std::is_base_of<std::forward_iterator_tag,
+                       typename std::iterator_traits<InputIt>::iterator_category>::value)
+      {
+         for (; first != last; ++first)
+            push_back(*first);
+      }
+      else
+      {
+         size_t n = std::distance(first, last);
+         if (n == 0)
+            return;
 
-      // Calculate new front position
-      iaFront = (iaFront - 1 + numBlocks * numCells) % (numBlocks * numCells);
+         // 1. Reallocate the array of blocks once
+         reserveBlocks(n);
 
-      // 2. Allocate a new block as needed
-      int ib = iaFront / numCells;
-      if (!data[ib])
-         data[ib] = alloc.allocate(sizeof(T) * numCells);
+         size_t idLast = numElements + n;
+         try
+         {
+            // 2. Allocate every block the new elements land in
+            for (size_t id = numElements; id < idLast; id += numCells - icFromID(id))
+               if (!data[ibFromID(id)])
+                  data[ibFromID(id)] = allocateBlock();
+
+            // 3. Copy a block at a time
+            while (numElements < idLast)
+            {
+               size_t ic = icFromID(numElements);
+               size_t count = std::min(numCells - ic, idLast - numElements);
+               first = copyCells(first, count, data[ibFromID(numElements)] + ic);
+               numElements += count;
+            }
+         }
+         catch (...)
+         {
+            // the blocks past the last copy are not in the deque
+            releaseBackBlocks(idLast);
+            throw;
+         }
+      }
+   }
 
-      // 3. Assign the value into the block
-      int ic = iaFront % numCells;
-      new ((void*)(&(data[ib][ic]))) T(std::move(t));
-      numElements++;
+   /*****************************************
+    * DEQUE :: APPEND - fill
+    * add n copies of t to the back of the deque
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::append(size_t n, const T& t)
+   {
+      if (n == 0)
+         return;
+
+      // 1. Reallocate the array of blocks once
+      reserveBlocks(n);
+
+      size_t idLast = numElements + n;
+      try
+      {
+         // 2. Allocate every block the new elements land in
+         for (size_t id = numElements; id < idLast; id += numCells - icFromID(id))
+            if (!data[ibFromID(id)])
+               data[ibFromID(id)] = allocateBlock();
+
+         // 3. Fill a block at a time, counting each cell as it is built so
+         //    a throwing copy leaves every constructed cell owned
+         while (numElements < idLast)
+         {
+            size_t ic = icFromID(numElements);
+            size_t count = std::min(numCells - ic, idLast - numElements);
+            T* dest = data[ibFromID(numElements)] + ic;
+            for (size_t i = 0; i < count; i++, numElements++)
+               alloc_traits::construct(alloc, dest + i, t);
+         }
+      }
+      catch (...)
+      {
+         // the blocks past the last copy are not in the deque
+         releaseBackBlocks(idLast);
+         throw;
+      }
+   }
+
+   /*****************************************
+    * DEQUE :: PREPEND
+    * add [first, last) to the front of the deque, in
+    * order. Grow the map once, then fill the blocks in
+    * front of the front from the back of the range
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename InputIt, typename>
+   void deque <T, A, BS> ::prepend(InputIt first, InputIt last)
+   {
+      // we need to read the range back to front, so stage anything else
+      if constexpr (!std::is_base_of<std::random_access_iterator_tag,
+                       typename std::iterator_traits<InputIt>::iterator_category>::value)
+      {
+         std::vector<T> staged(first, last);
+         prepend(std::make_move_iterator(staged.begin()), std::make_move_iterator(staged.end()));
+      }
+      else
+      {
+         size_t n = last - first;
+         if (n == 0)
+            return;
+
+         // 1. Reallocate the array of blocks once
+         reserveBlocks(0, n);
+
+         // 2. Fill the cells before the front, a block at a time
+         int capacity = (int)(numBlocks * numCells);
+         while (n > 0)
+         {
+            // the cell just in front of the front and how much room is below it
+            int ib = ibFromID(capacity - 1);
+            size_t ic = icFromID(capacity - 1);
+            size_t count = std::min(ic + 1, n);
+            bool isNewBlock = !data[ib];
+            if (isNewBlock)
+               data[ib] = allocateBlock();
+
+            try
+            {
+               copyCells(first + (n - count), count, data[ib] + ic + 1 - count);
+            }
+            catch (...)
+            {
+               // a block of its own holds nothing now
+               if (isNewBlock)
+               {
+                  releaseBlock(data[ib]);
+                  data[ib] = nullptr;
+               }
+               throw;
+            }
+            iaFront = iaFromID(capacity - (int)count);
+            numElements += count;
+            n -= count;
+         }
+      }
+   }
+
+   /*****************************************
+    * DEQUE :: SPLICE BACK
+    * Move all of other's elements to our back, leaving
+    * other empty. Where the cells line up, other's blocks
+    * change hands whole and only the edge block is moved
+    * an element at a time. An element keeps its cell in
+    * its block, so when other's front does not sit where
+    * our back leaves off, the smaller side is moved over
+    * instead
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::splice_back(deque& other)
+   {
+      if (this == &other || other.numElements == 0)
+         return;
+
+      // our blocks cannot free what other's allocator gave it
+      if (!(alloc == other.alloc))
+      {
+         append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+         other.clear();
+         return;
+      }
+
+      // nothing of ours to line up with: take other's map as it is
+      if (numElements == 0)
+      {
+         clear();
+         swapStorage(other);
+         return;
+      }
+
+      // the cells do not line up: move the smaller side
+      if (icFromID((int)numElements) != other.icFromID(0))
+      {
+         if (other.numElements <= numElements)
+         {
+            append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            other.clear();
+         }
+         else
+         {
+            other.prepend(std::make_move_iterator(begin()), std::make_move_iterator(end()));
+            clear();
+            swapStorage(other);
+         }
+         return;
+      }
+
+      // 1. Reallocate the array of blocks once
+      reserveBlocks(other.numElements);
+
+      // 2. Fill our back block from other's front block
+      while (other.numElements > 0 && icFromID((int)numElements) != 0)
+      {
+         emplace_back(std::move(other.front()));
+         other.pop_front();
+      }
+
+      // 3. Both now start a block: hand the rest over a block at a time
+      for (size_t id = 0; id < other.numElements; id += numCells)
+      {
+         T*& from = other.data[other.ibFromID((int)id)];
+         T*& to = data[ibFromID((int)(numElements + id))];
+         assert(to == nullptr);
+         to = from;
+         from = nullptr;
+      }
+      numElements += other.numElements;
+      other.numElements = 0;
+   }
+
+   /*****************************************
+    * DEQUE :: SPLICE FRONT
+    * Move all of other's elements to our front, in
+    * order, leaving other empty. As splice_back, but
+    * other's back has to line up with our front
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::splice_front(deque& other)
+   {
+      if (this == &other || other.numElements == 0)
+         return;
+
+      // our blocks cannot free what other's allocator gave it
+      if (!(alloc == other.alloc))
+      {
+         prepend(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+         other.clear();
+         return;
+      }
+
+      // nothing of ours to line up with: take other's map as it is
+      if (numElements == 0)
+      {
+         clear();
+         swapStorage(other);
+         return;
+      }
+
+      // the cells do not line up: move the smaller side
+      if (icFromID(0) != other.icFromID((int)other.numElements))
+      {
+         if (other.numElements <= numElements)
+         {
+            prepend(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            other.clear();
+         }
+         else
+         {
+            other.append(std::make_move_iterator(begin()), std::make_move_iterator(end()));
+            clear();
+            swapStorage(other);
+         }
+         return;
+      }
+
+      // 1. Reallocate the array of blocks once
+      reserveBlocks(0, other.numElements);
+
+      // 2. Fill our front block from other's back block
+      while (other.numElements > 0 && icFromID(0) != 0)
+      {
+         emplace_front(std::move(other.back()));
+         other.pop_back();
+      }
+
+      // 3. Both now end a block: hand the rest over a block at a time,
+      //    back to front
+      int capacity = (int)(numBlocks * numCells);
+      for (size_t num = numCells; num < other.numElements + numCells; num += numCells)
+      {
+         T*& from = other.data[other.ibFromID((int)(other.numElements - std::min(num, other.numElements)))];
+         T*& to = data[ibFromID(capacity - (int)num)];
+         assert(to == nullptr);
+         to = from;
+         from = nullptr;
+      }
+      iaFront = iaFromID(capacity - (int)other.numElements);
+      numElements += other.numElements;
+      other.numElements = 0;
    }
 
    /*****************************************
     * DEQUE :: CLEAR
     * Remove all the elements from a deque
     ****************************************/
-   template <typename T, typename A>
-   void deque <T, A> ::clear()
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::clear()
    {
       for (size_t id = 0; id < numElements; id++)
-         alloc.destroy(&data[ibFromID(id)][icFromID(id)]);
+         alloc_traits::destroy(alloc, &data[ibFromID(id)][icFromID(id)]);
 
       for (size_t ib = 0; ib < numBlocks; ib++)
       {
          assert(data != nullptr);
          if (data[ib])
          {
-            alloc.destroy(&data[ib]);
+            releaseBlock(data[ib]);
             data[ib] = nullptr;
          }
       }
       numElements = 0;
    }
 
+   /*****************************************
+    * DEQUE :: RELEASE
+    * Remove all the elements, then free the spare
+    * blocks and the map
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::release()
+   {
+      if (data)
+         clear();
+      while (numSpare)
+         alloc_traits::deallocate(alloc, spare[--numSpare], numCells);
+      if (data)
+      {
+         map_allocator mapAlloc(alloc);
+         map_traits::deallocate(mapAlloc, data, numBlocks);
+      }
+      data = nullptr;
+      numBlocks = 0;
+      iaFront = 0;
+   }
+
+#ifdef DEQUE_POSIX
+   /*****************************************
+    * DEQUE :: SAVE
+    * Write a header and then every element, in deque
+    * order, straight from the blocks: one iovec per
+    * block, all in one writev when IOV_MAX allows
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::save(int fd) const
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "a snapshot copies elements as bytes");
+
+      snapshot_header header = { { 'C', 'D', 'Q', 'S', 'N', 'A', 'P', '1' },
+                                 sizeof(T), numElements };
+      std::vector<struct iovec> iov;
+      iov.reserve(numBlocks + 1);
+      iov.push_back({ &header, sizeof(header) });
+      for (span<const T> seg : segments())
+         iov.push_back({ (void*)seg.data(), seg.size() * sizeof(T) });
+      writevAll(fd, iov.data(), iov.size());
+   }
+
+   /*****************************************
+    * DEQUE :: LOAD
+    * Replace the elements with a snapshot from save().
+    * Allocate every block first, then read straight
+    * into them with one readv
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::load(int fd)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "a snapshot copies elements as bytes");
+
+      snapshot_header header;
+      struct iovec iovHeader = { &header, sizeof(header) };
+      readvAll(fd, &iovHeader, 1);
+      if (std::memcmp(header.magic, "CDQSNAP1", 8) != 0 || header.cellBytes != sizeof(T))
+         throw std::runtime_error("deque::load: not a snapshot of this type");
+
+      clear();
+      size_t n = (size_t)header.numElements;
+      if (n == 0)
+         return;
+
+      // 1. Reallocate the array of blocks once
+      reserveBlocks(n);
+
+      // 2. Allocate every block the elements land in
+      std::vector<struct iovec> iov;
+      for (size_t id = 0; id < n; )
+      {
+         size_t ic = icFromID(id);
+         size_t count = std::min(numCells - ic, n - id);
+         T*& block = data[ibFromID(id)];
+         if (!block)
+            block = allocateBlock();
+         iov.push_back({ block + ic, count * sizeof(T) });
+         id += count;
+      }
+
+      // 3. Read them in. Until they are all there the deque stays empty
+      try
+      {
+         readvAll(fd, iov.data(), iov.size());
+      }
+      catch (...)
+      {
+         clear();
+         throw;
+      }
+      numElements = n;
+   }
+
+   /*****************************************
+    * DEQUE :: WRITEV ALL
+    * writev can stop short, and takes at most
+    * IOV_MAX iovecs a call
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::writevAll(int fd, struct iovec* iov, size_t num)
+   {
+      while (num > 0)
+      {
+         ssize_t numBytes = ::writev(fd, iov, (int)std::min(num, (size_t)IOV_MAX));
+         if (numBytes < 0)
+         {
+            if (errno == EINTR)
+               continue;
+            throw std::system_error(errno, std::generic_category(), "writev");
+         }
+
+         // skip what was written, part way into an iovec if need be
+         for (; num > 0 && (size_t)numBytes >= iov->iov_len; iov++, num--)
+            numBytes -= iov->iov_len;
+         if (num > 0)
+         {
+            iov->iov_base = (char*)iov->iov_base + numBytes;
+            iov->iov_len -= numBytes;
+         }
+      }
+   }
+
+   /*****************************************
+    * DEQUE :: READV ALL
+    * As writevAll, but the end of the file before
+    * the last iovec is filled is an error
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::readvAll(int fd, struct iovec* iov, size_t num)
+   {
+      while (num > 0)
+      {
+         ssize_t numBytes = ::readv(fd, iov, (int)std::min(num, (size_t)IOV_MAX));
+         if (numBytes < 0)
+         {
+            if (errno == EINTR)
+               continue;
+            throw std::system_error(errno, std::generic_category(), "readv");
+         }
+         if (numBytes == 0)
+            throw std::runtime_error("deque::load: snapshot is cut short");
+
+         for (; num > 0 && (size_t)numBytes >= iov->iov_len; iov++, num--)
+            numBytes -= iov->iov_len;
+         if (num > 0)
+         {
+            iov->iov_base = (char*)iov->iov_base + numBytes;
+            iov->iov_len -= numBytes;
+         }
+      }
+   }
+#endif // DEQUE_POSIX
+
    /*****************************************
     * DEQUE :: POP FRONT
     * Remove the front element from a deque
     ****************************************/
-   template <typename T, typename A>
-   void deque <T, A> ::pop_front()
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::pop_front()
    {
       size_t idRemove = 0;
 
-      alloc.destroy(&data[ibFromID(idRemove)][icFromID(idRemove)]);
+      alloc_traits::destroy(alloc, &data[ibFromID(idRemove)][icFromID(idRemove)]);
 
       if (numElements == 1
-          || (icFromID(idRemove) == numCells - 1 && ibFromID(idRemove) != ibFromID(numCells - 1)))
+          || (icFromID(idRemove) == numCells - 1 && ibFromID(idRemove) != ibFromID(1)))
       {
-         alloc.destroy(&data[ibFromID(idRemove)]);
+         releaseBlock(data[ibFromID(idRemove)]);
          data[ibFromID(idRemove)] = nullptr;
       }
 
+      iaFront = iaFromID(1);
       numElements--;
-      iaFront++;
-      iaFront %= numCells * numBlocks;
    }
 
    /*****************************************
     * DEQUE :: POP BACK
     * Remove the back element from a deque
     ****************************************/
-   template <typename T, typename A>
-   void deque <T, A> ::pop_back()
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::pop_back()
    {
       size_t idRemove = numElements - 1;
 
-      alloc.destroy(&data[ibFromID(idRemove)][icFromID(idRemove)]);
+      alloc_traits::destroy(alloc, &data[ibFromID(idRemove)][icFromID(idRemove)]);
 
       if (numElements == 1
           || (icFromID(idRemove) == 0 && ibFromID(idRemove) != ibFromID(0)))
       {
-         alloc.destroy(&data[ibFromID(idRemove)]);
+         releaseBlock(data[ibFromID(idRemove)]);
          data[ibFromID(idRemove)] = nullptr;
       }
 
       numElements--;
    }
 
+   /*****************************************
+    * DEQUE :: TRIM BACK
+    * Destroy every element from numKeep on a segment
+    * at a time, then hand back each block that no
+    * longer holds a kept element
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::trimBack(size_t numKeep)
+   {
+      assert(numKeep <= numElements);
+      if (numKeep == numElements)
+         return;
+
+      // 1. Destroy the surplus
+      if constexpr (!std::is_trivially_destructible<T>::value)
+         for (span<T> seg : segments(begin() + numKeep, end()))
+            for (T& t : seg)
+               alloc_traits::destroy(alloc, &t);
+
+      // 2. Release the blocks past the last kept element
+      size_t idLast = numElements;
+      numElements = numKeep;
+      releaseBackBlocks(idLast);
+   }
+
+   /*****************************************
+    * DEQUE :: RELEASE BACK BLOCKS
+    * Hand back the blocks under the cells from the
+    * back to idLast, from the first one that starts
+    * past the last element. The block the elements
+    * end in stays
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::releaseBackBlocks(size_t idLast)
+   {
+      size_t id = numElements;
+      if (numElements > 0 && icFromID(numElements) != 0)
+         id += numCells - icFromID(numElements);
+      for (; id < idLast; id += numCells - icFromID(id))
+         if (data[ibFromID(id)])
+         {
+            releaseBlock(data[ibFromID(id)]);
+            data[ibFromID(id)] = nullptr;
+         }
+   }
+
+   /*****************************************
+    * DEQUE :: BACK FREE
+    * The n cells after the back as spans, one per
+    * block. Each slot without a block gets one from
+    * newBlock(). The cells are not elements until
+    * commit_back() counts them
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename NewBlock>
+   auto deque <T, A, BS> ::back_free(size_t n, NewBlock newBlock) -> segment_range<T>
+   {
+      reserveBlocks(n);
+      for (size_t id = numElements; id < numElements + n; id += numCells - icFromID((int)id))
+      {
+         T*& block = data[ibFromID((int)id)];
+         if (!block)
+            block = newBlock();
+      }
+      return segment_range<T>(this, (int)numElements, (int)(numElements + n));
+   }
+
+   /*****************************************
+    * DEQUE :: COMMIT BACK
+    * The first n cells after the back, filled by the
+    * caller, are elements now. The blocks back_free()
+    * put past the new back go to freeBlock()
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename FreeBlock>
+   void deque <T, A, BS> ::commit_back(size_t n, FreeBlock freeBlock)
+   {
+      numElements += n;
+      if (numBlocks == 0)
+         return;
+
+      // the block the back ends in stays; stop at the first empty slot or
+      // when we come round to the front's
+      size_t icFront = icFromID(0);
+      size_t id = numElements;
+      if (numElements > 0 && icFromID((int)id) != 0)
+         id += numCells - icFromID((int)id);
+      for (; id + icFront < numBlocks * numCells; id += numCells - icFromID((int)id))
+      {
+         T*& block = data[ibFromID((int)id)];
+         if (!block)
+            break;
+         freeBlock(block);
+         block = nullptr;
+      }
+   }
+
+   /*****************************************
+    * DEQUE :: DROP FRONT
+    * Remove n elements off the front a block at a
+    * time. Each block emptied goes to freeBlock()
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename FreeBlock>
+   void deque <T, A, BS> ::drop_front(size_t n, FreeBlock freeBlock)
+   {
+      n = std::min(n, numElements);
+      while (n > 0)
+      {
+         size_t ic = icFromID(0);
+         size_t count = std::min(numCells - ic, n);
+         T*& block = data[ibFromID(0)];
+         if constexpr (!std::is_trivially_destructible<T>::value)
+            for (size_t i = 0; i < count; i++)
+               alloc_traits::destroy(alloc, block + ic + i);
+         if (ic + count == numCells || count == numElements)
+         {
+            freeBlock(block);
+            block = nullptr;
+         }
+         iaFront = (iaFront + (int)count) & (int)(numBlocks * numCells - 1);
+         numElements -= count;
+         n -= count;
+      }
+   }
+
+   /*****************************************
+    * DEQUE :: RESERVE BLOCKS
+    * Double the array of blocks until numBack more
+    * elements fit behind the back and numFront more in
+    * front of the front. The map is circular, so a queue
+    * that drifts reuses the slots it leaves behind and
+    * every empty slot is headroom for either end: the
+    * map only grows once the blocks would overlap
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::reserveBlocks(size_t numBack, size_t numFront)
+   {
+      // blocks from the front's through the new back's, then the new front blocks
+      size_t icFront = numBlocks ? icFromID(0) : 0;
+      size_t numBlocksNeeded = (icFront + numElements + numBack + numCells - 1) / numCells
+         + (numFront > icFront ? (numFront - icFront + numCells - 1) / numCells : 0);
+      if (numBlocksNeeded <= numBlocks)
+         return;
+
+      size_t numBlocksNew = numBlocks ? numBlocks : 1;
+      while (numBlocksNew < numBlocksNeeded)
+         numBlocksNew *= 2;
+      reallocate((int)numBlocksNew);
+   }
+
+   /*****************************************
+    * DEQUE :: COPY CELLS
+    * Construct count cells at dest from first. A
+    * contiguous run of trivially copyable Ts is a
+    * single memcpy, anything else goes through the
+    * allocator's construct. If a copy throws, the
+    * cells already built in this run are destroyed
+    * before the exception goes on, so the caller
+    * never counts a partial run
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename InputIt>
+   InputIt deque <T, A, BS> ::copyCells(InputIt first, size_t count, T* dest)
+   {
+      if constexpr (std::is_trivially_copyable<T>::value && is_contiguous<InputIt, T>::value)
+      {
+         std::memcpy((void*)dest, (const void*)&*first, count * sizeof(T));
+         return first + count;
+      }
+      else
+      {
+         size_t i = 0;
+         try
+         {
+            for (; i < count; ++i, ++first)
+               alloc_traits::construct(alloc, dest + i, *first);
+         }
+         catch (...)
+         {
+            while (i > 0)
+               alloc_traits::destroy(alloc, dest + --i);
+            throw;
+         }
+         return first;
+      }
+   }
+
    /*****************************************
     * DEQUE :: REALLOCATE
     * Increase the size of the array of pointers
     ****************************************/
-   template <typename T, typename A>
-   void deque <T, A> ::reallocate(int numBlocksNew)
+   template <typename T, typename A, size_t BS>
+   void deque <T, A, BS> ::reallocate(int numBlocksNew)
    {
       // 1. Allocate a new array of pointers that is the requested size
       /**********************************************************************
@@ -477,7 +1601,8 @@ namespace custom
       *          |  \ | /  |      ===>     |    |    |    |    |
       *          +----+----+               +----+----+----+----+
       ***********************************************************************/
-      T** dataNew = (T**)this->alloc.allocate(numBlocksNew * sizeof(T*));
+      map_allocator mapAlloc(alloc);
+      T** dataNew = map_traits::allocate(mapAlloc, numBlocksNew);
 
       // 2. Copy over the pointers, unwrapping as we go
       /**********************************************************************
@@ -491,11 +1616,16 @@ namespace custom
       *          +----+----+        |       +----+----+----+----+
       * (Blocks don't ever move once created.)
       ***********************************************************************/
+      // The elements span every block from the front's through the back's.
+      // The front may start part way into its block, so count from there.
       int ibNew = 0;
-      for (int idOld = 0;
-           idOld < numElements;
-           idOld += numCells, ++ibNew)
-         dataNew[ibNew] = data[ibFromID(idOld)];
+      if (numElements > 0)
+      {
+         int ibFront = ibFromID(0);
+         int numBlocksUsed = (icFromID(0) + (int)numElements + (int)numCells - 1) / (int)numCells;
+         for (; ibNew < numBlocksUsed; ++ibNew)
+            dataNew[ibNew] = data[(ibFront + ibNew) % numBlocks];
+      }
 
       // 3. Set all the block pointers to NULL when there are no blocks to point to
       /**********************************************************************
@@ -527,13 +1657,23 @@ namespace custom
       //}
 
       // 5. Change the deque's member variables with the new values
-      if (data) delete data;
+      if (data)
+         map_traits::deallocate(mapAlloc, data, numBlocks);
       data = dataNew;
       numBlocks = numBlocksNew;
       iaFront = iaFront % numCells;
    }
-
-
-
+#if __has_include(<memory_resource>)
+   namespace pmr
+   {
+/******************************************************
+ * PMR DEQUE
+ * A deque whose blocks and map come from a
+ * std::pmr::memory_resource
+ *****************************************************/
+      template <typename T, size_t BS = deque_block<T>::numCells>
+      using deque = custom::deque<T, std::pmr::polymorphic_allocator<T>, BS>;
+   }
+#endif
 
 } // namespace custom
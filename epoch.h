@@ -0,0 +1,143 @@
+/***********************************************************************
+ * Header:
+ *    EPOCH
+ * Summary:
+ *    Epoch-based reclamation. A thread that may be reading shared
+ *    memory holds an epoch_guard; memory that is unlinked while
+ *    guards are out is retired rather than freed, and is only freed
+ *    once every thread has left the epoch in which it was retired.
+ *
+ *    The epoch only advances when every thread inside a guard has
+ *    seen the current epoch. Memory retired in epoch e is therefore
+ *    safe to free once the global epoch reaches e + 2.
+ *
+ *    This will contain the class definition of:
+ *        epoch_domain : The global epoch and every thread's record
+ *        epoch_guard  : Holds the calling thread in the current epoch
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>      // for std::atomic
+#include <cstdint>     // for uint64_t
+
+namespace custom
+{
+
+/******************************************************
+ * EPOCH DOMAIN
+ * One per process. A thread's record is claimed on
+ * its first guard and released, for another thread to
+ * reuse, when the thread exits. Records are never freed
+ *****************************************************/
+   class epoch_domain
+   {
+   public:
+      static epoch_domain& instance()
+      {
+         static epoch_domain domain;
+         return domain;
+      }
+
+      uint64_t current() const { return global.load(std::memory_order_seq_cst); }
+
+      // move the epoch on if no thread inside a guard lags behind it
+      bool tryAdvance()
+      {
+         uint64_t epoch = global.load(std::memory_order_seq_cst);
+         for (record* p = records.load(std::memory_order_acquire); p; p = p->next)
+         {
+            uint64_t local = p->epoch.load(std::memory_order_seq_cst);
+            if (local != 0 && local != epoch)
+               return false;
+         }
+         return global.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+      }
+
+      // can something retired in epoch retired be freed now?
+      bool isSafe(uint64_t retired) const { return retired + 2 <= current(); }
+
+   private:
+      friend class epoch_guard;
+
+      struct record
+      {
+         std::atomic<uint64_t> epoch{0};     // 0 when outside every guard
+         std::atomic<bool> inUse{true};      // owned by a live thread
+         int depth = 0;                      // nested guards, owner only
+         record* next = nullptr;
+      };
+
+      // the calling thread's record, released when it exits
+      struct local_record
+      {
+         record* p = nullptr;
+         ~local_record()
+         {
+            if (p)
+               p->inUse.store(false, std::memory_order_release);
+         }
+      };
+
+      epoch_domain() : global(1), records(nullptr) {}
+
+      record* localRecord()
+      {
+         static thread_local local_record local;
+         if (!local.p)
+            local.p = claimRecord();
+         return local.p;
+      }
+
+      // reuse a dead thread's record or add one
+      record* claimRecord()
+      {
+         for (record* p = records.load(std::memory_order_acquire); p; p = p->next)
+         {
+            bool free = false;
+            if (!p->inUse.load(std::memory_order_relaxed)
+                && p->inUse.compare_exchange_strong(free, true, std::memory_order_acquire))
+               return p;
+         }
+
+         record* p = new record;
+         record* head = records.load(std::memory_order_relaxed);
+         do
+            p->next = head;
+         while (!records.compare_exchange_weak(head, p, std::memory_order_release,
+                                                        std::memory_order_relaxed));
+         return p;
+      }
+
+      std::atomic<uint64_t> global;   // the current epoch, from 1
+      std::atomic<record*> records;   // every thread's record
+   };
+
+/******************************************************
+ * EPOCH GUARD
+ * While one is alive, nothing the thread can see will
+ * be freed. Guards nest
+ *****************************************************/
+   class epoch_guard
+   {
+   public:
+      epoch_guard() : pRecord(epoch_domain::instance().localRecord())
+      {
+         if (pRecord->depth++ == 0)
+            pRecord->epoch.store(epoch_domain::instance().current(), std::memory_order_seq_cst);
+      }
+      ~epoch_guard()
+      {
+         if (--pRecord->depth == 0)
+            pRecord->epoch.store(0, std::memory_order_release);
+      }
+      epoch_guard(const epoch_guard&) = delete;
+      epoch_guard& operator = (const epoch_guard&) = delete;
+
+   private:
+      epoch_domain::record* pRecord;
+   };
+
+} // namespace custom
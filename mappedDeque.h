@@ -0,0 +1,494 @@
+/***********************************************************************
+ * Header:
+ *    MAPPED DEQUE
+ * Summary:
+ *    A deque whose map and blocks live in a memory-mapped file, so a
+ *    process that reopens the file has the deque back at once, with
+ *    nothing to read or rebuild.
+ *
+ *    The file is a header followed by fixed-size block slots:
+ *
+ *       +--------------------------------------+--------+--------+---
+ *       | header: iaFront, numElements, ...    | slot 0 | slot 1 |
+ *       | table: the slot of each map position |        |        |
+ *       +--------------------------------------+--------+--------+---
+ *
+ *    The table is the deque's map, with slot numbers for pointers,
+ *    and ids translate to a block and a cell exactly as in deque.
+ *    Emptied slots go on a free list threaded through the slots
+ *    themselves. The table has room for maxBlocks entries, fixed when
+ *    the file is created, and the file grows as slots run out.
+ *
+ *    The elements are copied into the file as bytes, so T must be
+ *    trivially copyable and hold no pointers. Changes reach the file
+ *    when the kernel writes the pages back, which it may do at any
+ *    time and in any order; sync() waits until every page is written.
+ *    A file closed after sync() reopens as it was. A crash while the
+ *    deque is changing can leave the file with some pages old and
+ *    some new, and no attempt is made to recover from that.
+ *
+ *    Needs mmap, so not on Windows.
+ *
+ *    This will contain the class definition of:
+ *        mapped_deque : A deque in a memory-mapped file
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include "deque.h"       // for deque_block and DEQUE_POSIX
+
+#ifdef DEQUE_POSIX
+
+#include <cassert>       // for assert
+#include <cstddef>       // for size_t
+#include <cstdint>       // for uint64_t
+#include <cstring>       // for memcmp, memcpy
+#include <cerrno>        // for errno
+#include <type_traits>   // for std::is_trivially_copyable
+#include <stdexcept>     // for std::runtime_error, std::length_error
+#include <string>        // for std::string
+#include <system_error>  // for std::system_error
+#include <vector>        // for reordering the table
+#include <fcntl.h>       // for open
+#include <unistd.h>      // for ftruncate, close
+#include <sys/mman.h>    // for mmap, msync
+#include <sys/stat.h>    // for fstat
+
+class TestMappedDeque;    // forward declaration for TestMappedDeque unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * MAPPED DEQUE
+ * Open (or create) the file at path. A file made for
+ * another T or BS will not open.
+ *****************************************************/
+   template <typename T, size_t BS = deque_block<T>::numCells>
+   class mapped_deque
+   {
+      friend class ::TestMappedDeque; // give unit tests access to the privates
+      static_assert(std::is_trivially_copyable<T>::value, "elements are stored as bytes");
+      static_assert(isPowerOfTwo(BS), "block size must be a power of two");
+      static_assert(BS * sizeof(T) >= sizeof(uint64_t), "a free slot holds the next free slot");
+
+      // the start of the file
+      struct header
+      {
+         char magic[8];          // "CDEQUE1"
+         uint64_t cellBytes;     // sizeof(T)
+         uint64_t numCells;      // BS
+         uint64_t maxBlocks;     // entries in table
+         uint64_t numBlocks;     // map positions in use, a power of two
+         uint64_t iaFront;       // array-centered index of the front of the deque
+         uint64_t numElements;   // number of elements in the deque
+         uint64_t numSlots;      // slots the file has room for
+         uint64_t numSlotsUsed;  // slots ever handed out
+         uint64_t freeSlot;      // first free slot + 1, or 0
+         uint64_t table[1];      // slot + 1 for each map position, or 0
+      };
+
+      static constexpr size_t blockBytes = BS * sizeof(T);
+      static constexpr size_t pageBytes = 4096;
+
+   public:
+      explicit mapped_deque(const char* path, size_t maxBlocks = 4096);
+      mapped_deque(const mapped_deque&) = delete;
+      mapped_deque& operator = (const mapped_deque&) = delete;
+      ~mapped_deque();
+
+      //
+      // Access
+      //
+      T& front()                          { return *cellFromID(0);            }
+      const T& front() const              { return *cellFromID(0);            }
+      T& back()                           { return *cellFromID(size() - 1);   }
+      const T& back() const               { return *cellFromID(size() - 1);   }
+      T& operator [] (size_t id)             { return *cellFromID(id);        }
+      const T& operator [] (size_t id) const { return *cellFromID(id);        }
+
+      //
+      // Insert
+      //
+      void push_back(const T& t);
+      void push_front(const T& t);
+
+      //
+      // Remove
+      //
+      void pop_front();
+      void pop_back();
+      void clear();
+
+      //
+      // Status
+      //
+      size_t size()  const { return (size_t)pHeader->numElements; }
+      bool   empty() const { return size() == 0;                  }
+
+      //
+      // Persistence: wait until the file holds the deque as it is now
+      //
+      void sync();
+
+   private:
+      static constexpr int cellShift = log2PowerOfTwo(BS);
+
+      // bytes before the first slot
+      static size_t headerBytes(size_t maxBlocks)
+      {
+         size_t bytes = sizeof(header) + (maxBlocks - 1) * sizeof(uint64_t);
+         return (bytes + pageBytes - 1) & ~(pageBytes - 1);
+      }
+
+      // array index from deque index
+      size_t iaFromID(size_t id) const
+      {
+         return (size_t)(id + pHeader->iaFront) & (size_t)(pHeader->numBlocks * BS - 1);
+      }
+      size_t ibFromID(size_t id) const { return iaFromID(id) >> cellShift;  }
+      size_t icFromID(size_t id) const { return iaFromID(id) & (BS - 1);    }
+
+      // the block at slot + 1 of the table
+      T* blockFromSlot(uint64_t slot) const
+      {
+         assert(slot > 0 && slot <= pHeader->numSlotsUsed);
+         return (T*)(pBase + offsetSlots + (slot - 1) * blockBytes);
+      }
+      T* cellFromID(size_t id) const
+      {
+         return blockFromSlot(pHeader->table[ibFromID(id)]) + icFromID(id);
+      }
+
+      // how many map positions n elements take with the front at cell ic
+      static size_t blocksFor(size_t ic, size_t n)
+      {
+         return (ic + n + BS - 1) / BS;
+      }
+
+      uint64_t allocateSlot();
+      void releaseSlot(uint64_t slot);
+      void growMap();
+      void growFile(size_t numSlots);
+      void map(size_t bytes);
+
+      int fd;                // the open file
+      char* pBase;           // where the file is mapped
+      size_t bytesMapped;    // how much of it
+      size_t offsetSlots;    // where slot 0 starts
+      header* pHeader;       // the start of the file
+   };
+
+   /*****************************************
+    * MAPPED DEQUE :: CONSTRUCTOR
+    * Map an existing file and check it is ours,
+    * or lay out a new one. maxBlocks caps the map
+    * of a new file, rounded up to a power of two:
+    * the table is sized for it once, and a push that
+    * needs a bigger map throws std::length_error. A
+    * file that is reopened keeps its own cap and
+    * maxBlocks is ignored. A file whose header or
+    * table points outside it throws runtime_error
+    ****************************************/
+   template <typename T, size_t BS>
+   mapped_deque <T, BS> ::mapped_deque(const char* path, size_t maxBlocks)
+      : fd(-1), pBase(nullptr), bytesMapped(0), offsetSlots(0), pHeader(nullptr)
+   {
+      fd = ::open(path, O_RDWR | O_CREAT, 0644);
+      if (fd < 0)
+         throw std::system_error(errno, std::generic_category(), path);
+
+      struct stat st;
+      if (fstat(fd, &st) != 0)
+      {
+         int error = errno;
+         ::close(fd);
+         throw std::system_error(error, std::generic_category(), path);
+      }
+
+      try
+      {
+         if (st.st_size == 0)
+         {
+            // a new file: at least two map positions, a few slots
+            size_t numBlocksMax = 2;
+            while (numBlocksMax < maxBlocks)
+               numBlocksMax *= 2;
+            const size_t numSlots = 4;
+            offsetSlots = headerBytes(numBlocksMax);
+            if (ftruncate(fd, offsetSlots + numSlots * blockBytes) != 0)
+               throw std::system_error(errno, std::generic_category(), path);
+            map(offsetSlots + numSlots * blockBytes);
+            memcpy(pHeader->magic, "CDEQUE1", 8);
+            pHeader->cellBytes = sizeof(T);
+            pHeader->numCells = BS;
+            pHeader->maxBlocks = numBlocksMax;
+            pHeader->numBlocks = 2;
+            pHeader->numSlots = numSlots;
+         }
+         else
+         {
+            map((size_t)st.st_size);
+            if (bytesMapped < sizeof(header)
+                || memcmp(pHeader->magic, "CDEQUE1", 8) != 0
+                || pHeader->cellBytes != sizeof(T)
+                || pHeader->numCells != BS)
+               throw std::runtime_error(std::string(path) + ": not a mapped_deque of this type");
+
+            // a short file would fault on the first touch of a missing page
+            if (pHeader->maxBlocks == 0 || pHeader->maxBlocks > bytesMapped / sizeof(uint64_t))
+               throw std::runtime_error(std::string(path) + ": truncated mapped_deque");
+            offsetSlots = headerBytes((size_t)pHeader->maxBlocks);
+            if (offsetSlots > bytesMapped
+                || pHeader->numSlots > (bytesMapped - offsetSlots) / blockBytes
+                || pHeader->numSlotsUsed > pHeader->numSlots
+                || pHeader->numBlocks > pHeader->maxBlocks)
+               throw std::runtime_error(std::string(path) + ": truncated mapped_deque");
+
+            // the map must translate ids the way we do, and every slot it
+            // or the free list names must be one the file has
+            uint64_t numBlocks = pHeader->numBlocks;
+            if (numBlocks == 0 || (numBlocks & (numBlocks - 1)) != 0
+                || pHeader->iaFront >= numBlocks * BS
+                || pHeader->numElements > numBlocks * BS
+                || pHeader->freeSlot > pHeader->numSlotsUsed)
+               throw std::runtime_error(std::string(path) + ": corrupt mapped_deque");
+            for (size_t ib = 0; ib < numBlocks; ib++)
+               if (pHeader->table[ib] > pHeader->numSlotsUsed)
+                  throw std::runtime_error(std::string(path) + ": corrupt mapped_deque");
+         }
+      }
+      catch (...)
+      {
+         if (pBase)
+            munmap(pBase, bytesMapped);
+         ::close(fd);
+         throw;
+      }
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: DESTRUCTOR
+    * Unmap without waiting: the kernel still writes
+    * the pages back. Call sync() first to wait
+    ****************************************/
+   template <typename T, size_t BS>
+   mapped_deque <T, BS> ::~mapped_deque()
+   {
+      if (pBase)
+         munmap(pBase, bytesMapped);
+      ::close(fd);
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: PUSH BACK
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::push_back(const T& t)
+   {
+      size_t n = size();
+      if (blocksFor(icFromID(0), n + 1) > pHeader->numBlocks)
+         growMap();
+
+      size_t ib = ibFromID(n);
+      if (pHeader->table[ib] == 0)
+      {
+         uint64_t slot = allocateSlot();
+         pHeader->table[ib] = slot;
+      }
+      memcpy((void*)cellFromID(n), &t, sizeof(T));
+      pHeader->numElements = n + 1;
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: PUSH FRONT
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::push_front(const T& t)
+   {
+      size_t n = size();
+      if (blocksFor((icFromID(0) + BS - 1) & (BS - 1), n + 1) > pHeader->numBlocks)
+         growMap();
+
+      uint64_t numArray = pHeader->numBlocks * BS;
+      pHeader->iaFront = (pHeader->iaFront + numArray - 1) & (numArray - 1);
+      size_t ib = ibFromID(0);
+      if (pHeader->table[ib] == 0)
+      {
+         uint64_t slot = allocateSlot();
+         pHeader->table[ib] = slot;
+      }
+      memcpy((void*)cellFromID(0), &t, sizeof(T));
+      pHeader->numElements = n + 1;
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: POP FRONT
+    * Free the front block once its last element goes
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::pop_front()
+   {
+      size_t n = size();
+      if (n == 0)
+         return;
+
+      size_t ib = ibFromID(0);
+      if (n == 1 || icFromID(0) == BS - 1)
+      {
+         releaseSlot(pHeader->table[ib]);
+         pHeader->table[ib] = 0;
+      }
+      uint64_t numArray = pHeader->numBlocks * BS;
+      pHeader->iaFront = (pHeader->iaFront + 1) & (numArray - 1);
+      pHeader->numElements = n - 1;
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: POP BACK
+    * Free the back block once its last element goes
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::pop_back()
+   {
+      size_t n = size();
+      if (n == 0)
+         return;
+
+      size_t ib = ibFromID(n - 1);
+      if (n == 1 || icFromID(n - 1) == 0)
+      {
+         releaseSlot(pHeader->table[ib]);
+         pHeader->table[ib] = 0;
+      }
+      pHeader->numElements = n - 1;
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: CLEAR
+    * Every slot goes back on the free list. The
+    * file does not shrink
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::clear()
+   {
+      for (size_t ib = 0; ib < pHeader->numBlocks; ib++)
+         if (pHeader->table[ib])
+         {
+            releaseSlot(pHeader->table[ib]);
+            pHeader->table[ib] = 0;
+         }
+      pHeader->numElements = 0;
+      pHeader->iaFront = 0;
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: SYNC
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::sync()
+   {
+      if (msync(pBase, bytesMapped, MS_SYNC) != 0)
+         throw std::system_error(errno, std::generic_category(), "msync");
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: ALLOCATE SLOT
+    * A slot off the free list, or the next unused
+    * one, doubling the file when there is none.
+    * Returns slot + 1, as the table holds it
+    ****************************************/
+   template <typename T, size_t BS>
+   uint64_t mapped_deque <T, BS> ::allocateSlot()
+   {
+      uint64_t slot = pHeader->freeSlot;
+      if (slot)
+      {
+         memcpy(&pHeader->freeSlot, blockFromSlot(slot), sizeof(uint64_t));
+         return slot;
+      }
+
+      if (pHeader->numSlotsUsed == pHeader->numSlots)
+         growFile((size_t)pHeader->numSlots * 2);
+      return ++pHeader->numSlotsUsed;
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: RELEASE SLOT
+    * Push slot + 1 on the free list
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::releaseSlot(uint64_t slot)
+   {
+      memcpy(blockFromSlot(slot), &pHeader->freeSlot, sizeof(uint64_t));
+      pHeader->freeSlot = slot;
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: GROW MAP
+    * Double the map positions in use, laying the
+    * blocks out from position 0 in deque order as
+    * deque::reallocate does. Only slot numbers move.
+    * The table is rewritten in place, so like every
+    * other change this is not atomic in the file
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::growMap()
+   {
+      size_t numBlocksNew = (size_t)pHeader->numBlocks * 2;
+      if (numBlocksNew > pHeader->maxBlocks)
+         throw std::length_error("mapped_deque: map is full");
+
+      // the blocks holding elements, front to back
+      std::vector<uint64_t> slots;
+      size_t ic = icFromID(0);
+      size_t ibFront = ibFromID(0);
+      size_t numUsed = blocksFor(ic, size());
+      for (size_t i = 0; i < numUsed; i++)
+         slots.push_back(pHeader->table[(ibFront + i) & (pHeader->numBlocks - 1)]);
+
+      for (size_t ib = 0; ib < numBlocksNew; ib++)
+         pHeader->table[ib] = ib < slots.size() ? slots[ib] : 0;
+      pHeader->numBlocks = numBlocksNew;
+      pHeader->iaFront = ic;
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: GROW FILE
+    * Make room for numSlots and map it again. The
+    * table holds slot numbers, so nothing inside
+    * the file needs fixing up
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::growFile(size_t numSlots)
+   {
+      size_t bytes = offsetSlots + numSlots * blockBytes;
+      if (ftruncate(fd, bytes) != 0)
+         throw std::system_error(errno, std::generic_category(), "ftruncate");
+      munmap(pBase, bytesMapped);
+      pBase = nullptr;
+      map(bytes);
+      pHeader->numSlots = numSlots;
+   }
+
+   /*****************************************
+    * MAPPED DEQUE :: MAP
+    * Map the first bytes of the file, shared so
+    * our stores go to the file
+    ****************************************/
+   template <typename T, size_t BS>
+   void mapped_deque <T, BS> ::map(size_t bytes)
+   {
+      void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (p == MAP_FAILED)
+         throw std::system_error(errno, std::generic_category(), "mmap");
+      pBase = (char*)p;
+      bytesMapped = bytes;
+      pHeader = (header*)pBase;
+   }
+
+} // namespace custom
+
+#endif // DEQUE_POSIX
@@ -0,0 +1,321 @@
+/***********************************************************************
+ * Header:
+ *    RING DEQUE
+ * Summary:
+ *    A deque of fixed capacity that keeps the newest elements: once it
+ *    is full, push_back overwrites the oldest element where it stands
+ *    and the front moves up one. Every block is allocated when the
+ *    deque is built, so a sliding window of the last N samples never
+ *    allocates, frees or reshuffles the map.
+ *
+ *    The blocks are the deque's, BS cells each, but the ring is
+ *    exactly capacity cells long, so the last block may be partly
+ *    unused. Translating an index is then one add and one compare
+ *    rather than a modulo.
+ *
+ *    This will contain the class definition of:
+ *        ring_deque : A fixed-capacity deque that overwrites its oldest
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>     // for assert
+#include <memory>      // for std::allocator_traits
+#include <cstddef>     // for size_t
+#include <utility>     // for std::move, std::swap
+#include "deque.h"     // for deque_block
+
+class TestRingDeque;    // forward declaration for TestRingDeque unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * RING DEQUE
+ * A deque of at most capacity elements. push_back and
+ * emplace_back on a full deque replace the front.
+ *****************************************************/
+   template <typename T, typename A = std::allocator<T>,
+             size_t BS = deque_block<T>::numCells>
+   class ring_deque
+   {
+      friend class ::TestRingDeque; // give unit tests access to the privates
+      static_assert(isPowerOfTwo(BS), "block size must be a power of two");
+
+      typedef std::allocator_traits<A>                                   alloc_traits;
+      typedef typename alloc_traits::template rebind_alloc<T*>           map_allocator;
+      typedef std::allocator_traits<map_allocator>                       map_traits;
+
+   public:
+      typedef A allocator_type;
+
+      explicit ring_deque(size_t capacity, const A& a = A());
+      ring_deque(ring_deque&& rhs) noexcept
+         : alloc(rhs.alloc), numCapacity(0), numBlocks(0), numElements(0), iaFront(0), data(nullptr)
+      {
+         swap(rhs);
+      }
+      ring_deque(const ring_deque&) = delete;
+      ring_deque& operator = (const ring_deque&) = delete;
+      ring_deque& operator = (ring_deque&& rhs)
+         noexcept(alloc_traits::propagate_on_container_move_assignment::value
+                  || alloc_traits::is_always_equal::value);
+      ~ring_deque() { release(); }
+
+      // the allocators only trade places if they follow the elements
+      void swap(ring_deque& rhs) noexcept
+      {
+         if constexpr (alloc_traits::propagate_on_container_swap::value)
+         {
+            using std::swap;
+            swap(alloc, rhs.alloc);
+         }
+         swapStorage(rhs);
+      }
+
+      //
+      // Access
+      //
+      T& front()                          { return *cellFromID(0);               }
+      const T& front() const              { return *cellFromID(0);               }
+      T& back()                           { return *cellFromID(numElements - 1); }
+      const T& back() const               { return *cellFromID(numElements - 1); }
+      T& operator [] (size_t id)             { return *cellFromID(id);           }
+      const T& operator [] (size_t id) const { return *cellFromID(id);           }
+
+      //
+      // Insert: on a full deque these replace the front
+      //
+      void push_back(const T& t);
+      void push_back(T&& t);
+      template <typename ... Args>
+      T& emplace_back(Args&& ... args);
+
+      //
+      // Remove
+      //
+      void pop_front();
+      void pop_back();
+      void clear();
+
+      //
+      // Status
+      //
+      size_t size()     const { return numElements;                }
+      bool   empty()    const { return numElements == 0;           }
+      bool   full()     const { return numElements == numCapacity; }
+      size_t capacity() const { return numCapacity;                }
+
+   private:
+      static constexpr int cellShift = log2PowerOfTwo(BS);
+
+      // array index from deque index: the ring is numCapacity cells long
+      size_t iaFromID(size_t id) const
+      {
+         assert(id < numCapacity);
+         size_t ia = iaFront + id;
+         if (ia >= numCapacity)
+            ia -= numCapacity;
+         return ia;
+      }
+
+      // the cell holding deque index id
+      T* cellFromID(size_t id) const
+      {
+         size_t ia = iaFromID(id);
+         return data[ia >> cellShift] + (ia & (BS - 1));
+      }
+
+      // the front moves up one, around the ring
+      void advanceFront()
+      {
+         if (++iaFront == numCapacity)
+            iaFront = 0;
+      }
+
+      // destroy the elements and give every block and the map back
+      void release();
+
+      // hand our ring to rhs and take its, keeping the allocators
+      void swapStorage(ring_deque& rhs) noexcept
+      {
+         std::swap(numCapacity, rhs.numCapacity);
+         std::swap(numBlocks,   rhs.numBlocks);
+         std::swap(numElements, rhs.numElements);
+         std::swap(iaFront,     rhs.iaFront);
+         std::swap(data,        rhs.data);
+      }
+
+      A alloc;               // for the blocks and the elements
+      size_t numCapacity;    // number of cells in the ring
+      size_t numBlocks;      // number of blocks in the data array
+      size_t numElements;    // number of elements in the deque
+      size_t iaFront;        // array-centered index of the front of the deque
+      T** data;              // array of arrays
+   };
+
+   /*****************************************
+    * RING DEQUE :: CONSTRUCTOR
+    * Allocate the map and every block up front
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   ring_deque <T, A, BS> ::ring_deque(size_t capacity, const A& a)
+      : alloc(a), numCapacity(capacity), numBlocks((capacity + BS - 1) / BS),
+        numElements(0), iaFront(0), data(nullptr)
+   {
+      assert(capacity > 0);
+      map_allocator mapAlloc(alloc);
+      data = map_traits::allocate(mapAlloc, numBlocks);
+      for (size_t ib = 0; ib < numBlocks; ib++)
+         data[ib] = alloc_traits::allocate(alloc, BS);
+   }
+
+   /*****************************************
+    * RING DEQUE :: RELEASE
+    * Destroy the elements, then free the blocks and
+    * the map. The ring is left with no capacity
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void ring_deque <T, A, BS> ::release()
+   {
+      if (!data)
+         return;
+      clear();
+      for (size_t ib = 0; ib < numBlocks; ib++)
+         alloc_traits::deallocate(alloc, data[ib], BS);
+      map_allocator mapAlloc(alloc);
+      map_traits::deallocate(mapAlloc, data, numBlocks);
+      data = nullptr;
+      numCapacity = numBlocks = 0;
+   }
+
+   /*****************************************
+    * RING DEQUE :: MOVE-ASSIGN
+    * Free our ring and take rhs's. An allocator that
+    * does not follow the elements and is not equal to
+    * rhs's cannot free rhs's blocks, so then a ring of
+    * rhs's capacity is built with ours and the elements
+    * are moved over one at a time
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   ring_deque <T, A, BS>& ring_deque <T, A, BS> :: operator = (ring_deque&& rhs)
+      noexcept(alloc_traits::propagate_on_container_move_assignment::value
+               || alloc_traits::is_always_equal::value)
+   {
+      if (this == &rhs)
+         return *this;
+
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+      {
+         release();
+         alloc = std::move(rhs.alloc);
+         swapStorage(rhs);
+      }
+      else
+      {
+         if (alloc == rhs.alloc)
+         {
+            release();
+            swapStorage(rhs);
+         }
+         else
+         {
+            ring_deque ring(rhs.numCapacity, alloc);
+            for (size_t id = 0; id < rhs.numElements; id++)
+               ring.push_back(std::move(rhs[id]));
+            rhs.clear();
+            release();
+            swapStorage(ring);
+         }
+      }
+      return *this;
+   }
+
+   /*****************************************
+    * RING DEQUE :: PUSH BACK
+    * When full, assign over the front and make
+    * it the back
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void ring_deque <T, A, BS> ::push_back(const T& t)
+   {
+      if (numElements == numCapacity)
+      {
+         *cellFromID(0) = t;
+         advanceFront();
+      }
+      else
+         alloc_traits::construct(alloc, cellFromID(numElements++), t);
+   }
+
+   template <typename T, typename A, size_t BS>
+   void ring_deque <T, A, BS> ::push_back(T&& t)
+   {
+      if (numElements == numCapacity)
+      {
+         *cellFromID(0) = std::move(t);
+         advanceFront();
+      }
+      else
+         alloc_traits::construct(alloc, cellFromID(numElements++), std::move(t));
+   }
+
+   /*****************************************
+    * RING DEQUE :: EMPLACE BACK
+    * When full, the front is popped first and the
+    * new element built in the cell it left. The
+    * element only counts once it is built, so a
+    * throwing constructor leaves one fewer
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename ... Args>
+   T& ring_deque <T, A, BS> ::emplace_back(Args&& ... args)
+   {
+      if (numElements == numCapacity)
+         pop_front();
+      T* p = cellFromID(numElements);
+      alloc_traits::construct(alloc, p, std::forward<Args>(args)...);
+      numElements++;
+      return *p;
+   }
+
+   /*****************************************
+    * RING DEQUE :: POP FRONT
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void ring_deque <T, A, BS> ::pop_front()
+   {
+      if (numElements == 0)
+         return;
+      alloc_traits::destroy(alloc, cellFromID(0));
+      advanceFront();
+      numElements--;
+   }
+
+   /*****************************************
+    * RING DEQUE :: POP BACK
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void ring_deque <T, A, BS> ::pop_back()
+   {
+      if (numElements == 0)
+         return;
+      alloc_traits::destroy(alloc, cellFromID(--numElements));
+   }
+
+   /*****************************************
+    * RING DEQUE :: CLEAR
+    * Destroy the elements. The blocks stay
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void ring_deque <T, A, BS> ::clear()
+   {
+      for (size_t id = 0; id < numElements; id++)
+         alloc_traits::destroy(alloc, cellFromID(id));
+      numElements = 0;
+      iaFront = 0;
+   }
+
+} // namespace custom
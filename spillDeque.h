@@ -0,0 +1,493 @@
+/***********************************************************************
+ * Header:
+ *    SPILL DEQUE
+ * Summary:
+ *    A queue that keeps at most a budget of blocks in memory and
+ *    writes the rest to a spill file. Elements are pushed on the back
+ *    and popped off the front, so the blocks between are the ones
+ *    nobody needs soon. When a new back block would go over the
+ *    budget, the newest full block that is neither the back nor
+ *    about to be popped is written out whole and its memory reused.
+ *
+ *    As pop_front moves into a block, an I/O thread starts reading
+ *    the next few spilled blocks back, so by the time pop_front gets
+ *    to them they are usually already in memory. If not, it waits.
+ *    A block that cannot be read makes front() or pop_front() throw
+ *    std::system_error and stays spilled, so once the error clears
+ *    the next call reads it back.
+ *
+ *    A full block never changes again, so one read back still has its
+ *    copy in the file, and spilling it a second time costs no write.
+ *
+ *    The blocks are the deque's, BS cells each, held in a
+ *    custom::deque of block descriptors. Spilling copies the cells
+ *    as bytes, so T must be trivially copyable. The queue belongs to
+ *    one thread; the I/O thread is its own.
+ *
+ *    Needs pread and pwrite, so not on Windows.
+ *
+ *    This will contain the class definition of:
+ *        spill_deque : A queue that spills its middle to disk
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include "deque.h"             // for deque, deque_block and DEQUE_POSIX
+
+#ifdef DEQUE_POSIX
+
+#include <cassert>             // for assert
+#include <cstddef>             // for size_t
+#include <cstdint>             // for uint64_t
+#include <cstdio>              // for std::tmpfile
+#include <cerrno>              // for errno, EIO
+#include <atomic>              // for std::atomic
+#include <mutex>               // for std::mutex
+#include <condition_variable>  // for std::condition_variable
+#include <thread>              // for std::thread
+#include <vector>              // for the free slots and spare buffers
+#include <type_traits>         // for std::is_trivially_copyable
+#include <system_error>        // for std::system_error
+#include <fcntl.h>             // for open
+#include <unistd.h>            // for pread, pwrite, close, unlink
+
+class TestSpillDeque;    // forward declaration for TestSpillDeque unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * SPILL DEQUE
+ * push_back and pop_front. budgetBytes of blocks stay
+ * in memory (never fewer than the back, the front and
+ * numPrefetch after it), the rest go to the spill file:
+ * a file at path, removed at once, or a tmpfile.
+ *****************************************************/
+   template <typename T, typename A = std::allocator<T>,
+             size_t BS = deque_block<T>::numCells>
+   class spill_deque
+   {
+      friend class ::TestSpillDeque; // give unit tests access to the privates
+      static_assert(std::is_trivially_copyable<T>::value, "blocks are spilled as bytes");
+      static_assert(isPowerOfTwo(BS), "block size must be a power of two");
+
+      typedef std::allocator_traits<A> alloc_traits;
+
+      enum { RESIDENT, SPILLED, LOADING, FAILED };
+
+      // one block of the queue, in memory, in the file, or both
+      struct block
+      {
+         T* p;                     // the cells, or nullptr when spilled
+         uint64_t slot;            // slot + 1 in the spill file, or 0
+         std::atomic<int> state;   // RESIDENT, SPILLED, LOADING or FAILED
+         block() : p(nullptr), slot(0), state(RESIDENT) {}
+      };
+
+      static constexpr size_t blockBytes = BS * sizeof(T);
+
+   public:
+      explicit spill_deque(size_t budgetBytes, size_t numPrefetch = 2,
+                           const char* path = nullptr, const A& a = A());
+      spill_deque(const spill_deque&) = delete;
+      spill_deque& operator = (const spill_deque&) = delete;
+      ~spill_deque();
+
+      //
+      // Access
+      //
+      T& front();
+      T& back() { return blocks.back()->p[icFromID(numElements - 1)]; }
+
+      //
+      // Insert and remove
+      //
+      void push_back(const T& t);
+      void pop_front();
+
+      //
+      // Status
+      //
+      size_t size()  const { return numElements;      }
+      bool   empty() const { return numElements == 0; }
+      size_t numBlocksResident() const { return numResident;                  }
+      size_t numBlocksSpilled()  const { return blocks.size() - numResident;  }
+
+   private:
+      // cell index from deque index
+      size_t icFromID(size_t id) const { return (icFront + id) & (BS - 1); }
+
+      T* allocateBuffer();
+      void releaseBuffer(T* p);
+      void fitBudget();
+      void spill(block* b);
+      void prefetch();
+      void waitResident(block* b);
+      void ioThread();
+
+      A alloc;
+      deque<block*> blocks;          // front to back
+      size_t icFront;                // cell of the front in blocks.front()
+      size_t numElements;            // number of elements in the queue
+      size_t numResident;            // blocks with memory: resident or loading
+      size_t maxResident;            // the budget, in blocks
+      size_t numPrefetch;            // blocks after the front to read ahead
+      std::vector<T*> spare;         // buffers of spilled blocks, for reuse
+      int fd;                        // the spill file
+      uint64_t numSlots;             // slots the file has held
+      std::vector<uint64_t> freeSlots; // slot + 1 of each reusable slot
+
+      // shared with the I/O thread
+      std::mutex mutex;              // guards loads, stop and the states' changes
+      std::condition_variable cvLoad;   // a load was queued, or stop
+      std::condition_variable cvDone;   // a load finished
+      std::vector<block*> loads;     // blocks to read back
+      bool stop;
+      std::thread thread;            // started with the first load
+   };
+
+   /*****************************************
+    * SPILL DEQUE :: CONSTRUCTOR
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   spill_deque <T, A, BS> ::spill_deque(size_t budgetBytes, size_t numPrefetch,
+                                        const char* path, const A& a)
+      : alloc(a), icFront(0), numElements(0), numResident(0),
+        maxResident(budgetBytes / blockBytes), numPrefetch(numPrefetch),
+        fd(-1), numSlots(0), stop(false)
+   {
+      // the back, the front and the ones read ahead can never be spilled
+      if (maxResident < numPrefetch + 2)
+         maxResident = numPrefetch + 2;
+
+      // so releaseBuffer() never allocates
+      spare.reserve(2);
+
+      if (path)
+      {
+         fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+         if (fd >= 0)
+            ::unlink(path);
+      }
+      else if (FILE* file = std::tmpfile())
+      {
+         fd = ::dup(fileno(file));
+         std::fclose(file);
+      }
+      if (fd < 0)
+         throw std::system_error(errno, std::generic_category(), "spill file");
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: DESTRUCTOR
+    * Stop the I/O thread once its loads are done,
+    * then free everything
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   spill_deque <T, A, BS> ::~spill_deque()
+   {
+      if (thread.joinable())
+      {
+         {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+         }
+         cvLoad.notify_one();
+         thread.join();
+      }
+      while (!blocks.empty())
+      {
+         block* b = blocks.front();
+         if (b->p)
+            alloc_traits::deallocate(alloc, b->p, BS);
+         delete b;
+         blocks.pop_front();
+      }
+      for (T* p : spare)
+         alloc_traits::deallocate(alloc, p, BS);
+      ::close(fd);
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: FRONT
+    * Wait for the front block if it is still
+    * coming back from the file
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   T& spill_deque <T, A, BS> ::front()
+   {
+      block* b = blocks.front();
+      waitResident(b);
+      return b->p[icFront];
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: PUSH BACK
+    * Start a new back block when the old one is
+    * full, spilling a middle block if that puts
+    * us over the budget. If that fails the new
+    * block is taken back out, so a throw leaves
+    * the queue as it was
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void spill_deque <T, A, BS> ::push_back(const T& t)
+   {
+      size_t ic = icFromID(numElements);
+      if (numElements == 0 || ic == 0)
+      {
+         block* b = new block;
+         bool pushed = false;
+         try
+         {
+            b->p = allocateBuffer();
+            blocks.push_back(b);
+            pushed = true;
+            numResident++;
+            fitBudget();
+         }
+         catch (...)
+         {
+            if (pushed)
+            {
+               blocks.pop_back();
+               numResident--;
+            }
+            if (b->p)
+               releaseBuffer(b->p);
+            delete b;
+            throw;
+         }
+      }
+      blocks.back()->p[ic] = t;
+      numElements++;
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: POP FRONT
+    * Leaving a block frees it and its slot, and
+    * starts reading ahead of the new front
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void spill_deque <T, A, BS> ::pop_front()
+   {
+      if (numElements == 0)
+         return;
+
+      block* b = blocks.front();
+      waitResident(b);
+      numElements--;
+      if (++icFront == BS || numElements == 0)
+      {
+         releaseBuffer(b->p);
+         if (b->slot)
+            freeSlots.push_back(b->slot);
+         delete b;
+         blocks.pop_front();
+         numResident--;
+         icFront = 0;
+         prefetch();
+      }
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: ALLOCATE BUFFER
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   T* spill_deque <T, A, BS> ::allocateBuffer()
+   {
+      if (!spare.empty())
+      {
+         T* p = spare.back();
+         spare.pop_back();
+         return p;
+      }
+      return alloc_traits::allocate(alloc, BS);
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: RELEASE BUFFER
+    * Keep a couple for the next block; the
+    * budget only counts blocks in use
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void spill_deque <T, A, BS> ::releaseBuffer(T* p)
+   {
+      if (spare.size() < 2)
+         spare.push_back(p);
+      else
+         alloc_traits::deallocate(alloc, p, BS);
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: FIT BUDGET
+    * Spill the newest resident blocks behind the
+    * read-ahead window, never the back, until we
+    * are back in budget
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void spill_deque <T, A, BS> ::fitBudget()
+   {
+      if (numResident <= maxResident)
+         return;
+
+      int idFirst = (int)numPrefetch + 1;      // after the front and the window
+      for (int id = (int)blocks.size() - 2; id >= idFirst && numResident > maxResident; id--)
+         if (blocks[id]->state.load(std::memory_order_acquire) == RESIDENT)
+            spill(blocks[id]);
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: SPILL
+    * Write a full block to its slot, unless the
+    * file already has it, and give up its memory.
+    * The block only takes the slot once the whole
+    * block is written; a failed write leaves it
+    * resident and the slot free
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void spill_deque <T, A, BS> ::spill(block* b)
+   {
+      if (!b->slot)
+      {
+         bool reuse = !freeSlots.empty();
+         uint64_t slot = reuse ? freeSlots.back() : numSlots + 1;
+
+         const char* p = (const char*)b->p;
+         off_t offset = (off_t)((slot - 1) * blockBytes);
+         for (size_t done = 0; done < blockBytes; )
+         {
+            ssize_t n = ::pwrite(fd, p + done, blockBytes - done, offset + done);
+            if (n > 0)
+               done += n;
+            else if (n == 0)
+               throw std::system_error(EIO, std::generic_category(), "pwrite wrote nothing");
+            else if (errno != EINTR)
+               throw std::system_error(errno, std::generic_category(), "pwrite");
+         }
+
+         if (reuse)
+            freeSlots.pop_back();
+         else
+            numSlots++;
+         b->slot = slot;
+      }
+
+      releaseBuffer(b->p);
+      b->p = nullptr;
+      b->state.store(SPILLED, std::memory_order_relaxed);
+      numResident--;
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: PREFETCH
+    * Queue the spilled blocks of the read-ahead
+    * window, and the front itself, for the I/O
+    * thread. Each gets its memory now
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void spill_deque <T, A, BS> ::prefetch()
+   {
+      bool queued = false;
+      size_t idLast = std::min(numPrefetch + 1, blocks.size());
+      for (size_t id = 0; id < idLast; id++)
+      {
+         block* b = blocks[(int)id];
+         if (b->state.load(std::memory_order_relaxed) != SPILLED)
+            continue;
+
+         b->p = allocateBuffer();
+         numResident++;
+         {
+            std::lock_guard<std::mutex> lock(mutex);
+            b->state.store(LOADING, std::memory_order_relaxed);
+            loads.push_back(b);
+         }
+         queued = true;
+      }
+
+      if (queued)
+      {
+         if (!thread.joinable())
+            thread = std::thread(&spill_deque::ioThread, this);
+         cvLoad.notify_one();
+         fitBudget();
+      }
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: WAIT RESIDENT
+    * Block until b is in memory. A block that
+    * failed while it was read ahead is read once
+    * more. If a read we wait on fails, b is spilled
+    * again and we throw, so the next wait retries
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void spill_deque <T, A, BS> ::waitResident(block* b)
+   {
+      for (bool waited = false; ; waited = true)
+      {
+         int state = b->state.load(std::memory_order_acquire);
+         if (state == RESIDENT)
+            return;
+
+         if (state == FAILED)
+         {
+            {
+               std::lock_guard<std::mutex> lock(mutex);
+               b->state.store(SPILLED, std::memory_order_relaxed);
+            }
+            releaseBuffer(b->p);
+            b->p = nullptr;
+            numResident--;
+            if (waited)
+               throw std::system_error(EIO, std::generic_category(), "spill_deque: reading a block back");
+            state = SPILLED;
+         }
+
+         if (state == SPILLED)
+            prefetch();   // the front is always in the window
+         std::unique_lock<std::mutex> lock(mutex);
+         cvDone.wait(lock, [b] { return b->state.load(std::memory_order_acquire) != LOADING; });
+      }
+   }
+
+   /*****************************************
+    * SPILL DEQUE :: IO THREAD
+    * Read queued blocks back, oldest first
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void spill_deque <T, A, BS> ::ioThread()
+   {
+      std::unique_lock<std::mutex> lock(mutex);
+      for (;;)
+      {
+         cvLoad.wait(lock, [this] { return stop || !loads.empty(); });
+         if (loads.empty())
+            return;
+         block* b = loads.front();
+         loads.erase(loads.begin());
+         lock.unlock();
+
+         char* p = (char*)b->p;
+         off_t offset = (off_t)((b->slot - 1) * blockBytes);
+         bool failed = false;
+         for (size_t done = 0; done < blockBytes && !failed; )
+         {
+            ssize_t n = ::pread(fd, p + done, blockBytes - done, offset + done);
+            if (n > 0)
+               done += n;
+            else if (n == 0 || errno != EINTR)
+               failed = true;
+         }
+
+         lock.lock();
+         b->state.store(failed ? FAILED : RESIDENT, std::memory_order_release);
+         cvDone.notify_all();
+      }
+   }
+
+} // namespace custom
+
+#endif // DEQUE_POSIX
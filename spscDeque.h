@@ -0,0 +1,215 @@
+/***********************************************************************
+ * Header:
+ *    SPSC DEQUE
+ * Summary:
+ *    A deque for exactly one producer thread pushing on the back and
+ *    one consumer thread popping off the front, with no lock. Like
+ *    custom::deque it keeps its elements in fixed-size blocks, but
+ *    the blocks are chained front to back rather than hung off a map:
+ *    the producer links a new block on when the back one fills, and
+ *    the consumer hands each block it empties back to the producer.
+ *    Nothing is ever reallocated, so neither side waits on the other.
+ *
+ *    The front and back ids are the only shared state. The producer
+ *    publishes an element by storing the new back id with release;
+ *    the consumer frees a cell by storing the new front id the same way.
+ *
+ *    This will contain the class definition of:
+ *        spsc_deque : A single-producer, single-consumer deque
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>      // for std::atomic
+#include <memory>      // for std::allocator_traits
+#include <cstddef>     // for size_t
+#include <utility>     // for std::move
+#include "deque.h"     // for deque_block
+
+class TestSpscDeque;    // forward declaration for TestSpscDeque unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * SPSC DEQUE
+ * push_back and emplace_back from the producer thread
+ * only, pop_front from the consumer thread only. Either
+ * thread may ask empty() or size(), which are a snapshot.
+ *****************************************************/
+   template <typename T, typename A = std::allocator<T>,
+             size_t BS = deque_block<T>::numCells>
+   class spsc_deque
+   {
+      friend class ::TestSpscDeque; // give unit tests access to the privates
+      static_assert(isPowerOfTwo(BS), "block size must be a power of two");
+
+      // a block of cells and the next block toward the back
+      struct block
+      {
+         block* next;
+         alignas(T) unsigned char cells[BS * sizeof(T)];
+         T* cell(size_t ic) { return (T*)cells + ic; }
+      };
+      typedef typename std::allocator_traits<A>::template rebind_alloc<block> block_allocator;
+      typedef std::allocator_traits<block_allocator>                        block_traits;
+
+      static constexpr size_t cacheLine = 64;
+
+   public:
+      spsc_deque(const A& a = A())
+         : alloc(a), pFront(nullptr), idFront(0), pBack(nullptr), idBack(0), spare(nullptr)
+      {
+         pFront = pBack = newBlock();
+      }
+      spsc_deque(const spsc_deque&) = delete;
+      spsc_deque& operator = (const spsc_deque&) = delete;
+      ~spsc_deque();
+
+      //
+      // Producer
+      //
+      void push_back(const T& t) { emplace_back(t);            }
+      void push_back(T&& t)      { emplace_back(std::move(t)); }
+      template <typename ... Args>
+      void emplace_back(Args&& ... args);
+
+      //
+      // Consumer
+      //
+      bool pop_front(T& t);
+
+      //
+      // Status
+      //
+      size_t size() const
+      {
+         size_t idFrontNow = idFront.load(std::memory_order_acquire);
+         return idBack.load(std::memory_order_acquire) - idFrontNow;
+      }
+      bool empty() const { return size() == 0; }
+
+   private:
+      block* newBlock();
+      void deleteBlock(block* p);
+
+      // shared between the threads
+      block_allocator alloc;
+
+      // the consumer's side
+      alignas(cacheLine) block* pFront;      // block holding the front
+      std::atomic<size_t> idFront;           // next id to pop
+
+      // the producer's side
+      alignas(cacheLine) block* pBack;       // block holding the back
+      std::atomic<size_t> idBack;            // next id to push
+
+      // a block the consumer emptied, for the producer to reuse
+      alignas(cacheLine) std::atomic<block*> spare;
+   };
+
+   /*****************************************
+    * SPSC DEQUE :: DESTRUCTOR
+    * Destroy what was never popped, then free
+    * the chain and the spare
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   spsc_deque <T, A, BS> ::~spsc_deque()
+   {
+      size_t idLast = idBack.load(std::memory_order_relaxed);
+      for (size_t id = idFront.load(std::memory_order_relaxed); id != idLast; id++)
+      {
+         // pop_front only steps into the next block when it gets there
+         if (id % BS == 0 && id != 0)
+         {
+            block* pNext = pFront->next;
+            deleteBlock(pFront);
+            pFront = pNext;
+         }
+         pFront->cell(id % BS)->~T();
+      }
+      deleteBlock(pFront);
+      if (block* p = spare.load(std::memory_order_relaxed))
+         deleteBlock(p);
+   }
+
+   /*****************************************
+    * SPSC DEQUE :: EMPLACE BACK
+    * Producer only. Construct the element, then
+    * publish it. When the back block fills, link on
+    * the spare the consumer handed back, or a new one
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   template <typename ... Args>
+   void spsc_deque <T, A, BS> ::emplace_back(Args&& ... args)
+   {
+      size_t id = idBack.load(std::memory_order_relaxed);
+      size_t ic = id % BS;
+      if (ic == 0 && id != 0)
+      {
+         block* p = spare.exchange(nullptr, std::memory_order_acquire);
+         if (!p)
+            p = newBlock();
+         p->next = nullptr;
+         pBack->next = p;
+         pBack = p;
+      }
+
+      new ((void*)pBack->cell(ic)) T(std::forward<Args>(args)...);
+      idBack.store(id + 1, std::memory_order_release);
+   }
+
+   /*****************************************
+    * SPSC DEQUE :: POP FRONT
+    * Consumer only. Move the front into t and
+    * return true, or return false if it is empty.
+    * Stepping into the next block hands the
+    * emptied one back to the producer
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   bool spsc_deque <T, A, BS> ::pop_front(T& t)
+   {
+      size_t id = idFront.load(std::memory_order_relaxed);
+      if (id == idBack.load(std::memory_order_acquire))
+         return false;
+
+      size_t ic = id % BS;
+      if (ic == 0 && id != 0)
+      {
+         // the producer linked the next block before publishing id
+         block* pEmpty = pFront;
+         pFront = pFront->next;
+         if (block* p = spare.exchange(pEmpty, std::memory_order_release))
+            deleteBlock(p);
+      }
+
+      T* p = pFront->cell(ic);
+      t = std::move(*p);
+      p->~T();
+      idFront.store(id + 1, std::memory_order_release);
+      return true;
+   }
+
+   /*****************************************
+    * SPSC DEQUE :: NEW BLOCK
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   auto spsc_deque <T, A, BS> ::newBlock() -> block*
+   {
+      block* p = block_traits::allocate(alloc, 1);
+      p->next = nullptr;
+      return p;
+   }
+
+   /*****************************************
+    * SPSC DEQUE :: DELETE BLOCK
+    ****************************************/
+   template <typename T, typename A, size_t BS>
+   void spsc_deque <T, A, BS> ::deleteBlock(block* p)
+   {
+      block_traits::deallocate(alloc, p, 1);
+   }
+
+} // namespace custom
@@ -0,0 +1,307 @@
+/***********************************************************************
+ * Header:
+ *    TEST ALGORITHM
+ * Summary:
+ *    Unit tests for the segmented algorithms
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "algorithm.h"  // functions under test
+#include "deque.h"
+#include "unitTest.h"   // unit test baseclass
+
+#include <vector>
+#include <list>
+#include <sstream>     // for std::istringstream
+#include <iterator>    // for std::istream_iterator
+
+/***********************************************
+ * TEST ALGORITHM
+ * Unit tests for the segmented algorithms
+ ***********************************************/
+class TestAlgorithm : public UnitTest
+{
+   // four cells to a block so a short deque spans several blocks
+   typedef custom::deque<int, std::allocator<int>, 4> Deque;
+
+public:
+   void run()
+   {
+      reset();
+
+      // Dispatch
+      test_isSegmented();
+
+      // Copy
+      test_copy_dequeToVector();
+      test_copy_vectorToDeque();
+      test_copy_dequeToDeque();
+      test_copy_listToDeque();
+
+      // Fill
+      test_fill_subrange();
+
+      // For Each
+      test_forEach_wrapped();
+
+      // Find
+      test_find_found();
+      test_find_missing();
+
+      // Accumulate
+      test_accumulate_wrapped();
+      test_accumulate_op();
+
+      // Equal
+      test_equal_match();
+      test_equal_mismatch();
+      test_equal_vectorToDeque();
+      test_equal_dequeToInput();
+
+      report("Algorithm");
+   }
+
+   /***************************************
+    * DISPATCH
+    ***************************************/
+
+   // only the deque's iterators are segmented
+   void test_isSegmented()
+   {
+      assertUnit(custom::is_segmented<Deque::iterator>::value);
+      assertUnit(custom::is_segmented<Deque::const_iterator>::value);
+      assertUnit(!custom::is_segmented<int*>::value);
+      assertUnit(!custom::is_segmented<std::vector<int>::iterator>::value);
+      assertUnit(!custom::is_segmented<Deque::reverse_iterator>::value);
+   }
+
+   /***************************************
+    * COPY
+    ***************************************/
+
+   // copy a wrapped deque into a vector
+   void test_copy_dequeToVector()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      std::vector<int> v(15, -1);
+      // exercise
+      std::vector<int>::iterator it = custom::copy(d.begin(), d.end(), v.begin());
+      // verify
+      assertUnit(it == v.end());
+      for (int i = 0; i < 15; i++)
+         assertUnit(v[i] == i);
+   }  // teardown
+
+   // copy a vector over part of a deque
+   void test_copy_vectorToDeque()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      std::vector<int> v = { 100, 101, 102, 103, 104, 105 };
+      // exercise
+      Deque::iterator it = custom::copy(v.begin(), v.end(), d.begin() + 2);
+      // verify
+      assertUnit(it == d.begin() + 8);
+      for (int i = 0; i < 15; i++)
+         assertUnit(d[i] == (2 <= i && i < 8 ? 98 + i : i));
+   }  // teardown
+
+   // copy between two deques whose blocks do not line up
+   void test_copy_dequeToDeque()
+   {  // setup
+      Deque dSrc;
+      setupWrapped(dSrc, 15);
+      Deque dDes;
+      for (int i = 0; i < 17; i++)
+         dDes.push_back(-1);
+      // exercise
+      Deque::iterator it = custom::copy(dSrc.cbegin(), dSrc.cend(), dDes.begin() + 1);
+      // verify
+      assertUnit(it == dDes.begin() + 16);
+      assertUnit(dDes[0] == -1);
+      for (int i = 0; i < 15; i++)
+         assertUnit(dDes[i + 1] == i);
+      assertUnit(dDes[16] == -1);
+   }  // teardown
+
+   // a list is not random access so it goes element by element
+   void test_copy_listToDeque()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      std::list<int> l = { 7, 8, 9 };
+      // exercise
+      Deque::iterator it = custom::copy(l.begin(), l.end(), d.begin());
+      // verify
+      assertUnit(it == d.begin() + 3);
+      assertUnit(d[0] == 7);
+      assertUnit(d[2] == 9);
+      assertUnit(d[3] == 3);
+   }  // teardown
+
+   /***************************************
+    * FILL
+    ***************************************/
+
+   // fill across block boundaries without touching the ends
+   void test_fill_subrange()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      // exercise
+      custom::fill(d.begin() + 3, d.end() - 2, 42);
+      // verify
+      for (int i = 0; i < 15; i++)
+         assertUnit(d[i] == (3 <= i && i < 13 ? 42 : i));
+   }  // teardown
+
+   /***************************************
+    * FOR EACH
+    ***************************************/
+
+   // visit every element in order
+   void test_forEach_wrapped()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      std::vector<int> seen;
+      // exercise
+      custom::for_each(d.begin(), d.end(), [&seen](int& v) { seen.push_back(v); v++; });
+      // verify
+      assertUnit(seen.size() == 15);
+      for (int i = 0; i < 15 && i < (int)seen.size(); i++)
+      {
+         assertUnit(seen[i] == i);
+         assertUnit(d[i] == i + 1);
+      }
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // find an element in a later block
+   void test_find_found()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      // exercise
+      Deque::iterator it = custom::find(d.begin(), d.end(), 11);
+      // verify
+      assertUnit(it - d.begin() == 11);
+      assertUnit(*it == 11);
+   }  // teardown
+
+   // a missing element gives back last
+   void test_find_missing()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      // exercise
+      Deque::iterator it = custom::find(d.begin(), d.begin() + 10, 11);
+      // verify
+      assertUnit(it == d.begin() + 10);
+   }  // teardown
+
+   /***************************************
+    * ACCUMULATE
+    ***************************************/
+
+   // sum a wrapped deque
+   void test_accumulate_wrapped()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      // exercise
+      long sum = custom::accumulate(d.begin(), d.end(), 0L);
+      // verify
+      assertUnit(sum == 105);
+   }  // teardown
+
+   // fold with an operation that cares about order
+   void test_accumulate_op()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 6);
+      // exercise
+      long digits = custom::accumulate(d.begin() + 1, d.end(), 0L,
+                                       [](long acc, int v) { return acc * 10 + v; });
+      // verify
+      assertUnit(digits == 12345);
+   }  // teardown
+
+   /***************************************
+    * EQUAL
+    ***************************************/
+
+   // two deques with different alignment hold the same values
+   void test_equal_match()
+   {  // setup
+      Deque d1;
+      setupWrapped(d1, 15);
+      Deque d2;
+      for (int i = 0; i < 15; i++)
+         d2.push_back(i);
+      // exercise and verify
+      assertUnit(custom::equal(d1.begin(), d1.end(), d2.begin()));
+      assertUnit(custom::equal(d2.begin() + 3, d2.end(), d1.begin() + 3));
+   }  // teardown
+
+   // a difference in the last block is noticed
+   void test_equal_mismatch()
+   {  // setup
+      Deque d1;
+      setupWrapped(d1, 15);
+      Deque d2;
+      setupWrapped(d2, 15);
+      d2[14] = 99;
+      // exercise and verify
+      assertUnit(!custom::equal(d1.begin(), d1.end(), d2.begin()));
+      assertUnit(custom::equal(d1.begin(), d1.end() - 1, d2.begin()));
+   }  // teardown
+
+   // a vector against a deque
+   void test_equal_vectorToDeque()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      std::vector<int> v = { 4, 5, 6, 7, 8, 9 };
+      // exercise and verify
+      assertUnit(custom::equal(v.begin(), v.end(), d.begin() + 4));
+      assertUnit(!custom::equal(v.begin(), v.end(), d.begin() + 3));
+   }  // teardown
+
+   // a deque against a single-pass range: each value is read once
+   void test_equal_dequeToInput()
+   {  // setup
+      Deque d;
+      setupWrapped(d, 15);
+      std::istringstream in("0 1 2 3 4 5 6 7 8 9 10 11 12 13 14");
+      std::istream_iterator<int> it(in);
+      // exercise
+      bool same = custom::equal(d.begin(), d.end(), it);
+      // verify
+      assertUnit(same);
+   }  // teardown
+
+   /*************************************************************
+    * SETUP WRAPPED
+    *    [0, 1, ... num-1] with the front wrapped to the end of
+    *    the map so the elements do not start on a block boundary
+    *************************************************************/
+   void setupWrapped(Deque& d, int num)
+   {
+      for (int i = 5; i < num; i++)
+         d.push_back(i);
+      for (int i = 4; i >= 0; i--)
+         d.push_front(i);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,230 @@
+/***********************************************************************
+ * Header:
+ *    TEST ALIGNED ALLOCATOR
+ * Summary:
+ *    Unit tests for the aligned and huge page allocators
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "alignedAllocator.h"  // classes under test
+#include "deque.h"
+#include "unitTest.h"          // unit test baseclass
+
+#include <memory>
+#include <algorithm>   // for std::max
+
+/***********************************************
+ * TEST ALIGNED ALLOCATOR
+ * Unit tests for aligned_allocator and huge_page_allocator
+ ***********************************************/
+class TestAlignedAllocator : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Aligned
+      test_aligned_rebind();
+      test_aligned_dequeBlocks();
+      test_aligned_page();
+
+      // Huge pages
+      test_hugePage_small();
+      test_hugePage_carve();
+      test_hugePage_reuse();
+      test_hugePage_oversize();
+      test_hugePage_unmapFree();
+      test_hugePage_tail();
+      test_hugePage_dequeBlocks();
+
+      report("AlignedAlloc");
+   }
+
+   /***************************************
+    * ALIGNED
+    ***************************************/
+
+   // the map allocator keeps the blocks' alignment
+   void test_aligned_rebind()
+   {
+      typedef std::allocator_traits<custom::aligned_allocator<int, 128>>::rebind_alloc<int*> Rebound;
+      assertUnit((std::is_same<Rebound, custom::aligned_allocator<int*, 128>>::value));
+      assertUnit(custom::aligned_allocator<int>::alignment == 64);
+      assertUnit((custom::aligned_allocator<long double, 1>::alignment == alignof(long double)));
+   }
+
+   // every block of a deque starts on a cache line
+   void test_aligned_dequeBlocks()
+   {  // setup
+      custom::deque<int, custom::aligned_allocator<int>, 16> d;
+      // exercise
+      for (int i = 0; i < 200; i++)
+         d.push_back(i);
+      // verify
+      int numSegments = 0;
+      for (custom::span<int> seg : d.segments())
+      {
+         assertUnit((size_t)seg.data() % 64 == 0);
+         numSegments++;
+      }
+      assertUnit(numSegments == 13);
+      for (int id = 0; id < 200 && id < (int)d.size(); id++)
+         assertUnit(d[id] == id);
+   }  // teardown
+
+   // alignment can be as coarse as a page
+   void test_aligned_page()
+   {  // setup
+      custom::aligned_allocator<char, 4096> alloc;
+      // exercise
+      char* p = alloc.allocate(10);
+      // verify
+      assertUnit((size_t)p % 4096 == 0);
+      // teardown
+      alloc.deallocate(p, 10);
+   }
+
+   /***************************************
+    * HUGE PAGES
+    ***************************************/
+
+   // below the threshold it is the aligned allocator
+   void test_hugePage_small()
+   {  // setup
+      custom::huge_page_allocator<char, 256> alloc;
+      // exercise
+      char* p = alloc.allocate(100);
+      // verify
+      assertUnit((size_t)p % 256 == 0);
+      // teardown
+      alloc.deallocate(p, 100);
+   }
+
+   // blocks carved from one region do not overlap
+   void test_hugePage_carve()
+   {  // setup
+      custom::huge_page_allocator<char> alloc;
+      const size_t bytes = 100000;
+      char* p1 = alloc.allocate(bytes);
+      char* p2 = alloc.allocate(bytes);
+      // exercise
+      for (size_t i = 0; i < bytes; i++)
+      {
+         p1[i] = 1;
+         p2[i] = 2;
+      }
+      // verify
+      assertUnit((size_t)p1 % 64 == 0);
+      assertUnit((size_t)p2 % 64 == 0);
+      assertUnit(p1 + bytes <= p2 || p2 + bytes <= p1);
+      assertUnit(p1[bytes - 1] == 1);
+      assertUnit(p2[0] == 2);
+      // teardown
+      alloc.deallocate(p1, bytes);
+      alloc.deallocate(p2, bytes);
+   }
+
+   // a freed block is handed out again for the same size
+   void test_hugePage_reuse()
+   {  // setup
+#ifdef DEQUE_HUGE_PAGES
+      custom::huge_page_allocator<char> alloc;
+      const size_t bytes = 123456;
+      char* p = alloc.allocate(bytes);
+      alloc.deallocate(p, bytes);
+      // exercise
+      char* q = alloc.allocate(bytes);
+      // verify
+      assertUnit(p == q);
+      // teardown
+      alloc.deallocate(q, bytes);
+#endif
+   }
+
+   // bigger than a region is a run of regions on a 2 MiB boundary
+   void test_hugePage_oversize()
+   {  // setup
+      custom::huge_page_allocator<char> alloc;
+      const size_t bytes = 5 * 1024 * 1024;
+      // exercise
+      char* p = alloc.allocate(bytes);
+      p[0] = 1;
+      p[bytes - 1] = 2;
+      // verify
+#ifdef DEQUE_HUGE_PAGES
+      assertUnit((size_t)p % custom::huge_page_arena::regionBytes == 0);
+#endif
+      assertUnit(p[0] == 1);
+      assertUnit(p[bytes - 1] == 2);
+      // teardown
+      alloc.deallocate(p, bytes);
+   }
+
+   // a region whose blocks are all free goes back to the kernel
+   void test_hugePage_unmapFree()
+   {  // setup
+#ifdef DEQUE_HUGE_PAGES
+      custom::huge_page_arena& arena = custom::huge_page_arena::instance();
+      custom::huge_page_allocator<char> alloc;
+      const size_t bytes = 900 * 1024;
+      size_t numRegions = arena.regions.size();
+      char* p[3];
+      for (int i = 0; i < 3; i++)
+         p[i] = alloc.allocate(bytes);
+      assertUnit(arena.regions.size() > numRegions);
+      // exercise
+      for (int i = 0; i < 3; i++)
+         alloc.deallocate(p[i], bytes);
+      // verify
+      assertUnit(arena.regions.size() <= std::max(numRegions, (size_t)1));
+      assertUnit(arena.regions.count(arena.pCurrent) == 1);
+      if (arena.regions.count(arena.pCurrent))
+         assertUnit(arena.regions[arena.pCurrent].tailBytes == custom::huge_page_arena::regionBytes);
+#endif
+   }  // teardown
+
+   // a smaller request is carved from the end an earlier region left
+   void test_hugePage_tail()
+   {  // setup
+#ifdef DEQUE_HUGE_PAGES
+      custom::huge_page_allocator<char> alloc;
+      const size_t regionBytes = custom::huge_page_arena::regionBytes;
+      char* p1 = alloc.allocate(regionBytes / 4 * 3);
+      char* p2 = alloc.allocate(regionBytes);
+      // exercise
+      char* p3 = alloc.allocate(regionBytes / 8);
+      // verify
+      assertUnit(((size_t)p3 & ~(regionBytes - 1)) == ((size_t)p1 & ~(regionBytes - 1)));
+      assertUnit(p1 + regionBytes / 4 * 3 <= p3);
+      // teardown
+      alloc.deallocate(p3, regionBytes / 8);
+      alloc.deallocate(p2, regionBytes);
+      alloc.deallocate(p1, regionBytes / 4 * 3);
+#endif
+   }
+
+   // a deque with big blocks gets them from the arena
+   void test_hugePage_dequeBlocks()
+   {  // setup
+      custom::deque<int, custom::huge_page_allocator<int>, 16384> d;
+      // exercise
+      for (int i = 0; i < 100000; i++)
+         d.push_back(i);
+      for (int i = 0; i < 20000; i++)
+         d.pop_front();
+      // verify
+      assertUnit(d.size() == 80000);
+      for (custom::span<int> seg : d.segments(d.begin() + 1, d.end()))
+         assertUnit((size_t)seg.data() % 64 == 0 || seg.data() == &d[1]);
+      for (int id = 0; id < 80000 && id < (int)d.size(); id += 997)
+         assertUnit(d[id] == id + 20000);
+   }  // teardown
+};
+
+#endif // DEBUG
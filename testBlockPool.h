@@ -0,0 +1,220 @@
+/***********************************************************************
+ * Header:
+ *    TEST BLOCK POOL
+ * Summary:
+ *    Unit tests for the shared block pool
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "blockPool.h"  // class under test
+#include "unitTest.h"   // unit test baseclass
+
+#include <thread>
+#include <vector>
+
+/***********************************************
+ * TEST BLOCK POOL
+ * Unit tests for deque_block_pool
+ ***********************************************/
+class TestBlockPool : public UnitTest
+{
+   // four ints to a block so a short deque spans several blocks
+   typedef custom::pooled_deque<int, 4> Deque;
+
+public:
+   void run()
+   {
+      reset();
+
+      // Allocate
+      test_allocate_reuse();
+      test_allocate_slabs();
+      test_allocate_alignment();
+      test_allocate_giveBack();
+      test_allocate_otherPool();
+
+      // Deque
+      test_deque_shared();
+      test_deque_largeMap();
+      test_deque_threads();
+
+      report("BlockPool");
+   }
+
+   /***************************************
+    * ALLOCATE
+    ***************************************/
+
+   // the last block freed is the next one handed out
+   void test_allocate_reuse()
+   {  // setup
+      custom::deque_block_pool pool(64, 4);
+      void* p = pool.allocate();
+      // exercise
+      pool.deallocate(p);
+      void* q = pool.allocate();
+      // verify
+      assertUnit(p == q);
+      // teardown
+      pool.deallocate(q);
+   }
+
+   // a slab is carved only once the last one is handed out
+   void test_allocate_slabs()
+   {  // setup
+      custom::deque_block_pool pool(64, 4);
+      void* blocks[5];
+      // exercise
+      for (int i = 0; i < 4; i++)
+         blocks[i] = pool.allocate();
+      // verify
+      assertUnit(pool.num_slabs() == 1);
+      blocks[4] = pool.allocate();
+      assertUnit(pool.num_slabs() == 2);
+      for (int i = 0; i < 4; i++)
+         assertUnit(blocks[i] != blocks[i + 1]);
+      // teardown
+      for (int i = 0; i < 5; i++)
+         pool.deallocate(blocks[i]);
+   }
+
+   // every block is aligned like the heap's allocations
+   void test_allocate_alignment()
+   {  // setup
+      custom::deque_block_pool pool(20, 8);
+      void* blocks[8];
+      // exercise
+      for (int i = 0; i < 8; i++)
+         blocks[i] = pool.allocate();
+      // verify
+      assertUnit(pool.block_size() % alignof(std::max_align_t) == 0);
+      assertUnit(pool.block_size() >= 20);
+      for (int i = 0; i < 8; i++)
+         assertUnit((size_t)blocks[i] % alignof(std::max_align_t) == 0);
+      // teardown
+      for (int i = 0; i < 8; i++)
+         pool.deallocate(blocks[i]);
+   }
+
+   // a thread that frees a lot gives blocks back to the shared list
+   void test_allocate_giveBack()
+   {  // setup
+      custom::deque_block_pool pool(64, 64);
+      std::vector<void*> blocks;
+      for (int i = 0; i < 64; i++)
+         blocks.push_back(pool.allocate());
+      // exercise
+      for (void* p : blocks)
+         pool.deallocate(p);
+      // verify
+      assertUnit(pool.localCache().count < 2 * custom::deque_block_pool::numBatch);
+      assertUnit(pool.freeList != nullptr);
+      assertUnit(pool.num_slabs() == 1);
+   }  // teardown
+
+   // using another pool hands this thread's blocks back to the first
+   void test_allocate_otherPool()
+   {  // setup
+      custom::deque_block_pool pool1(64, 4);
+      custom::deque_block_pool pool2(64, 4);
+      void* p = pool1.allocate();
+      pool1.deallocate(p);
+      // exercise
+      void* q = pool2.allocate();
+      // verify
+      assertUnit(pool1.freeList == (void*)p);
+      assertUnit(pool1.allocate() == p);
+      assertUnit(pool1.num_slabs() == 1);
+      // teardown
+      pool1.deallocate(p);
+      pool2.deallocate(q);
+   }
+
+   /***************************************
+    * DEQUE
+    ***************************************/
+
+   // many deques draw their blocks from one pool
+   void test_deque_shared()
+   {  // setup
+      custom::deque_block_pool pool(sizeof(int) * 4, 64);
+      std::vector<Deque> deques;
+      for (int i = 0; i < 100; i++)
+         deques.emplace_back(&pool);
+      // exercise
+      for (int round = 0; round < 3; round++)
+         for (int i = 0; i < 100; i++)
+         {
+            for (int v = 0; v < 10; v++)
+               deques[i].push_back(i * 100 + v);
+            for (int v = 0; v < 5; v++)
+               deques[i].pop_front();
+         }
+      // verify
+      for (int i = 0; i < 100; i++)
+      {
+         assertUnit(deques[i].size() == 15);
+         assertUnit(deques[i].get_allocator().resource() == &pool);
+         assertUnit(deques[i].front() == i * 100 + 5);
+         assertUnit(deques[i].back() == i * 100 + 9);
+      }
+      // each deque spans at most five blocks and a map of up to eight pointers
+      assertUnit(pool.num_slabs() <= (100 * 7 + 63) / 64 + 1);
+   }  // teardown
+
+   // a map bigger than a block comes from the heap
+   void test_deque_largeMap()
+   {  // setup
+      custom::deque_block_pool pool(sizeof(int) * 4, 16);
+      Deque d(&pool);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(d.size() == 1000);
+      for (int id = 0; id < 1000 && id < (int)d.size(); id++)
+         assertUnit(d[id] == id);
+      // 250 blocks, the map is on the heap
+      assertUnit(pool.num_slabs() <= 250 / 16 + 2);
+   }  // teardown
+
+   // threads share a pool, each with its own deques
+   void test_deque_threads()
+   {  // setup
+      custom::deque_block_pool pool(sizeof(int) * 4, 32);
+      long sums[4] = {};
+      // exercise
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&pool, &sums, t]
+         {
+            Deque d(&pool);
+            for (int i = 0; i < 10000; i++)
+            {
+               d.push_back(i);
+               if (i % 3 == 0)
+               {
+                  sums[t] += d.front();
+                  d.pop_front();
+               }
+            }
+            while (!d.empty())
+            {
+               sums[t] += d.front();
+               d.pop_front();
+            }
+         });
+      for (std::thread& thread : threads)
+         thread.join();
+      // verify
+      for (int t = 0; t < 4; t++)
+         assertUnit(sums[t] == 49995000L);
+   }  // teardown
+};
+
+#endif // DEBUG
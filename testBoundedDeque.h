@@ -0,0 +1,284 @@
+/***********************************************************************
+ * Header:
+ *    TEST BOUNDED DEQUE
+ * Summary:
+ *    Unit tests for the bounded many-producer, many-consumer deque
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "boundedDeque.h"  // class under test
+#include "unitTest.h"      // unit test baseclass
+#include "spy.h"           // for the Spy class
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+/***********************************************
+ * TEST BOUNDED DEQUE
+ * Unit tests for bounded_deque
+ ***********************************************/
+class TestBoundedDeque : public UnitTest
+{
+   // four cells to a block so a short deque spans several blocks
+   typedef custom::bounded_deque<int, std::allocator<int>, 4> Deque;
+
+public:
+   void run()
+   {
+      reset();
+
+      // One element
+      test_tryPop_empty();
+      test_tryPush_full();
+      test_tryPush_order();
+      test_tryPush_spy();
+
+      // Batches
+      test_tryPushN_partial();
+      test_tryPopN_betweenBlocks();
+
+      // Waiting
+      test_pop_waitsForPush();
+      test_push_waitsForPop();
+      test_close_wakesPop();
+      test_close_drains();
+
+      // Threads
+      test_threads_batches();
+
+      report("BoundedDeque");
+   }
+
+   /***************************************
+    * ONE ELEMENT
+    ***************************************/
+
+   // nothing to pop
+   void test_tryPop_empty()
+   {  // setup
+      Deque d(4);
+      int value = 99;
+      // exercise
+      bool popped = d.try_pop_front(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+      assertUnit(d.empty());
+   }  // teardown
+
+   // no room past the capacity
+   void test_tryPush_full()
+   {  // setup
+      Deque d(2);
+      d.try_push_back(11);
+      d.try_push_back(26);
+      // exercise
+      bool pushed = d.try_push_back(31);
+      // verify
+      assertUnit(!pushed);
+      assertUnit(d.size() == 2);
+      assertUnit(d.d.back() == 26);
+   }  // teardown
+
+   // first in, first out
+   void test_tryPush_order()
+   {  // setup
+      Deque d(4);
+      int value = 0;
+      // exercise
+      d.try_push_back(11);
+      d.try_push_back(26);
+      d.try_push_back(31);
+      // verify
+      assertUnit(d.try_pop_front(value) && value == 11);
+      assertUnit(d.try_pop_front(value) && value == 26);
+      assertUnit(d.try_pop_front(value) && value == 31);
+      assertUnit(!d.try_pop_front(value));
+   }  // teardown
+
+   // an rvalue is moved in and moved out
+   void test_tryPush_spy()
+   {  // setup
+      custom::bounded_deque<Spy, std::allocator<Spy>, 4> d(4);
+      Spy s;
+      Spy::reset();
+      // exercise
+      d.try_push_back(Spy(26));
+      d.try_pop_front(s);
+      // verify
+      assertUnit(s.get() == 26);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(Spy::numAssignMove() == 1);
+   }  // teardown
+
+   /***************************************
+    * BATCHES
+    ***************************************/
+
+   // as many as fit go in
+   void test_tryPushN_partial()
+   {  // setup
+      Deque d(5);
+      d.try_push_back(0);
+      int batch[] = { 1, 2, 3, 4, 5, 6 };
+      // exercise
+      size_t count = d.try_push_back_n(batch, 6);
+      // verify
+      assertUnit(count == 4);
+      assertUnit(d.size() == 5);
+      assertUnit(d.d.size() == 5);
+      assertUnit(d.d.back() == 4);
+   }  // teardown
+
+   // a batch pop moves out of several blocks at once
+   void test_tryPopN_betweenBlocks()
+   {  // setup
+      //   +----+----+----+----+   +----+----+----+----+   +----+----+----+----+
+      //   |    | 1  | 2  | 3  |   | 4  | 5  | 6  | 7  |   | 8  | 9  |    |    |
+      //   +----+----+----+----+   +----+----+----+----+   +----+----+----+----+
+      Deque d(16);
+      int batch[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+      d.try_push_back_n(batch, 10);
+      int value;
+      d.try_pop_front(value);
+      std::vector<int> out;
+      // exercise
+      size_t count = d.try_pop_front_n(std::back_inserter(out), 7);
+      // verify
+      assertUnit(count == 7);
+      assertUnit(out.size() == 7);
+      for (int i = 0; i < (int)out.size(); i++)
+         assertUnit(out[i] == i + 1);
+      assertUnit(d.size() == 2);
+      assertUnit(d.d.front() == 8);
+   }  // teardown
+
+   /***************************************
+    * WAITING
+    ***************************************/
+
+   // a pop on an empty deque returns once something is pushed
+   void test_pop_waitsForPush()
+   {  // setup
+      Deque d(4);
+      int value = -1;
+      bool popped = false;
+      // exercise
+      std::thread consumer([&] { popped = d.pop_front(value); });
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      d.push_back(26);
+      consumer.join();
+      // verify
+      assertUnit(popped);
+      assertUnit(value == 26);
+      assertUnit(d.empty());
+   }  // teardown
+
+   // a push on a full deque returns once something is popped
+   void test_push_waitsForPop()
+   {  // setup
+      Deque d(1);
+      d.push_back(11);
+      bool pushed = false;
+      // exercise
+      std::thread producer([&] { pushed = d.push_back(26); });
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      int value = -1;
+      d.pop_front(value);
+      producer.join();
+      // verify
+      assertUnit(pushed);
+      assertUnit(value == 11);
+      assertUnit(d.size() == 1);
+      assertUnit(d.d.front() == 26);
+   }  // teardown
+
+   // closing an empty deque releases a waiting pop
+   void test_close_wakesPop()
+   {  // setup
+      Deque d(4);
+      bool popped = true;
+      // exercise
+      std::thread consumer([&] { int value; popped = d.pop_front(value); });
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      d.close();
+      consumer.join();
+      // verify
+      assertUnit(!popped);
+      assertUnit(!d.push_back(11));
+   }  // teardown
+
+   // once closed, what is left can still be popped
+   void test_close_drains()
+   {  // setup
+      Deque d(4);
+      d.push_back(11);
+      d.push_back(26);
+      d.close();
+      int value = -1;
+      // exercise and verify
+      assertUnit(!d.try_push_back(31));
+      assertUnit(d.pop_front(value) && value == 11);
+      assertUnit(d.pop_front(value) && value == 26);
+      assertUnit(!d.pop_front(value));
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // many producers and consumers in batches: every element arrives once
+   void test_threads_batches()
+   {  // setup
+      Deque d(64);
+      const int numThreads = 4;
+      const int numPerProducer = 20000;
+      std::vector<std::atomic<int>> received(numThreads * numPerProducer);
+      for (std::atomic<int>& r : received)
+         r.store(0);
+      // exercise
+      std::vector<std::thread> consumers;
+      for (int t = 0; t < numThreads; t++)
+         consumers.emplace_back([&]
+         {
+            int batch[16];
+            size_t count;
+            while ((count = d.pop_front_n(batch, 16)) > 0)
+               for (size_t i = 0; i < count; i++)
+                  received[batch[i]]++;
+         });
+      std::vector<std::thread> producers;
+      for (int t = 0; t < numThreads; t++)
+         producers.emplace_back([&, t]
+         {
+            int batch[10];
+            for (int i = 0; i < numPerProducer; i += 10)
+            {
+               for (int j = 0; j < 10; j++)
+                  batch[j] = t * numPerProducer + i + j;
+               d.push_back_n(batch, 10);
+            }
+         });
+      for (std::thread& producer : producers)
+         producer.join();
+      d.close();
+      for (std::thread& consumer : consumers)
+         consumer.join();
+      // verify
+      int numWrong = 0;
+      for (std::atomic<int>& r : received)
+         numWrong += (r.load() != 1);
+      assertUnit(numWrong == 0);
+      assertUnit(d.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,259 @@
+/***********************************************************************
+ * Header:
+ *    TEST BYTE BUFFER
+ * Summary:
+ *    Unit tests for the byte buffer, through pipes
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "byteBuffer.h"  // class under test
+#include "unitTest.h"    // unit test baseclass
+
+#ifdef DEQUE_POSIX
+
+#include <string>
+#include <unistd.h>      // for pipe, read, write, close
+#include <fcntl.h>       // for fcntl, O_NONBLOCK
+
+/***********************************************
+ * TEST BYTE BUFFER
+ * Unit tests for byte_buffer
+ ***********************************************/
+class TestByteBuffer : public UnitTest
+{
+   // eight bytes to a block so a short buffer spans several blocks
+   typedef custom::byte_buffer<std::allocator<char>, 8> Buffer;
+
+public:
+   void run()
+   {
+      reset();
+
+      // Read from
+      test_readFrom_empty();
+      test_readFrom_backBlockFirst();
+      test_readFrom_endOfFile();
+      test_readFrom_wouldBlock();
+
+      // Write to
+      test_writeTo_acrossBlocks();
+      test_writeTo_empty();
+
+      // Consume
+      test_consume_wholeBlocks();
+      test_consume_all();
+      test_consume_reuseBlocks();
+
+      report("ByteBuffer");
+   }
+
+   /***************************************
+    * READ FROM
+    ***************************************/
+
+   // the read spreads over fresh blocks; the unreached one is stashed
+   void test_readFrom_empty()
+   {  // setup
+      int fds[2];
+      assertUnit(pipe(fds) == 0);
+      assertUnit(write(fds[1], "abcdefghij", 10) == 10);
+      Buffer b;
+      // exercise
+      ssize_t numBytes = b.read_from(fds[0], 20);
+      // verify
+      //   +---+---+---+---+---+---+---+---+   +---+---+---+---+---+---+---+---+
+      //   | a | b | c | d | e | f | g | h |   | i | j |   |   |   |   |   |   |
+      //   +---+---+---+---+---+---+---+---+   +---+---+---+---+---+---+---+---+
+      assertUnit(numBytes == 10);
+      assertUnit(b.size() == 10);
+      assertUnit(contents(b) == "abcdefghij");
+      assertUnit(b.stash.size() == 1);
+      assertUnit(numBlocksHeld(b) == 2);
+      // teardown
+      close(fds[0]);
+      close(fds[1]);
+   }
+
+   // the free cells of the back block fill first
+   void test_readFrom_backBlockFirst()
+   {  // setup
+      int fds[2];
+      assertUnit(pipe(fds) == 0);
+      assertUnit(write(fds[1], "fghijk", 6) == 6);
+      Buffer b;
+      b.append("abcde", 5);
+      const char* pBack = &b[0];
+      // exercise
+      ssize_t numBytes = b.read_from(fds[0], 6);
+      // verify
+      assertUnit(numBytes == 6);
+      assertUnit(contents(b) == "abcdefghijk");
+      assertUnit(&b[5] == pBack + 5);
+      assertUnit(&b[7] == pBack + 7);
+      assertUnit(numBlocksHeld(b) == 2);
+      // teardown
+      close(fds[0]);
+      close(fds[1]);
+   }
+
+   // at the end of the file nothing changes
+   void test_readFrom_endOfFile()
+   {  // setup
+      int fds[2];
+      assertUnit(pipe(fds) == 0);
+      close(fds[1]);
+      Buffer b;
+      b.append("abc", 3);
+      // exercise
+      ssize_t numBytes = b.read_from(fds[0], 30);
+      // verify
+      assertUnit(numBytes == 0);
+      assertUnit(contents(b) == "abc");
+      assertUnit(numBlocksHeld(b) == 1);
+      assertUnit(b.stash.size() == 4);
+      // teardown
+      close(fds[0]);
+   }
+
+   // a non-blocking descriptor with nothing to read gives EAGAIN
+   void test_readFrom_wouldBlock()
+   {  // setup
+      int fds[2];
+      assertUnit(pipe(fds) == 0);
+      fcntl(fds[0], F_SETFL, O_NONBLOCK);
+      Buffer b;
+      // exercise
+      ssize_t numBytes = b.read_from(fds[0], 16);
+      // verify
+      assertUnit(numBytes == -1);
+      assertUnit(errno == EAGAIN || errno == EWOULDBLOCK);
+      assertUnit(b.empty());
+      assertUnit(numBlocksHeld(b) == 0);
+      // teardown
+      close(fds[0]);
+      close(fds[1]);
+   }
+
+   /***************************************
+    * WRITE TO
+    ***************************************/
+
+   // everything goes out in one call, from where it sits
+   void test_writeTo_acrossBlocks()
+   {  // setup
+      int fds[2];
+      assertUnit(pipe(fds) == 0);
+      Buffer b;
+      b.append("0123456789abcdefghij", 20);
+      b.consume(3);
+      // exercise
+      ssize_t numBytes = b.write_to(fds[1]);
+      // verify
+      assertUnit(numBytes == 17);
+      char out[32] = {};
+      assertUnit(read(fds[0], out, sizeof(out)) == 17);
+      assertUnit(std::string(out) == "3456789abcdefghij");
+      assertUnit(b.empty());
+      assertUnit(numBlocksHeld(b) == 0);
+      assertUnit(b.stash.size() == 3);
+      // teardown
+      close(fds[0]);
+      close(fds[1]);
+   }
+
+   // nothing to write
+   void test_writeTo_empty()
+   {  // setup
+      int fds[2];
+      assertUnit(pipe(fds) == 0);
+      Buffer b;
+      // exercise
+      ssize_t numBytes = b.write_to(fds[1]);
+      // verify
+      assertUnit(numBytes == 0);
+      // teardown
+      close(fds[0]);
+      close(fds[1]);
+   }
+
+   /***************************************
+    * CONSUME
+    ***************************************/
+
+   // each emptied block leaves the deque
+   void test_consume_wholeBlocks()
+   {  // setup
+      Buffer b;
+      b.append("0123456789abcdefghij", 20);
+      const char* pBlock0 = &b[0];
+      // exercise
+      b.consume(10);
+      // verify
+      assertUnit(b.size() == 10);
+      assertUnit(contents(b) == "abcdefghij");
+      assertUnit(numBlocksHeld(b) == 2);
+      assertUnit(b.stash.size() == 1);
+      assertUnit(b.stash[0] == pBlock0);
+   }  // teardown
+
+   // consuming more than there is empties it
+   void test_consume_all()
+   {  // setup
+      Buffer b;
+      b.append("0123456789", 10);
+      b.consume(4);
+      // exercise
+      b.consume(100);
+      // verify
+      assertUnit(b.empty());
+      assertUnit(numBlocksHeld(b) == 0);
+      assertUnit(b.stash.size() == 2);
+   }  // teardown
+
+   // a steady read and consume runs on the same blocks
+   void test_consume_reuseBlocks()
+   {  // setup
+      int fds[2];
+      assertUnit(pipe(fds) == 0);
+      Buffer b;
+      assertUnit(write(fds[1], "0123456789abcdef", 16) == 16);
+      b.read_from(fds[0], 16);
+      b.consume(16);
+      size_t numStashed = b.stash.size();
+      // exercise
+      for (int i = 0; i < 10; i++)
+      {
+         assertUnit(write(fds[1], "0123456789abcdef", 16) == 16);
+         b.read_from(fds[0], 16);
+         b.consume(16);
+      }
+      // verify
+      assertUnit(b.stash.size() == numStashed);
+      // teardown
+      close(fds[0]);
+      close(fds[1]);
+   }
+
+private:
+   static std::string contents(const Buffer& b)
+   {
+      return std::string(b.begin(), b.end());
+   }
+
+   // the blocks holding bytes: one span each
+   static size_t numBlocksHeld(const Buffer& b)
+   {
+      size_t num = 0;
+      for (custom::span<const char> seg : b.segments())
+         num += (seg.size() > 0);
+      return num;
+   }
+};
+
+#endif // DEQUE_POSIX
+#endif // DEBUG
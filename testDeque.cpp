@@ -14,6 +14,17 @@
 
 #include "testDeque.h"       // for the deque unit tests
 #include "testSpy.h"         // for the spy unit tests
+#include "testAlgorithm.h"   // for the segmented algorithm unit tests
+#include "testBlockPool.h"   // for the block pool unit tests
+#include "testAlignedAllocator.h" // for the aligned allocator unit tests
+#include "testSpscDeque.h"   // for the SPSC deque unit tests
+#include "testWorkStealingDeque.h" // for the work-stealing deque unit tests
+#include "testBoundedDeque.h" // for the bounded deque unit tests
+#include "testRingDeque.h"   // for the ring deque unit tests
+#include "testMappedDeque.h" // for the mapped deque unit tests
+#include "testSpillDeque.h"  // for the spill deque unit tests
+#include "testByteBuffer.h"  // for the byte buffer unit tests
+#include "benchDeque.h"      // for the deque benchmarks
 int Spy::counters[] = {};
 
 /**********************************************************************
@@ -26,7 +37,24 @@ int main()
    // unit tests
    TestSpy().run();
    TestDeque().run();
+   TestAlgorithm().run();
+   TestBlockPool().run();
+   TestAlignedAllocator().run();
+   TestSpscDeque().run();
+   TestWorkStealingDeque().run();
+   TestBoundedDeque().run();
+   TestRingDeque().run();
+#ifdef DEQUE_POSIX
+   TestMappedDeque().run();
+   TestSpillDeque().run();
+   TestByteBuffer().run();
+#endif
 #endif // DEBUG
+
+#ifdef BENCHMARK
+   // timings: define BENCHMARK and build optimized
+   BenchDeque().run();
+#endif // BENCHMARK
    
    return 0;
 }
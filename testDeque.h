@@ -17,10 +17,112 @@
 #include <iostream>
 #include <cassert>
 #include <memory>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <list>
+#include <array>
+#include <string>
+#include <sstream>
+#include <iterator>
+#include <stdexcept>
+#include <forward_list>
+#include <memory_resource>
+#include <cstdio>      // for std::tmpfile
+#ifdef DEQUE_POSIX
+#include <unistd.h>    // for lseek, ftruncate
+#endif
 #include "spy.h"
 
+// the fixtures below are all drawn with 16-cell blocks of Spy
+template <>
+struct custom::deque_block<Spy>
+{
+   static constexpr size_t numCells = 16;
+};
+
+/***********************************************
+ * COUNTING ALLOCATOR
+ * A std::allocator that counts its allocations
+ ***********************************************/
+inline int& numAllocations()
+{
+   static int count = 0;
+   return count;
+}
+
+// bytes handed out and not yet given back
+inline long& numBytesOutstanding()
+{
+   static long count = 0;
+   return count;
+}
+
+template <typename T>
+struct CountingAllocator : public std::allocator<T>
+{
+   template <typename U>
+   struct rebind { typedef CountingAllocator<U> other; };
+
+   CountingAllocator() {}
+   template <typename U>
+   CountingAllocator(const CountingAllocator<U>&) {}
+
+   T* allocate(size_t n)
+   {
+      numAllocations()++;
+      numBytesOutstanding() += (long)(n * sizeof(T));
+      return std::allocator<T>::allocate(n);
+   }
+
+   void deallocate(T* p, size_t n)
+   {
+      numBytesOutstanding() -= (long)(n * sizeof(T));
+      std::allocator<T>::deallocate(p, n);
+   }
+};
+
+/***********************************************
+ * COPY THROWER
+ * Counts its live instances and throws from the
+ * copy constructor once copiesLeft() runs out
+ ***********************************************/
+struct CopyThrower
+{
+   // copies allowed before the next one throws, negative for no limit
+   static int& copiesLeft()
+   {
+      static int count = -1;
+      return count;
+   }
+
+   static int& numLive()
+   {
+      static int count = 0;
+      return count;
+   }
+
+   int value;
+
+   CopyThrower(int value) : value(value) { numLive()++; }
+   CopyThrower(const CopyThrower& rhs) : value(rhs.value)
+   {
+      if (copiesLeft() == 0)
+         throw std::runtime_error("copy failed");
+      if (copiesLeft() > 0)
+         copiesLeft()--;
+      numLive()++;
+   }
+   ~CopyThrower() { numLive()--; }
+};
+
 class TestDeque : public UnitTest
 {
+   // hand-built maps, drawn with one-, two- and four-cell blocks
+   typedef custom::deque<Spy, std::allocator<Spy>, 1> Deque1;
+   typedef custom::deque<Spy, std::allocator<Spy>, 2> Deque2;
+   typedef custom::deque<Spy, std::allocator<Spy>, 4> Deque4;
+
 public:
    void run()
    {
@@ -28,11 +130,14 @@ public:
 
       // Utilities
       test_ibFromID_4x1();
-      test_ibFromID_3x3();
+      test_ibFromID_4x2();
       test_icFromID_4x1();
-      test_icFromID_3x3();
+      test_icFromID_4x2();
       test_iaFromID_4x1();
-      test_iaFromID_3x3();
+      test_iaFromID_4x2();
+      test_ibFromID_4x16();
+      test_icFromID_4x16();
+      test_iaFromID_4x16();
       test_realloc_emptyToOne();
       test_realloc_oneToTwo();
       test_realloc_shift();
@@ -41,9 +146,12 @@ public:
 
       // Construct
       test_construct_default();
+      test_construct_blockSize();
       test_constructCopy_empty();
       test_constructCopy_standard();
       test_constructCopy_wrapped();
+      test_constructCopy_trivial();
+      test_constructMove_standard();
       
       // Destruct
       test_destruct_default();
@@ -59,17 +167,36 @@ public:
       test_assign_standardToStandard();
       test_assign_standardToEmpty();
       test_assign_wrapped();
+      test_assign_misaligned();
+      test_assign_longerToShorter();
+      test_assign_longerToShorterSpy();
+      test_assignMove_standard();
+      test_swap_standard();
+
+      // Allocator
+      test_allocator_blockSize();
+      test_allocator_releaseAll();
+      test_allocator_pmr();
+      test_allocator_pmrCopy();
+      test_allocator_pmrMoveUnequal();
 
       // Iterator
       test_iterator_begin_empty();
       test_iterator_begin_standard();
       test_iterator_end_standard();
       test_iterator_increment_standardMiddle();
+      test_iterator_increment_betweenBlocks();
+      test_iterator_decrement_betweenBlocks();
       test_iterator_dereference_read();
       test_iterator_dereference_update();
       test_iterator_add_withinBlock();
       test_iterator_add_betweenBlocks();
       test_iterator_difference_standard();
+      test_iterator_subscript_standard();
+      test_iterator_compare_standard();
+      test_iterator_sort_wrapped();
+      test_iterator_const_standard();
+      test_iterator_reverse_standard();
 
       // Access
       test_back_readStandard();
@@ -86,6 +213,12 @@ public:
       test_subscript_writeStandard();
       test_subscript_writeWrapped();
 
+      // Segments
+      test_segments_empty();
+      test_segments_standard();
+      test_segments_subrange();
+      test_segments_wrapped();
+
       // Insert
       test_pushback_empty();
       test_pushback_roomNoWrap();
@@ -98,6 +231,32 @@ public:
       test_pushfront_wrap();
       test_pushfront_complex();
       test_pushfront_bigWrap();
+      test_pushfront_roomFullMap();
+      test_pushfront_headroom();
+      test_emplaceback_standard();
+      test_emplacefront_standard();
+      test_append_empty();
+      test_append_standard();
+      test_append_fillStandard();
+      test_append_trivial();
+      test_append_contiguous();
+      test_append_inputIterator();
+      test_append_copyThrows();
+      test_append_fillCopyThrows();
+      test_append_copyThrowsThenGrow();
+      test_prepend_empty();
+      test_prepend_standard();
+      test_prepend_trivial();
+      test_prepend_forwardIterator();
+      test_prepend_copyThrows();
+      test_prepend_copyThrowsThenGrow();
+      test_spliceback_empty();
+      test_spliceback_wholeBlocks();
+      test_spliceback_edgeMoves();
+      test_spliceback_misaligned();
+      test_splicefront_wholeBlocks();
+      test_splicefront_edge();
+      test_splice_self();
 
       // Remove
       test_clear_empty();
@@ -112,6 +271,11 @@ public:
       test_popback_lastElement();
       test_popback_lastInBlock();
       test_popback_complex();
+      test_dropfront_acrossBlocks();
+#if DEQUE_SPARE_BLOCKS > 0
+      test_popfront_spareBlock();
+      test_popfront_steadyState();
+#endif
 
       // Status
       test_size_empty();
@@ -119,6 +283,14 @@ public:
       test_empty_empty();
       test_empty_standard();
 
+#ifdef DEQUE_POSIX
+      // Snapshot
+      test_save_empty();
+      test_save_wrapped();
+      test_load_replaces();
+      test_load_truncated();
+      test_load_wrongType();
+#endif
 
       report("Deque");
    }
@@ -137,10 +309,9 @@ public:
       //        \      \      /     /
       //        +----+----+----+----+
       //        | 0  | 1  | 2  | 3  |
-      //        +----+----+----+----+     
-      custom::deque<Spy> d;
+      //        +----+----+----+----+
+      Deque1 d;
       d.numBlocks = 4;
-      d.numCells = 1;
       d.iaFront = 2;
       // exercise
       int ib0 = d.ibFromID(0);
@@ -156,21 +327,20 @@ public:
       teardownStandardFixture(d);
    }
 
-   // Block from Deque where numBlocks = 3, numCells = 3
-   void test_ibFromID_3x3()
+   // Block from Deque where numBlocks = 4, numCells = 2
+   void test_ibFromID_4x2()
    {  // setup
-      //                          iaFront
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //    | 0  | 1  | 2  |  | 3  | 4  | 5  |  | 6  | 7  | 8  |
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //                      \      |      / 
-      //                      +----+----+----+
-      //                      | 0  | 1  | 2  |
-      //                      +----+----+----+
-      custom::deque<Spy> d;
-      d.numBlocks = 3;
-      d.numCells = 3;
-      d.iaFront = 4;
+      //                     iaFront
+      //    +----+----+  +----+----+  +----+----+  +----+----+
+      //    | 0  | 1  |  | 2  | 3  |  | 4  | 5  |  | 6  | 7  |
+      //    +----+----+  +----+----+  +----+----+  +----+----+
+      //          \           \          /            /
+      //           +----+----+----+----+
+      //           | 0  | 1  | 2  | 3  |
+      //           +----+----+----+----+
+      Deque2 d;
+      d.numBlocks = 4;
+      d.iaFront = 3;
       // exercise
       int ib0 = d.ibFromID(0);
       int ib1 = d.ibFromID(1);
@@ -180,17 +350,15 @@ public:
       int ib5 = d.ibFromID(5);
       int ib6 = d.ibFromID(6);
       int ib7 = d.ibFromID(7);
-      int ib8 = d.ibFromID(8);
       // verify
       assertUnit(ib0 == 1);
-      assertUnit(ib1 == 1);
+      assertUnit(ib1 == 2);
       assertUnit(ib2 == 2);
-      assertUnit(ib3 == 2);
-      assertUnit(ib4 == 2);
+      assertUnit(ib3 == 3);
+      assertUnit(ib4 == 3);
       assertUnit(ib5 == 0);
       assertUnit(ib6 == 0);
-      assertUnit(ib7 == 0);
-      assertUnit(ib8 == 1);
+      assertUnit(ib7 == 1);
       // teardown
       teardownStandardFixture(d);
    }
@@ -205,10 +373,9 @@ public:
       //        \      \      /     /
       //        +----+----+----+----+
       //        | 0  | 1  | 2  | 3  |
-      //        +----+----+----+----+     
-      custom::deque<Spy> d;
+      //        +----+----+----+----+
+      Deque1 d;
       d.numBlocks = 4;
-      d.numCells = 1;
       d.iaFront = 2;
       // exercise
       int ic0 = d.icFromID(0);
@@ -224,21 +391,20 @@ public:
       teardownStandardFixture(d);
    }
 
-   // Cell from Deque where numBlocks = 3, numCells = 3
-   void test_icFromID_3x3()
+   // Cell from Deque where numBlocks = 4, numCells = 2
+   void test_icFromID_4x2()
    {  // setup
-      //                          iaFront
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //    | 0  | 1  | 2  |  | 3  | 4  | 5  |  | 6  | 7  | 8  |
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //                      \      |      / 
-      //                      +----+----+----+
-      //                      | 0  | 1  | 2  |
-      //                      +----+----+----+
-      custom::deque<Spy> d;
-      d.numBlocks = 3;
-      d.numCells = 3;
-      d.iaFront = 4;
+      //                     iaFront
+      //    +----+----+  +----+----+  +----+----+  +----+----+
+      //    | 0  | 1  |  | 2  | 3  |  | 4  | 5  |  | 6  | 7  |
+      //    +----+----+  +----+----+  +----+----+  +----+----+
+      //          \           \          /            /
+      //           +----+----+----+----+
+      //           | 0  | 1  | 2  | 3  |
+      //           +----+----+----+----+
+      Deque2 d;
+      d.numBlocks = 4;
+      d.iaFront = 3;
       // exercise
       int ic0 = d.icFromID(0);
       int ic1 = d.icFromID(1);
@@ -248,17 +414,15 @@ public:
       int ic5 = d.icFromID(5);
       int ic6 = d.icFromID(6);
       int ic7 = d.icFromID(7);
-      int ic8 = d.icFromID(8);
       // verify
       assertUnit(ic0 == 1);
-      assertUnit(ic1 == 2);
-      assertUnit(ic2 == 0);
-      assertUnit(ic3 == 1);
-      assertUnit(ic4 == 2);
+      assertUnit(ic1 == 0);
+      assertUnit(ic2 == 1);
+      assertUnit(ic3 == 0);
+      assertUnit(ic4 == 1);
       assertUnit(ic5 == 0);
       assertUnit(ic6 == 1);
-      assertUnit(ic7 == 2);
-      assertUnit(ic8 == 0);
+      assertUnit(ic7 == 0);
       // teardown
       teardownStandardFixture(d);
    }
@@ -273,10 +437,9 @@ public:
       //        \      \      /     /
       //        +----+----+----+----+
       //        | 0  | 1  | 2  | 3  |
-      //        +----+----+----+----+     
-      custom::deque<Spy> d;
+      //        +----+----+----+----+
+      Deque1 d;
       d.numBlocks = 4;
-      d.numCells = 1;
       d.iaFront = 2;
       // exercise
       int ia0 = d.iaFromID(0);
@@ -292,21 +455,20 @@ public:
       teardownStandardFixture(d);
    }
 
-   // Array from Deque where numBlocks = 3, numCells = 3
-   void test_iaFromID_3x3()
+   // Array from Deque where numBlocks = 4, numCells = 2
+   void test_iaFromID_4x2()
    {  // setup
-      //                          iaFront
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //    | 0  | 1  | 2  |  | 3  | 4  | 5  |  | 6  | 7  | 8  |
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //                      \      |      / 
-      //                      +----+----+----+
-      //                      | 0  | 1  | 2  |
-      //                      +----+----+----+
-      custom::deque<Spy> d;
-      d.numBlocks = 3;
-      d.numCells = 3;
-      d.iaFront = 4;
+      //                     iaFront
+      //    +----+----+  +----+----+  +----+----+  +----+----+
+      //    | 0  | 1  |  | 2  | 3  |  | 4  | 5  |  | 6  | 7  |
+      //    +----+----+  +----+----+  +----+----+  +----+----+
+      //          \           \          /            /
+      //           +----+----+----+----+
+      //           | 0  | 1  | 2  | 3  |
+      //           +----+----+----+----+
+      Deque2 d;
+      d.numBlocks = 4;
+      d.iaFront = 3;
       // exercise
       int ia0 = d.iaFromID(0);
       int ia1 = d.iaFromID(1);
@@ -316,21 +478,87 @@ public:
       int ia5 = d.iaFromID(5);
       int ia6 = d.iaFromID(6);
       int ia7 = d.iaFromID(7);
-      int ia8 = d.iaFromID(8);
       // verify
-      assertUnit(ia0 == 4);
-      assertUnit(ia1 == 5);
-      assertUnit(ia2 == 6);
-      assertUnit(ia3 == 7);
-      assertUnit(ia4 == 8);
+      assertUnit(ia0 == 3);
+      assertUnit(ia1 == 4);
+      assertUnit(ia2 == 5);
+      assertUnit(ia3 == 6);
+      assertUnit(ia4 == 7);
       assertUnit(ia5 == 0);
       assertUnit(ia6 == 1);
       assertUnit(ia7 == 2);
-      assertUnit(ia8 == 3);
       // teardown
       teardownStandardFixture(d);
    }
    
+   // Block from Deque where numBlocks = 4, numCells = 16: shift and mask
+   void test_ibFromID_4x16()
+   {  // setup
+      //                                 iaFront
+      //    +--..--+  +--..--+  +--..--+  +--..--+
+      //    | 0-15 |  |16-31 |  |32-47 |  |48-63 |
+      //    +--..--+  +--..--+  +--..--+  +--..--+
+      //        \        \         /        /
+      //         +----+----+----+----+
+      //         | 0  | 1  | 2  | 3  |
+      //         +----+----+----+----+
+      custom::deque<Spy> d;
+      d.numBlocks = 4;
+      d.iaFront = 50;
+      // exercise
+      int ib0  = d.ibFromID(0);
+      int ib13 = d.ibFromID(13);
+      int ib14 = d.ibFromID(14);
+      int ib30 = d.ibFromID(30);
+      // verify
+      assertUnit(ib0  == 3);
+      assertUnit(ib13 == 3);
+      assertUnit(ib14 == 0);
+      assertUnit(ib30 == 1);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // Cell from Deque where numBlocks = 4, numCells = 16: shift and mask
+   void test_icFromID_4x16()
+   {  // setup
+      custom::deque<Spy> d;
+      d.numBlocks = 4;
+      d.iaFront = 50;
+      // exercise
+      int ic0  = d.icFromID(0);
+      int ic13 = d.icFromID(13);
+      int ic14 = d.icFromID(14);
+      int ic30 = d.icFromID(30);
+      // verify
+      assertUnit(ic0  == 2);
+      assertUnit(ic13 == 15);
+      assertUnit(ic14 == 0);
+      assertUnit(ic30 == 0);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // Array from Deque where numBlocks = 4, numCells = 16: shift and mask
+   void test_iaFromID_4x16()
+   {  // setup
+      custom::deque<Spy> d;
+      d.numBlocks = 4;
+      d.iaFront = 50;
+      // exercise
+      int ia0  = d.iaFromID(0);
+      int ia13 = d.iaFromID(13);
+      int ia14 = d.iaFromID(14);
+      int ia63 = d.iaFromID(63);
+      // verify
+      assertUnit(ia0  == 50);
+      assertUnit(ia13 == 63);
+      assertUnit(ia14 == 0);
+      assertUnit(ia63 == 49);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
    /***************************************
     * INDEX TRANSLATORS
     ***************************************/
@@ -338,8 +566,7 @@ public:
    // no blocks to one
    void test_realloc_emptyToOne()
    {  // setup
-      custom::deque<Spy> d;
-      d.numCells = 4;
+      Deque4 d;
       Spy::reset();
       // exercise
       d.reallocate(1);
@@ -371,20 +598,19 @@ public:
    void test_realloc_oneToTwo()
    {  // setup
       //     iaFront
-      //    +----+----+----+
-      //    |    | 99 |    |
-      //    +----+----+----+
-      //            |  
-      //         +----+
-      //         |    |
-      //         +----+
-      custom::deque<Spy> d;
-      d.numCells = 3;
+      //    +----+----+----+----+
+      //    |    | 99 |    |    |
+      //    +----+----+----+----+
+      //              |
+      //           +----+
+      //           |    |
+      //           +----+
+      Deque4 d;
       d.numElements = 1;
       d.numBlocks = 1;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][1], Spy(99));
+      constructCell(d.alloc, &d.data[0][1], Spy(99));
       d.iaFront = 1;
       Spy * pFirstBlock = d.data[0];
       Spy::reset();
@@ -401,17 +627,17 @@ public:
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
       //        iaFront
-      //    +----+----+----+    
-      //    |    | 99 |    |   
-      //    +----+----+----+   
-      //                 |
+      //    +----+----+----+----+
+      //    |    | 99 |    |    |
+      //    +----+----+----+----+
+      //                   |
       //                +----+----+
       //                |    | // |
       //                +----+----+
       assertUnit(d.numElements == 1);
       assertUnit(d.iaFront == 1);
       assertUnit(d.numBlocks == 2);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numCells == 4);
       assertUnit(d.data != nullptr);
       if (d.data)
       { 
@@ -428,28 +654,27 @@ public:
    void test_realloc_shift()
    {  // setup
       //    iaFront
-      //    +----+----+----+
-      //    | 67 | 79 | 85 |
-      //    +----+----+----+
-      //            |  
+      //    +----+----+----+----+
+      //    | 67 | 79 | 85 |    |
+      //    +----+----+----+----+
+      //              |
       //    +----+----+
       //    | // |    |
       //    +----+----+
-      custom::deque<Spy> d;
-      d.numCells = 3;
+      Deque4 d;
       d.numElements = 3;
       d.numBlocks = 2;
-      d.data = new Spy * [2];
+      d.data = allocateMap(d, 2);
       d.data[0] = nullptr;
       d.data[1] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[1][0], Spy(67));
-      d.alloc.construct(&d.data[1][1], Spy(79));
-      d.alloc.construct(&d.data[1][2], Spy(85));
-      d.iaFront = 3;
+      constructCell(d.alloc, &d.data[1][0], Spy(67));
+      constructCell(d.alloc, &d.data[1][1], Spy(79));
+      constructCell(d.alloc, &d.data[1][2], Spy(85));
+      d.iaFront = 4;
       Spy* pFirstBlock = d.data[1];
       Spy::reset();
       // exercise
-      d.reallocate(3);
+      d.reallocate(4);
       // verify
       assertUnit(Spy::numAssign() == 0);
       assertUnit(Spy::numAlloc() == 0);
@@ -461,17 +686,17 @@ public:
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
       //    iaFront
-      //    +----+----+----+
-      //    | 67 | 79 | 85 |
-      //    +----+----+----+
-      //            |  
-      //         +----+----+----+
-      //         |    | // | // |
-      //         +----+----+----+
+      //    +----+----+----+----+
+      //    | 67 | 79 | 85 |    |
+      //    +----+----+----+----+
+      //              |
+      //           +----+----+----+----+
+      //           |    | // | // | // |
+      //           +----+----+----+----+
       assertUnit(d.numElements == 3);
       assertUnit(d.iaFront == 0);
-      assertUnit(d.numBlocks == 3);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.numCells == 4);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
@@ -484,6 +709,7 @@ public:
          }
          assertUnit(d.data[1] == nullptr);
          assertUnit(d.data[2] == nullptr);
+         assertUnit(d.data[3] == nullptr);
       }
       // teardown
       teardownStandardFixture(d);
@@ -502,24 +728,23 @@ public:
       //       +----+----+----+----+
       //       |    | // | // |    |
       //       +----+----+----+----+
-      custom::deque<Spy> d;
-      d.numCells = 2;
+      Deque2 d;
       d.numElements = 3;
       d.numBlocks = 4;
-      d.data = new Spy * [4];
+      d.data = allocateMap(d, 4);
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][0], Spy(11));
-      d.alloc.construct(&d.data[3][1], Spy(28));
-      d.alloc.construct(&d.data[0][0], Spy(31));
+      constructCell(d.alloc, &d.data[3][0], Spy(11));
+      constructCell(d.alloc, &d.data[3][1], Spy(28));
+      constructCell(d.alloc, &d.data[0][0], Spy(31));
       d.iaFront = 6;
       Spy* pFirstBlock = d.data[3];
       Spy* pSecondBlock = d.data[0];
       Spy::reset();
       // exercise
-      d.reallocate(5);
+      d.reallocate(8);
       // verify
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -535,12 +760,12 @@ public:
       //   | 11 | 28 |   | 31 |    | 
       //   +----+----+   +----+----+ 
       //          \       /      
-      //          +----+----+----+----+----+
-      //          |    |    | // | // | // |
-      //          +----+----+----+----+----+
+      //          +----+----+----+--..--+----+
+      //          |    |    | // |      | // |
+      //          +----+----+----+--..--+----+
       assertUnit(d.numElements == 3);
       assertUnit(d.iaFront == 0);
-      assertUnit(d.numBlocks == 5);
+      assertUnit(d.numBlocks == 8);
       assertUnit(d.numCells == 2);
       assertUnit(d.data != nullptr);
       if (d.data)
@@ -556,9 +781,8 @@ public:
          {
             assertUnit(d.data[1][0] == Spy(31));
          }
-         assertUnit(d.data[2] == nullptr);
-         assertUnit(d.data[3] == nullptr);
-         assertUnit(d.data[4] == nullptr);
+         for (int ib = 2; ib < 8; ib++)
+            assertUnit(d.data[ib] == nullptr);
       }
       // teardown
       teardownStandardFixture(d);
@@ -567,37 +791,37 @@ public:
    // wrapping complex - worst case scenario
    void test_realloc_complex()
    {  // setup
-      //                          iaFront
-      //   +----+----+----+   +----+----+----+   +----+----+----+
-      //   | 67 | 79 | 85 |   |    | 11 | 28 |   | 31 | 49 | 59 |
-      //   +----+----+----+   +----+----+----+   +----+----+----+  
-      //                    \         |         /             
-      //                      +----+----+----+
-      //                      |    |    |    |
-      //                      +----+----+----+
-      custom::deque<Spy> d;
-      d.numCells = 3;
-      d.numElements = 8;
-      d.numBlocks = 3;
-      d.data = new Spy * [3];
+      //                      iaFront
+      //   +----+----+   +----+----+   +----+----+   +----+----+
+      //   | 49 | 59 |   | 67 | 79 |   |    | 11 |   | 28 | 31 |
+      //   +----+----+   +----+----+   +----+----+   +----+----+
+      //             \         \        /           /
+      //              +----+----+----+----+
+      //              |    |    |    |    |
+      //              +----+----+----+----+
+      Deque2 d;
+      d.numElements = 7;
+      d.numBlocks = 4;
+      d.data = allocateMap(d, 4);
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = d.alloc.allocate(d.numCells);
       d.data[2] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[1][1], Spy(11));
-      d.alloc.construct(&d.data[1][2], Spy(28));
-      d.alloc.construct(&d.data[2][0], Spy(31));
-      d.alloc.construct(&d.data[2][1], Spy(49));
-      d.alloc.construct(&d.data[2][2], Spy(59));
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
-      d.alloc.construct(&d.data[0][2], Spy(85));
-      d.iaFront = 4;
+      d.data[3] = d.alloc.allocate(d.numCells);
+      constructCell(d.alloc, &d.data[2][1], Spy(11));
+      constructCell(d.alloc, &d.data[3][0], Spy(28));
+      constructCell(d.alloc, &d.data[3][1], Spy(31));
+      constructCell(d.alloc, &d.data[0][0], Spy(49));
+      constructCell(d.alloc, &d.data[0][1], Spy(59));
+      constructCell(d.alloc, &d.data[1][0], Spy(67));
+      constructCell(d.alloc, &d.data[1][1], Spy(79));
+      d.iaFront = 5;
       Spy* pFirstBlock = d.data[0];
       Spy* pSecondBlock = d.data[1];
       Spy* pThirdBlock = d.data[2];
+      Spy* pFourthBlock = d.data[3];
       Spy::reset();
       // exercise
-      d.reallocate(4);
+      d.reallocate(8);
       // verify
       assertUnit(Spy::numCopyMove() == 0);  
       assertUnit(Spy::numAssign() == 0);
@@ -609,41 +833,43 @@ public:
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
       //        iaFront
-      //   +----+----+----+   +----+----+----+   +----+----+----+   
-      //   |    | 11 | 28 |   | 31 | 49 | 59 |   | 67 | 79 | 85 |   
-      //   +----+----+----+   +----+----+----+   +----+----+----+   
-      //                          \         \     /                     
-      //                             +----+----+----+----+
-      //                             |    |    |    | // |
-      //                             +----+----+----+----+
-      assertUnit(d.numElements == 8);
+      //   +----+----+   +----+----+   +----+----+   +----+----+
+      //   |    | 11 |   | 28 | 31 |   | 49 | 59 |   | 67 | 79 |
+      //   +----+----+   +----+----+   +----+----+   +----+----+
+      //             \         \        /           /
+      //              +----+----+----+----+----+--..--+----+
+      //              |    |    |    |    | // |      | // |
+      //              +----+----+----+----+----+--..--+----+
+      assertUnit(d.numElements == 7);
       assertUnit(d.iaFront == 1);
-      assertUnit(d.numBlocks == 4);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numBlocks == 8);
+      assertUnit(d.numCells == 2);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
-         assertUnit(d.data[0] == pSecondBlock);
-         if (d.data[0] == pSecondBlock)
-         {
+         assertUnit(d.data[0] == pThirdBlock);
+         if (d.data[0] == pThirdBlock)
             assertUnit(d.data[0][1] == Spy(11));
-            assertUnit(d.data[0][2] == Spy(28));
-         }
-         assertUnit(d.data[1] == pThirdBlock);
-         if (d.data[1] == pThirdBlock)
+         assertUnit(d.data[1] == pFourthBlock);
+         if (d.data[1] == pFourthBlock)
          {
-            assertUnit(d.data[1][0] == Spy(31));
-            assertUnit(d.data[1][1] == Spy(49));
-            assertUnit(d.data[1][2] == Spy(59));
+            assertUnit(d.data[1][0] == Spy(28));
+            assertUnit(d.data[1][1] == Spy(31));
          }
          assertUnit(d.data[2] == pFirstBlock);
          if (d.data[2] == pFirstBlock)
          {                    
-            assertUnit(d.data[2][0] == Spy(67));
-            assertUnit(d.data[2][1] == Spy(79));
-            assertUnit(d.data[2][2] == Spy(85));
+            assertUnit(d.data[2][0] == Spy(49));
+            assertUnit(d.data[2][1] == Spy(59));
          }
-         assertUnit(d.data[3] == nullptr);
+         assertUnit(d.data[3] == pSecondBlock);
+         if (d.data[3] == pSecondBlock)
+         {                    
+            assertUnit(d.data[3][0] == Spy(67));
+            assertUnit(d.data[3][1] == Spy(79));
+         }
+         for (int ib = 4; ib < 8; ib++)
+            assertUnit(d.data[ib] == nullptr);
       }
       // teardown
       teardownStandardFixture(d);
@@ -659,13 +885,12 @@ public:
       std::allocator<custom::deque<Spy>> alloc;
       custom::deque<Spy> d;
       d.iaFront = 66;
-      d.numCells = 77;
       d.numBlocks = 88;
       d.numElements = 99;
       d.data = (Spy **)0xBAADF00D;
       Spy::reset();
       // exercise
-      alloc.construct(&d);  // just call the constructor by itself
+      std::allocator_traits<std::allocator<custom::deque<Spy>>>::construct(alloc, &d);  // just call the constructor by itself
       // verify
       assertUnit(Spy::numAssign() == 0);     
       assertUnit(Spy::numAlloc() == 0);
@@ -679,6 +904,25 @@ public:
       assertEmptyFixture(d);
    }  // teardown
 
+   // the default block size fills DEQUE_BLOCK_BYTES
+   void test_construct_blockSize()
+   {  // setup
+      struct Medium { char buffer[200]; };
+      struct Large  { char buffer[1000]; };
+      // exercise
+      custom::deque<char>   dChar;
+      custom::deque<double> dDouble;
+      custom::deque<Medium> dMedium;
+      custom::deque<Large>  dLarge;
+      custom::deque<double, std::allocator<double>, 4> dPinned;
+      // verify
+      assertUnit(dChar.numCells   == DEQUE_BLOCK_BYTES);
+      assertUnit(dDouble.numCells == DEQUE_BLOCK_BYTES / sizeof(double));
+      assertUnit(dMedium.numCells == 2);
+      assertUnit(dLarge.numCells  == 1);
+      assertUnit(dPinned.numCells == 4);
+   }  // teardown
+
    /***************************************
     * SIZE EMPTY CAPACITY
     ***************************************/
@@ -707,15 +951,15 @@ public:
    // size of the standard fixture
    void test_size_standard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy::reset();
       // exercise
@@ -760,15 +1004,15 @@ public:
    // is a standard fixture empty?
    void test_empty_standard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy::reset();
       // exercise
@@ -789,6 +1033,146 @@ public:
       teardownStandardFixture(d);
    }
 
+#ifdef DEQUE_POSIX
+   /***************************************
+    * SNAPSHOT
+    ***************************************/
+
+   // an empty deque saves just the header
+   void test_save_empty()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d1;
+      custom::deque<int, std::allocator<int>, 4> d2;
+      FILE* file = std::tmpfile();
+      int fd = fileno(file);
+      // exercise
+      d1.save(fd);
+      lseek(fd, 0, SEEK_SET);
+      d2.load(fd);
+      // verify
+      assertUnit(lseek(fd, 0, SEEK_END) == (off_t)sizeof(decltype(d1)::snapshot_header));
+      assertUnit(d2.empty());
+      assertUnit(d2.data == nullptr);
+      // teardown
+      std::fclose(file);
+   }
+
+   // a wrapped deque comes back in order, each block read whole
+   void test_save_wrapped()
+   {  // setup
+      //   +----+----+----+----+   +----+----+----+----+   +----+----+----+----+
+      //   | 0  | 1  | 2  | 3  |   | 4  | 5  |    |    |   |    | -3 | -2 | -1 |
+      //   +----+----+----+----+   +----+----+----+----+   +----+----+----+----+
+      custom::deque<int, std::allocator<int>, 4> d1;
+      for (int i = 0; i < 6; i++)
+         d1.push_back(i);
+      for (int i = -1; i >= -3; i--)
+         d1.push_front(i);
+      custom::deque<int, std::allocator<int>, 4> d2;
+      FILE* file = std::tmpfile();
+      int fd = fileno(file);
+      // exercise
+      d1.save(fd);
+      lseek(fd, 0, SEEK_SET);
+      d2.load(fd);
+      // verify
+      assertUnit(lseek(fd, 0, SEEK_END) == (off_t)(sizeof(decltype(d1)::snapshot_header) + 9 * sizeof(int)));
+      assertUnit(d2.size() == 9);
+      for (int id = 0; id < 9; id++)
+         assertUnit(d2[id] == id - 3);
+      assertUnit(d2.iaFront == 0);
+      assertUnit(d2.data[0] != d1.data[0]);
+      assertUnit(d2.data[2] != nullptr);
+      // teardown
+      std::fclose(file);
+   }
+
+   // loading throws away what was there
+   void test_load_replaces()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d1;
+      d1.push_back(11);
+      d1.push_back(26);
+      d1.push_back(31);
+      custom::deque<int, std::allocator<int>, 4> d2;
+      for (int i = 0; i < 20; i++)
+         d2.push_back(i);
+      FILE* file = std::tmpfile();
+      int fd = fileno(file);
+      d1.save(fd);
+      lseek(fd, 0, SEEK_SET);
+      // exercise
+      d2.load(fd);
+      // verify
+      assertUnit(d2.size() == 3);
+      assertUnit(d2[0] == 11);
+      assertUnit(d2[1] == 26);
+      assertUnit(d2[2] == 31);
+      // teardown
+      std::fclose(file);
+   }
+
+   // a short file is an error and leaves the deque empty
+   void test_load_truncated()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d1;
+      for (int i = 0; i < 9; i++)
+         d1.push_back(i);
+      custom::deque<int, std::allocator<int>, 4> d2;
+      d2.push_back(99);
+      FILE* file = std::tmpfile();
+      int fd = fileno(file);
+      d1.save(fd);
+      assertUnit(ftruncate(fd, sizeof(decltype(d1)::snapshot_header) + 5 * sizeof(int)) == 0);
+      lseek(fd, 0, SEEK_SET);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         d2.load(fd);
+      }
+      catch (const std::runtime_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(d2.empty());
+      for (size_t ib = 0; ib < d2.numBlocks; ib++)
+         assertUnit(d2.data[ib] == nullptr);
+      // teardown
+      std::fclose(file);
+   }
+
+   // a snapshot of ints will not load as long longs
+   void test_load_wrongType()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d1;
+      d1.push_back(26);
+      custom::deque<long long> d2;
+      d2.push_back(11);
+      FILE* file = std::tmpfile();
+      int fd = fileno(file);
+      d1.save(fd);
+      lseek(fd, 0, SEEK_SET);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         d2.load(fd);
+      }
+      catch (const std::runtime_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(d2.size() == 1);
+      assertUnit(d2.front() == 11);
+      // teardown
+      std::fclose(file);
+   }
+#endif // DEQUE_POSIX
 
    /***************************************
     * COPY
@@ -818,19 +1202,19 @@ public:
    // copy constructor a standard deque
    void test_constructCopy_standard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> dSrc;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 dSrc;
       setupStandardFixture(dSrc);
       Spy::reset();
       // exercise
-      custom::deque<Spy> dDes(dSrc);
+      Deque4 dDes(dSrc);
       // verify
       assertUnit(Spy::numCopy() == 4);    // copy [31, 49, 55, 67]
       assertUnit(Spy::numAlloc() == 4);   // allocate [31, 49, 55, 67]
@@ -851,7 +1235,7 @@ public:
       //   +----+
       assertUnit(dDes.numElements == 4);
       assertUnit(dDes.numBlocks == 1);
-      assertUnit(dDes.numCells == 16);
+      assertUnit(dDes.numCells == 4);
       assertUnit(dDes.data != nullptr);
       if (dDes.data != nullptr && dDes.data[0])
       {
@@ -869,33 +1253,29 @@ public:
    // copy constructor where the source is wrapped. Need to unwrap
    void test_constructCopy_wrapped()
    {  // setup
-      //                                iaFront
-      //   +----+----+----+    +----+----+----+
-      //   | 67 | 79 |    |    |    |    | 59 |
-      //   +----+----+----+    +----+----+----+
-      //     |                             |
-      //   +----+----+----+----+----+----+----+
-      //   |    | // | // | // | // | // |    |
-      //   +----+----+----+----+----+----+----+
-      custom::deque<Spy> dSrc;
-      dSrc.numCells = 3;
+      //                                          iaFront
+      //   +----+----+----+----+    +----+----+----+----+
+      //   | 67 | 79 |    |    |    |    |    |    | 59 |
+      //   +----+----+----+----+    +----+----+----+----+
+      //     |                                       |
+      //   +----+----+----+----+----+----+----+----+
+      //   |    | // | // | // | // | // | // |    |
+      //   +----+----+----+----+----+----+----+----+
+      Deque4 dSrc;
       dSrc.numElements = 3;
-      dSrc.numBlocks = 7;
-      dSrc.data = new Spy * [7];
+      dSrc.numBlocks = 8;
+      dSrc.data = allocateMap(dSrc, 8);
       dSrc.data[0] = dSrc.alloc.allocate(dSrc.numCells);
-      dSrc.data[1] = nullptr;
-      dSrc.data[2] = nullptr;
-      dSrc.data[3] = nullptr;
-      dSrc.data[4] = nullptr;
-      dSrc.data[5] = nullptr;
-      dSrc.data[6] = dSrc.alloc.allocate(dSrc.numCells);
-      dSrc.alloc.construct(&dSrc.data[6][2], Spy(59));
-      dSrc.alloc.construct(&dSrc.data[0][0], Spy(67));
-      dSrc.alloc.construct(&dSrc.data[0][1], Spy(79));
-      dSrc.iaFront = 20;
+      for (int ib = 1; ib < 7; ib++)
+         dSrc.data[ib] = nullptr;
+      dSrc.data[7] = dSrc.alloc.allocate(dSrc.numCells);
+      constructCell(dSrc.alloc, &dSrc.data[7][3], Spy(59));
+      constructCell(dSrc.alloc, &dSrc.data[0][0], Spy(67));
+      constructCell(dSrc.alloc, &dSrc.data[0][1], Spy(79));
+      dSrc.iaFront = 31;
       Spy::reset();
       // exercise
-      custom::deque<Spy> dDes(dSrc);
+      Deque4 dDes(dSrc);
       // verify
       assertUnit(Spy::numCopy() == 3);    // copy [59, 67, 79]
       assertUnit(Spy::numAlloc() == 3);   // allocate [59, 67, 79]
@@ -907,16 +1287,16 @@ public:
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
       //   iaFront
-      //   +----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+ 
-      //   | 59 | 67 | 79 |    |    |    |    |    |    |    |    |    |    |    |    |    | 
-      //   +----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+
+      //   +----+----+----+----+
+      //   | 59 | 67 | 79 |    |
+      //   +----+----+----+----+
       //     |             
       //   +----+
       //   |    |
       //   +----+
       assertUnit(dDes.numElements == 3);
       assertUnit(dDes.numBlocks == 1);
-      assertUnit(dDes.numCells == 16);
+      assertUnit(dDes.numCells == 4);
       assertUnit(dDes.data != nullptr);
       if (dDes.data != nullptr && dDes.data[0])
       {
@@ -929,6 +1309,58 @@ public:
       teardownStandardFixture(dDes);
    }
 
+   // copy a wrapped deque of ints a block at a time
+   void test_constructCopy_trivial()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> dSrc;
+      for (int i = 3; i < 13; i++)
+         dSrc.push_back(i);
+      for (int i = 2; i >= 0; i--)
+         dSrc.push_front(i);
+      // exercise
+      custom::deque<int, std::allocator<int>, 4> dDes(dSrc);
+      // verify
+      assertUnit(dDes.numElements == 13);
+      assertUnit(dDes.numBlocks == 4);
+      assertUnit(dDes.iaFront == 0);
+      for (int id = 0; id < 13 && id < (int)dDes.size(); id++)
+      {
+         assertUnit(dDes[id] == id);
+         assertUnit(dSrc[id] == id);
+      }
+   }  // teardown
+
+   // move construct takes the map without touching an element
+   void test_constructMove_standard()
+   {  // setup
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 dSrc;
+      setupStandardFixture(dSrc);
+      Spy** pMap = dSrc.data;
+      Spy::reset();
+      // exercise
+      Deque4 dDes(std::move(dSrc));
+      // verify
+      assertUnit(std::is_nothrow_move_constructible<Deque4>::value);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(dDes.data == pMap);
+      assertStandardFixture(dDes);
+      assertEmptyFixture(dSrc);
+      // teardown
+      teardownStandardFixture(dDes);
+   }
+
    /***************************************
     * ASSIGNMENT
     ***************************************/
@@ -940,7 +1372,6 @@ public:
          custom::deque <Spy> d;
          d.iaFront = 0;
          d.numBlocks = 0;
-         d.numCells = 16;
          d.numElements = 0;
          d.data = nullptr;
          Spy::reset();
@@ -959,23 +1390,22 @@ public:
    // A single block that is empty
    void test_destruct_emptyBlock()
    {  // setup
-      //      0     1    2   3    4    5    6
-      //    +----+----+----+----+----+----+----+
-      //    |    |    |    |    |    |    |    |
-      //    +----+----+----+----+----+----+----+
+      //      0    1    2    3    4    5    6    7
+      //    +----+----+----+----+----+----+----+----+
+      //    |    |    |    |    |    |    |    |    |
+      //    +----+----+----+----+----+----+----+----+
       //            |
       //          +----+
       //          |    |
       //          +----+
       {
          std::allocator<Spy> alloc;
-         custom::deque <Spy> d;
+         custom::deque <Spy, std::allocator<Spy>, 8> d;
          d.iaFront = 0;
          d.numBlocks = 1;
-         d.numCells = 7;
          d.numElements = 0;
-         d.data = new Spy * [1];
-         d.data[0] = alloc.allocate(7);
+         d.data = allocateMap(d, 1);
+         d.data[0] = alloc.allocate(8);
          Spy::reset();
       }  // exercise
       assertUnit(Spy::numCopy() == 0);
@@ -992,34 +1422,34 @@ public:
    // one block completely filled
    void test_destruct_fullBlock()
    {  // setup
-      //      0     1    2   3    4    5    6
-      //    +----+----+----+----+----+----+----+
-      //    | 00 | 01 | 02 | 03 | 04 | 05 | 06 |
-      //    +----+----+----+----+----+----+----+
+      //      0    1    2    3    4    5    6    7
+      //    +----+----+----+----+----+----+----+----+
+      //    | 00 | 01 | 02 | 03 | 04 | 05 | 06 | 07 |
+      //    +----+----+----+----+----+----+----+----+
       //            |
       //          +----+
       //          |    |
       //          +----+
       {
          std::allocator<Spy> alloc;
-         custom::deque <Spy> d;
+         custom::deque <Spy, std::allocator<Spy>, 8> d;
          d.iaFront = 0;
          d.numBlocks = 1;
-         d.numCells = 7;
-         d.numElements = 7;
-         d.data = new Spy * [1];
-         d.data[0] = alloc.allocate(7);
+         d.numElements = 8;
+         d.data = allocateMap(d, 1);
+         d.data[0] = alloc.allocate(8);
          new((void*)(&(d.data[0][0]))) Spy(00);
          new((void*)(&(d.data[0][1]))) Spy(01);
          new((void*)(&(d.data[0][2]))) Spy(02);
          new((void*)(&(d.data[0][3]))) Spy(03);
          new((void*)(&(d.data[0][4]))) Spy(04);
          new((void*)(&(d.data[0][5]))) Spy(05);
-         new((void*)(&(d.data[0][6]))) Spy(07);
+         new((void*)(&(d.data[0][6]))) Spy(06);
+         new((void*)(&(d.data[0][7]))) Spy(07);
          Spy::reset();
       }  // exercise
-      assertUnit(Spy::numDelete() == 7);     // 00 01 02 03 04 05 06
-      assertUnit(Spy::numDestructor() == 7); // 00 01 02 03 04 05 06
+      assertUnit(Spy::numDelete() == 8);     // 00 01 02 03 04 05 06 07
+      assertUnit(Spy::numDestructor() == 8); // 00 01 02 03 04 05 06 07
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -1032,23 +1462,22 @@ public:
    // one block partially filled
    void test_destruct_partBlock()
    {  // setup
-      //      0     1    2   3    4    5    6
-      //    +----+----+----+----+----+----+----+
-      //    |    |    | 02 | 03 | 04 | 05 |    |
-      //    +----+----+----+----+----+----+----+
+      //      0    1    2    3    4    5    6    7
+      //    +----+----+----+----+----+----+----+----+
+      //    |    |    | 02 | 03 | 04 | 05 |    |    |
+      //    +----+----+----+----+----+----+----+----+
       //            |
       //          +----+
       //          |    |
       //          +----+
       {
          std::allocator<Spy> alloc;
-         custom::deque <Spy> d;
+         custom::deque <Spy, std::allocator<Spy>, 8> d;
          d.iaFront = 2;
          d.numBlocks = 1;
-         d.numCells = 7;
          d.numElements = 4;
-         d.data = new Spy * [1];
-         d.data[0] = alloc.allocate(7);
+         d.data = allocateMap(d, 1);
+         d.data[0] = alloc.allocate(8);
          new((void*)(&(d.data[0][2]))) Spy(02);
          new((void*)(&(d.data[0][3]))) Spy(03);
          new((void*)(&(d.data[0][4]))) Spy(04);
@@ -1068,36 +1497,37 @@ public:
    
    void test_destruct_twoBlock()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 10 | 11 | 12 |  | 20 | 21 | 22 |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 10 | 11 | 12 | 13 |  | 20 | 21 | 22 | 23 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       {
          std::allocator<Spy> alloc;
-         custom::deque <Spy> d;
-         d.iaFront = 3;
+         Deque4 d;
+         d.iaFront = 4;
          d.numBlocks = 4;
-         d.numCells = 3;
-         d.numElements = 6;
-         d.data = new Spy * [4];
+         d.numElements = 8;
+         d.data = allocateMap(d, 4);
          d.data[0] = nullptr;
-         d.data[1] = alloc.allocate(3);
-         d.data[2] = alloc.allocate(3);
+         d.data[1] = alloc.allocate(4);
+         d.data[2] = alloc.allocate(4);
          d.data[3] = nullptr;
          new((void*)(&(d.data[1][0]))) Spy(10);
          new((void*)(&(d.data[1][1]))) Spy(11);
          new((void*)(&(d.data[1][2]))) Spy(12);
+         new((void*)(&(d.data[1][3]))) Spy(13);
          new((void*)(&(d.data[2][0]))) Spy(20);
          new((void*)(&(d.data[2][1]))) Spy(21);
          new((void*)(&(d.data[2][2]))) Spy(22);
+         new((void*)(&(d.data[2][3]))) Spy(23);
          Spy::reset();
       }  // exercise
-      assertUnit(Spy::numDelete() == 6);     // 10 11 12 20 21 22
-      assertUnit(Spy::numDestructor() == 6); // 10 11 12 20 21 22
+      assertUnit(Spy::numDelete() == 8);     // 10 11 12 13 20 21 22 23
+      assertUnit(Spy::numDestructor() == 8); // 10 11 12 13 20 21 22 23
       assertUnit(Spy::numCopy() == 0);
       assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numAssign() == 0);
@@ -1110,16 +1540,16 @@ public:
    // destroy the standard fixture
    void test_destruct_standard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       {
-         custom::deque<Spy> d;
+         Deque4 d;
          setupStandardFixture(d);
          Spy::reset();
       }  // exercise
@@ -1163,17 +1593,17 @@ public:
    // assignment when source and destination are same size
    void test_assign_standardToStandard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> dSrc;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 dSrc;
       setupStandardFixture(dSrc);
-      custom::deque<Spy> dDes;
+      Deque4 dDes;
       setupStandardFixture(dDes);
       Spy::reset();
       // exercise
@@ -1198,17 +1628,17 @@ public:
    // assignment when the destination is smaller than the source
    void test_assign_standardToEmpty()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> dSrc;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 dSrc;
       setupStandardFixture(dSrc);
-      custom::deque<Spy> dDes;
+      Deque4 dDes;
       Spy::reset();
       // exercise
       dDes = dSrc;
@@ -1232,7 +1662,7 @@ public:
       //   +----+
       assertUnit(dDes.numElements == 4);
       assertUnit(dDes.numBlocks == 1);
-      assertUnit(dDes.numCells == 16);
+      assertUnit(dDes.numCells == 4);
       assertUnit(dDes.data != nullptr);
       if (dDes.data != nullptr && dDes.data[0])
       {
@@ -1250,16 +1680,16 @@ public:
    // assignment when the destination is bigger than the source
    void test_assign_emptyToStandard()
    {  // setup
-      custom::deque<Spy> dSrc;
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> dDes;
+      Deque4 dSrc;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 dDes;
       setupStandardFixture(dDes);
       Spy::reset();
       // exercise
@@ -1277,7 +1707,7 @@ public:
       assertEmptyFixture(dSrc);
       assertUnit(dDes.numElements == 0);
       assertUnit(dDes.numBlocks == 4);
-      assertUnit(dDes.numCells == 3);
+      assertUnit(dDes.numCells == 4);
       assertUnit(dDes.data != nullptr);
       // teardown
       teardownStandardFixture(dSrc);
@@ -1287,31 +1717,27 @@ public:
    // assign where the source is wrapped. Need to unwrap
    void test_assign_wrapped()
    {  // setup
-      //                                iaFront
-      //   +----+----+----+    +----+----+----+
-      //   | 67 | 79 |    |    |    |    | 59 |
-      //   +----+----+----+    +----+----+----+
-      //     |                             |
-      //   +----+----+----+----+----+----+----+
-      //   |    | // | // | // | // | // |    |
-      //   +----+----+----+----+----+----+----+
-      custom::deque<Spy> dSrc;
-      dSrc.numCells = 3;
+      //                                          iaFront
+      //   +----+----+----+----+    +----+----+----+----+
+      //   | 67 | 79 |    |    |    |    |    |    | 59 |
+      //   +----+----+----+----+    +----+----+----+----+
+      //     |                                       |
+      //   +----+----+----+----+----+----+----+----+
+      //   |    | // | // | // | // | // | // |    |
+      //   +----+----+----+----+----+----+----+----+
+      Deque4 dSrc;
       dSrc.numElements = 3;
-      dSrc.numBlocks = 7;
-      dSrc.data = new Spy * [7];
+      dSrc.numBlocks = 8;
+      dSrc.data = allocateMap(dSrc, 8);
       dSrc.data[0] = dSrc.alloc.allocate(dSrc.numCells);
-      dSrc.data[1] = nullptr;
-      dSrc.data[2] = nullptr;
-      dSrc.data[3] = nullptr;
-      dSrc.data[4] = nullptr;
-      dSrc.data[5] = nullptr;
-      dSrc.data[6] = dSrc.alloc.allocate(dSrc.numCells);
-      dSrc.alloc.construct(&dSrc.data[6][2], Spy(59));
-      dSrc.alloc.construct(&dSrc.data[0][0], Spy(67));
-      dSrc.alloc.construct(&dSrc.data[0][1], Spy(79));
-      dSrc.iaFront = 20;
-      custom::deque<Spy> dDes;
+      for (int ib = 1; ib < 7; ib++)
+         dSrc.data[ib] = nullptr;
+      dSrc.data[7] = dSrc.alloc.allocate(dSrc.numCells);
+      constructCell(dSrc.alloc, &dSrc.data[7][3], Spy(59));
+      constructCell(dSrc.alloc, &dSrc.data[0][0], Spy(67));
+      constructCell(dSrc.alloc, &dSrc.data[0][1], Spy(79));
+      dSrc.iaFront = 31;
+      Deque4 dDes;
       Spy::reset();
       // exercise
       dDes = dSrc;
@@ -1326,16 +1752,16 @@ public:
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
       //   iaFront
-      //   +----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+ 
-      //   | 59 | 67 | 79 |    |    |    |    |    |    |    |    |    |    |    |    |    | 
-      //   +----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+
+      //   +----+----+----+----+
+      //   | 59 | 67 | 79 |    |
+      //   +----+----+----+----+
       //     |             
       //   +----+
       //   |    |
       //   +----+
       assertUnit(dDes.numElements == 3);
       assertUnit(dDes.numBlocks == 1);
-      assertUnit(dDes.numCells == 16);
+      assertUnit(dDes.numCells == 4);
       assertUnit(dDes.data != nullptr);
       if (dDes.data != nullptr && dDes.data[0])
       {
@@ -1348,52 +1774,264 @@ public:
       teardownStandardFixture(dDes);
    }
 
-   
-   /***************************************
-    * CLEAR
-    ***************************************/
-   
-   // clear an empty collection
-   void test_clear_empty()
+   // assign between deques whose fronts sit at different cells
+   void test_assign_misaligned()
    {  // setup
-      custom::deque<Spy> d;
-      Spy::reset();
+      custom::deque<int, std::allocator<int>, 4> dSrc;
+      for (int i = 3; i < 13; i++)
+         dSrc.push_back(i);
+      for (int i = 2; i >= 0; i--)
+         dSrc.push_front(i);
+      custom::deque<int, std::allocator<int>, 4> dDes;
+      for (int i = 100; i < 106; i++)
+         dDes.push_back(i);
       // exercise
-      d.clear();
+      dDes = dSrc;
       // verify
-      assertUnit(Spy::numAssign() == 0);
-      assertUnit(Spy::numAlloc() == 0);
-      assertUnit(Spy::numDelete() == 0);
-      assertUnit(Spy::numDefault() == 0);
-      assertUnit(Spy::numNondefault() == 0);
-      assertUnit(Spy::numCopy() == 0);
-      assertUnit(Spy::numCopyMove() == 0);
-      assertUnit(Spy::numAssignMove() == 0);
-      assertUnit(Spy::numDestructor() == 0);
-      assertEmptyFixture(d);
+      assertUnit(dDes.size() == 13);
+      for (int id = 0; id < 13 && id < (int)dDes.size(); id++)
+      {
+         assertUnit(dDes[id] == id);
+         assertUnit(dSrc[id] == id);
+      }
    }  // teardown
 
-   // clear when there are elements
-   void test_clear_standard()
+   // assign a short deque over a long one, freeing the extra blocks
+   void test_assign_longerToShorter()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
-      setupStandardFixture(d);
-      Spy::reset();
+      custom::deque<int, std::allocator<int>, 4> dSrc;
+      for (int i = 0; i < 5; i++)
+         dSrc.push_front(i);
+      custom::deque<int, std::allocator<int>, 4> dDes;
+      for (int i = 100; i < 113; i++)
+         dDes.push_back(i);
       // exercise
-      d.clear();
+      dDes = dSrc;
       // verify
-      assertUnit(Spy::numDelete() == 4);     // delete 31, 49, 55, 67
-      assertUnit(Spy::numDestructor() == 4); // destroy 31, 49, 55, 67
-      assertUnit(Spy::numAssign() == 0);
-      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(dDes.size() == 5);
+      for (int id = 0; id < 5 && id < (int)dDes.size(); id++)
+         assertUnit(dDes[id] == 4 - id);
+      assertUnit(dDes.data[dDes.ibFromID(8)] == nullptr);
+   }  // teardown
+
+   // the surplus is destroyed once each and every block past the kept
+   // elements goes back, with no element copied to get there
+   void test_assign_longerToShorterSpy()
+   {  // setup
+      //            dDes                              dSrc
+      //   +----+----+----+----+  ...              +----+----+----+----+
+      //   |  0 |  1 |  2 |  3 |  4 .. 13          |  0 | 11 | 22 |    |
+      //   +----+----+----+----+                   +----+----+----+----+
+      Deque4 dSrc;
+      for (int i = 0; i < 3; i++)
+         dSrc.push_back(Spy(i * 11));
+      Deque4 dDes;
+      for (int i = 0; i < 14; i++)
+         dDes.push_back(Spy(i));
+      Spy::reset();
+      // exercise
+      dDes = dSrc;
+      // verify
+      assertUnit(Spy::numAssign() == 3);        // assign 0, 11, 22
+      assertUnit(Spy::numDestructor() == 11);   // destroy 3 .. 13
+      assertUnit(Spy::numDelete() == 11);       // delete 3 .. 13
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(dDes.numElements == 3);
+      for (int id = 0; id < 3 && id < (int)dDes.size(); id++)
+         assertUnit(dDes[id] == Spy(id * 11));
+      assertUnit(dDes.data[dDes.ibFromID(0)] != nullptr);
+      for (int id = 4; id < 14; id += 4)
+         assertUnit(dDes.data[dDes.ibFromID(id)] == nullptr);
+      assertUnit(dDes.numSpare == std::min<size_t>(3, DEQUE_SPARE_BLOCKS));
+   }  // teardown
+
+   // move assign destroys the old elements and takes the map
+   void test_assignMove_standard()
+   {  // setup
+      Deque4 dSrc;
+      setupStandardFixture(dSrc);
+      Deque4 dDes;
+      dDes.push_back(Spy(11));
+      dDes.push_back(Spy(26));
+      Spy** pMap = dSrc.data;
+      Spy::reset();
+      // exercise
+      dDes = std::move(dSrc);
+      // verify
+      assertUnit(Spy::numDestructor() == 2); // destroy 11, 26
+      assertUnit(Spy::numDelete() == 2);     // delete 11, 26
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(dDes.data == pMap);
+      assertStandardFixture(dDes);
+      assertUnit(dSrc.numElements == 0);
+      // teardown
+      teardownStandardFixture(dDes);
+   }
+
+   // swap exchanges the maps, not the elements
+   void test_swap_standard()
+   {  // setup
+      Deque4 d1;
+      setupStandardFixture(d1);
+      Deque4 d2;
+      d2.push_back(Spy(11));
+      Spy** pMap1 = d1.data;
+      Spy** pMap2 = d2.data;
+      Spy::reset();
+      // exercise
+      swap(d1, d2);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(d1.data == pMap2);
+      assertUnit(d2.data == pMap1);
+      assertStandardFixture(d2);
+      assertUnit(d1.size() == 1);
+      if (d1.size() == 1)
+         assertUnit(d1.front() == Spy(11));
+      // teardown
+      teardownStandardFixture(d2);
+   }
+
+   /***************************************
+    * ALLOCATOR
+    ***************************************/
+
+   // a block is numCells Ts and the map is numBlocks pointers
+   void test_allocator_blockSize()
+   {  // setup
+      custom::deque<Spy, CountingAllocator<Spy>> d;
+      numBytesOutstanding() = 0;
+      // exercise
+      d.push_back(Spy(99));
+      // verify
+      assertUnit(d.numBlocks == 1);
+      assertUnit(numBytesOutstanding() == (long)(16 * sizeof(Spy) + 1 * sizeof(Spy*)));
+   }  // teardown
+
+   // the destructor gives back the blocks, the spares and the map
+   void test_allocator_releaseAll()
+   {  // setup
+      numBytesOutstanding() = 0;
+      {
+         custom::deque<Spy, CountingAllocator<Spy>> d;
+         for (int i = 0; i < 40; i++)
+            d.push_back(Spy(i));
+         for (int i = 0; i < 30; i++)
+            d.pop_front();
+         assertUnit(d.numSpare > 0 || DEQUE_SPARE_BLOCKS == 0);
+      }  // exercise
+      // verify
+      assertUnit(numBytesOutstanding() == 0);
+   }  // teardown
+
+   // everything comes from the memory resource we give it
+   void test_allocator_pmr()
+   {  // setup
+      char buffer[4096];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      custom::pmr::deque<int> d(&resource);
+      // exercise
+      for (int i = 0; i < 300; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(d.get_allocator().resource() == &resource);
+      assertUnit(d.size() == 300);
+      for (int id = 0; id < 300 && id < (int)d.size(); id++)
+         assertUnit(d[id] == id);
+   }  // teardown
+
+   // a copy does not share the source's resource
+   void test_allocator_pmrCopy()
+   {  // setup
+      std::pmr::unsynchronized_pool_resource resource;
+      custom::pmr::deque<int> dSrc(&resource);
+      for (int i = 0; i < 10; i++)
+         dSrc.push_back(i);
+      // exercise
+      custom::pmr::deque<int> dDes(dSrc);
+      // verify
+      assertUnit(dDes.get_allocator().resource() == std::pmr::get_default_resource());
+      assertUnit(dDes.size() == 10);
+      for (int id = 0; id < 10 && id < (int)dDes.size(); id++)
+         assertUnit(dDes[id] == id);
+   }  // teardown
+
+   // moving between resources moves the elements, not the blocks
+   void test_allocator_pmrMoveUnequal()
+   {  // setup
+      std::pmr::unsynchronized_pool_resource resource1;
+      std::pmr::unsynchronized_pool_resource resource2;
+      custom::pmr::deque<int> dSrc(&resource1);
+      for (int i = 0; i < 10; i++)
+         dSrc.push_back(i);
+      custom::pmr::deque<int> dDes(&resource2);
+      dDes.push_back(99);
+      // exercise
+      dDes = std::move(dSrc);
+      // verify
+      assertUnit(dDes.get_allocator().resource() == &resource2);
+      assertUnit(dDes.size() == 10);
+      for (int id = 0; id < 10 && id < (int)dDes.size(); id++)
+         assertUnit(dDes[id] == id);
+      assertUnit(dSrc.empty());
+   }  // teardown
+
+   
+   /***************************************
+    * CLEAR
+    ***************************************/
+   
+   // clear an empty collection
+   void test_clear_empty()
+   {  // setup
+      custom::deque<Spy> d;
+      Spy::reset();
+      // exercise
+      d.clear();
+      // verify
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertEmptyFixture(d);
+   }  // teardown
+
+   // clear when there are elements
+   void test_clear_standard()
+   {  // setup
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      Spy::reset();
+      // exercise
+      d.clear();
+      // verify
+      assertUnit(Spy::numDelete() == 4);     // delete 31, 49, 55, 67
+      assertUnit(Spy::numDestructor() == 4); // destroy 31, 49, 55, 67
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAlloc() == 0);
       assertUnit(Spy::numDefault() == 0);
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopy() == 0);
@@ -1404,7 +2042,7 @@ public:
       //          +----+----+----+----+
       assertUnit(d.numElements == 0);
       assertUnit(d.numBlocks == 4);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numCells == 4);
       assertUnit(d.data != nullptr);
       if (d.data != nullptr)
       {
@@ -1425,8 +2063,7 @@ public:
    // add an element when the deque is empty
    void test_pushback_empty()
    {  // setup
-      custom::deque<Spy> d;
-      d.numCells = 5;
+      Deque4 d;
       Spy s(99);
       Spy::reset();
       // exercise
@@ -1442,15 +2079,15 @@ public:
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       //    iaFront
-      //    +----+----+----+----+----+
-      //    | 99 |    |    |    |    |
-      //    +----+----+----+----+----+
-      //                |  
-      //             +----+
-      //             |    |
-      //             +----+
+      //    +----+----+----+----+
+      //    | 99 |    |    |    |
+      //    +----+----+----+----+
+      //              |
+      //           +----+
+      //           |    |
+      //           +----+
       assertUnit(d.numElements == 1);
-      assertUnit(d.numCells == 5);
+      assertUnit(d.numCells == 4);
       assertUnit(d.numBlocks == 1);
       assertUnit(d.iaFront == 0);
       assertUnit(d.data != nullptr);
@@ -1463,15 +2100,15 @@ public:
    // add an element when there is room. Add an element to an existing block
    void test_pushback_roomNoWrap()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy s(99);
       Spy::reset();
@@ -1487,14 +2124,14 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 | 99 |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 | 99 |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(d.numElements == 5);
       assertUnit(d.data != nullptr);
       if (d.data)
@@ -1503,7 +2140,7 @@ public:
          if (d.data[2] && d.numElements == 5)
          {
             assertUnit(d.data[2][2] == Spy(99));
-            d.alloc.destroy(&d.data[2][2]);
+            destroyCell(d.alloc, &d.data[2][2]);
             d.numElements = 4;
          }
       }
@@ -1515,18 +2152,19 @@ public:
    // add an element when there is room. Add a new block
    void test_pushback_newBlock()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 | 79 |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 | 79 | 85 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       new((void*)(&(d.data[2][2]))) Spy(79);
-      d.numElements++;
+      new((void*)(&(d.data[2][3]))) Spy(85);
+      d.numElements += 2;
       Spy s(99);
       Spy::reset();
       // exercise
@@ -1541,15 +2179,15 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //      0     1    2       0    1    2      0    1    2
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 | 79 |  | 99 |    |    |
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //                      \       |        /   
-      //                 +----+----+----+----+
-      //                 | // |    |    |    |
-      //                 +----+----+----+----+
-      assertUnit(d.numElements == 6);
+      //      0    1    2    3       0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 | 79 | 85 |  | 99 |    |    |    |
+      //    +----+----+----+----+  +----+----+----+----+  +----+----+----+----+
+      //                        \           |           /
+      //                     +----+----+----+----+
+      //                     | // |    |    |    |
+      //                     +----+----+----+----+
+      assertUnit(d.numElements == 7);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
@@ -1557,14 +2195,16 @@ public:
          if (d.data[2])
          {
             assertUnit(d.data[2][2] == Spy(79));
-            d.alloc.destroy(&d.data[2][2]);
-            d.numElements--;
+            assertUnit(d.data[2][3] == Spy(85));
+            destroyCell(d.alloc, &d.data[2][2]);
+            destroyCell(d.alloc, &d.data[2][3]);
+            d.numElements -= 2;
          }
          assertUnit(d.data[3] != nullptr);
          if (d.data[3])
          {
             assertUnit(d.data[3][0] == Spy(99));
-            d.alloc.destroy(&d.data[3][0]);
+            destroyCell(d.alloc, &d.data[3][0]);
             d.numElements--;
             d.alloc.deallocate(d.data[3], d.numCells);
             d.data[3] = nullptr;
@@ -1587,14 +2227,13 @@ public:
       //            +----+
       //            |    |
       //            +----+
-      custom::deque<Spy> d;
-      d.numCells = 4;
+      Deque4 d;
       d.numElements = 2;
       d.numBlocks = 1;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][2], Spy(11));
-      d.alloc.construct(&d.data[0][3], Spy(28));
+      constructCell(d.alloc, &d.data[0][2], Spy(11));
+      constructCell(d.alloc, &d.data[0][3], Spy(28));
       Spy * pBlock = d.data[0];
       d.iaFront = 2;
       Spy s(99);
@@ -1643,34 +2282,34 @@ public:
    // add an element that will cause the deque to reallocaate. This will cause an unwrap
    void test_pushback_complex()
    {  // setup
-      //                             iaFront
-      //   +----+----+----+   +----+----+----+   +----+----+----+
-      //   | 67 | 79 | 85 |   |    | 11 | 28 |   | 31 | 49 | 59 |
-      //   +----+----+----+   +----+----+----+   +----+----+----+  
-      //                    \         |         /             
-      //                      +----+----+----+
-      //                      |    |    |    |
-      //                      +----+----+----+
-      custom::deque<Spy> d;
-      d.numCells = 3;
-      d.numElements = 8;
-      d.numBlocks = 3;
-      d.data = new Spy * [3];
+      //                      iaFront
+      //   +----+----+   +----+----+   +----+----+   +----+----+
+      //   | 49 | 59 |   | 67 | 79 |   |    | 11 |   | 28 | 31 |
+      //   +----+----+   +----+----+   +----+----+   +----+----+
+      //             \         \        /           /
+      //              +----+----+----+----+
+      //              |    |    |    |    |
+      //              +----+----+----+----+
+      Deque2 d;
+      d.numElements = 7;
+      d.numBlocks = 4;
+      d.data = allocateMap(d, 4);
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = d.alloc.allocate(d.numCells);
       d.data[2] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[1][1], Spy(11));
-      d.alloc.construct(&d.data[1][2], Spy(28));
-      d.alloc.construct(&d.data[2][0], Spy(31));
-      d.alloc.construct(&d.data[2][1], Spy(49));
-      d.alloc.construct(&d.data[2][2], Spy(59));
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
-      d.alloc.construct(&d.data[0][2], Spy(85));
-      d.iaFront = 4;
+      d.data[3] = d.alloc.allocate(d.numCells);
+      constructCell(d.alloc, &d.data[2][1], Spy(11));
+      constructCell(d.alloc, &d.data[3][0], Spy(28));
+      constructCell(d.alloc, &d.data[3][1], Spy(31));
+      constructCell(d.alloc, &d.data[0][0], Spy(49));
+      constructCell(d.alloc, &d.data[0][1], Spy(59));
+      constructCell(d.alloc, &d.data[1][0], Spy(67));
+      constructCell(d.alloc, &d.data[1][1], Spy(79));
+      d.iaFront = 5;
       Spy* pFirstBlock  = d.data[0];
       Spy* pSecondBlock = d.data[1];
       Spy* pThirdBlock  = d.data[2];
+      Spy* pFourthBlock = d.data[3];
       Spy s(99);
       Spy::reset();
       // exercise
@@ -1686,45 +2325,44 @@ public:
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
       //        iaFront
-      //   +----+----+----+   +----+----+----+   +----+----+----+   +----+----+----+
-      //   |    | 11 | 28 |   | 31 | 49 | 59 |   | 67 | 79 | 85 |   | 99 |    |    |
-      //   +----+----+----+   +----+----+----+   +----+----+----+   +----+----+----+ 
-      //                          \         \     /      /            
-      //                             +----+----+----+----+----+----+
-      //                             |    |    |    |    | // | // |
-      //                             +----+----+----+----+----+----+
-      assertUnit(d.numElements == 9);
+      //   +----+----+   +----+----+   +----+----+   +----+----+   +----+----+
+      //   |    | 11 |   | 28 | 31 |   | 49 | 59 |   | 67 | 79 |   | 99 |    |
+      //   +----+----+   +----+----+   +----+----+   +----+----+   +----+----+
+      //             \         \        /           /            /
+      //              +----+----+----+----+----+----+----+----+
+      //              |    |    |    |    |    | // | // | // |
+      //              +----+----+----+----+----+----+----+----+
+      assertUnit(d.numElements == 8);
       assertUnit(d.iaFront == 1);
-      assertUnit(d.numBlocks == 6);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numBlocks == 8);
+      assertUnit(d.numCells == 2);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
-         assertUnit(d.data[0] == pSecondBlock);
-         if (d.data[0])
-         {
+         assertUnit(d.data[0] == pThirdBlock);
+         if (d.data[0] == pThirdBlock)
             assertUnit(d.data[0][1] == Spy(11));
-            assertUnit(d.data[0][2] == Spy(28));
-         }
-         assertUnit(d.data[1] == pThirdBlock);
-         if (d.data[1] == pThirdBlock)
+         assertUnit(d.data[1] == pFourthBlock);
+         if (d.data[1] == pFourthBlock)
          {
-            assertUnit(d.data[1][0] == Spy(31));
-            assertUnit(d.data[1][1] == Spy(49));
-            assertUnit(d.data[1][2] == Spy(59));
+            assertUnit(d.data[1][0] == Spy(28));
+            assertUnit(d.data[1][1] == Spy(31));
          }
          assertUnit(d.data[2] == pFirstBlock);
-         if (d.data[2])
+         if (d.data[2] == pFirstBlock)
          {
-            assertUnit(d.data[2][0] == Spy(67));
-            assertUnit(d.data[2][1] == Spy(79));
-            assertUnit(d.data[2][2] == Spy(85));
+            assertUnit(d.data[2][0] == Spy(49));
+            assertUnit(d.data[2][1] == Spy(59));
          }
-         assertUnit(d.data[3] != nullptr);
-         if (d.data[3] && d.numBlocks == 6)
+         assertUnit(d.data[3] == pSecondBlock);
+         if (d.data[3] == pSecondBlock)
          {
-            assertUnit(d.data[3][0] == Spy(99));
+            assertUnit(d.data[3][0] == Spy(67));
+            assertUnit(d.data[3][1] == Spy(79));
          }
+         assertUnit(d.data[4] != nullptr);
+         if (d.data[4] && d.numBlocks == 8)
+            assertUnit(d.data[4][0] == Spy(99));
       }
       // teardown
       teardownStandardFixture(d);
@@ -1737,8 +2375,7 @@ public:
     // add an element when the deque is empty
    void test_pushfront_empty()
    {  // setup
-      custom::deque<Spy> d;
-      d.numCells = 5;
+      Deque4 d;
       Spy s(99);
       Spy::reset();
       // exercise
@@ -1753,22 +2390,22 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //                       iaFront
-      //      0     1   2    3     4
-      //    +----+----+----+----+----+
-      //    |    |    |    |    | 99 |
-      //    +----+----+----+----+----+
-      //                |  
-      //             +----+
-      //             |    |
-      //             +----+
+      //                  iaFront
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    |    |    |    | 99 |
+      //    +----+----+----+----+
+      //              |
+      //           +----+
+      //           |    |
+      //           +----+
       assertUnit(d.numElements == 1);
-      assertUnit(d.numCells == 5);
+      assertUnit(d.numCells == 4);
       assertUnit(d.numBlocks == 1);
-      assertUnit(d.iaFront == 4);
+      assertUnit(d.iaFront == 3);
       assertUnit(d.data != nullptr);
       if (d.data)
-         assertUnit(d.data[0][4] == Spy(99));
+         assertUnit(d.data[0][3] == Spy(99));
       // teardown
       teardownStandardFixture(d);
    }
@@ -1776,15 +2413,15 @@ public:
    // add an element when there is room. Add an element to an existing block
    void test_pushfront_roomNoWrap()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy s(99);
       Spy::reset();
@@ -1800,26 +2437,26 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 99 | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    | 99 | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(d.numElements == 5);
-      assertUnit(d.iaFront == 3);
+      assertUnit(d.iaFront == 5);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
          assertUnit(d.data[1] != nullptr);
          if (d.data[1] && d.numElements == 5)
          {
-            assertUnit(d.data[1][0] == Spy(99));
-            d.alloc.destroy(&d.data[1][0]);
+            assertUnit(d.data[1][1] == Spy(99));
+            destroyCell(d.alloc, &d.data[1][1]);
             d.numElements = 4;
-            d.iaFront = 4;
+            d.iaFront = 6;
          }
       }
       assertStandardFixture(d);
@@ -1831,19 +2468,20 @@ public:
    void test_pushfront_newBlock()
    {  // setup
       //    iaFront
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 28 | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 20 | 28 | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
-      new((void*)(&(d.data[1][0]))) Spy(28);
-      d.iaFront--;
-      d.numElements++;
+      new((void*)(&(d.data[1][0]))) Spy(20);
+      new((void*)(&(d.data[1][1]))) Spy(28);
+      d.iaFront -= 2;
+      d.numElements += 2;
       Spy s(99);
       Spy::reset();
       // exercise
@@ -1858,25 +2496,25 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //              iaFront
-      //      0     1    2       0    1    2      0    1    2
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //    |    |    | 99 |  | 28 | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+  +----+----+----+
-      //                     \        |       /   
-      //                      +----+----+----+----+
-      //                      |    |    |    | // |
-      //                      +----+----+----+----+
-      assertUnit(d.numElements == 6);
-      assertUnit(d.iaFront == 2);
+      //                   iaFront
+      //      0    1    2    3       0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+  +----+----+----+----+
+      //    |    |    |    | 99 |  | 20 | 28 | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+  +----+----+----+----+
+      //                        \           |           /
+      //                        +----+----+----+----+
+      //                        |    |    |    | // |
+      //                        +----+----+----+----+
+      assertUnit(d.numElements == 7);
+      assertUnit(d.iaFront == 3);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
          assertUnit(d.data[0] != nullptr);
          if (d.data[0])
          {
-            assertUnit(d.data[0][2] == Spy(99));
-            d.alloc.destroy(&d.data[0][2]);
+            assertUnit(d.data[0][3] == Spy(99));
+            destroyCell(d.alloc, &d.data[0][3]);
             d.alloc.deallocate(d.data[0], d.numCells);
             d.data[0] = nullptr;
             d.iaFront++;
@@ -1884,10 +2522,12 @@ public:
          }
          if (d.data[1])
          {
-            assertUnit(d.data[1][0] == Spy(28));
-            d.alloc.destroy(&d.data[1][0]);
-            d.numElements--;
-            d.iaFront++;
+            assertUnit(d.data[1][0] == Spy(20));
+            assertUnit(d.data[1][1] == Spy(28));
+            destroyCell(d.alloc, &d.data[1][0]);
+            destroyCell(d.alloc, &d.data[1][1]);
+            d.numElements -= 2;
+            d.iaFront += 2;
          }
          assertUnit(d.data[2] != nullptr);
       }
@@ -1908,14 +2548,13 @@ public:
       //            +----+
       //            |    |
       //            +----+
-      custom::deque<Spy> d;
-      d.numCells = 4;
+      Deque4 d;
       d.numElements = 2;
       d.numBlocks = 1;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][0], Spy(11));
-      d.alloc.construct(&d.data[0][1], Spy(28));
+      constructCell(d.alloc, &d.data[0][0], Spy(11));
+      constructCell(d.alloc, &d.data[0][1], Spy(28));
       Spy* pBlock = d.data[0];
       d.iaFront = 0;
       Spy s(99);
@@ -1967,34 +2606,34 @@ public:
    // add an element that will cause the deque to reallocaate. This will cause an unwrap
    void test_pushfront_complex()
    {  // setup
-         //                   iaFront
-      //   +----+----+----+   +----+----+----+   +----+----+----+
-      //   | 67 | 79 |    |   |  5 | 11 | 28 |   | 31 | 49 | 59 |
-      //   +----+----+----+   +----+----+----+   +----+----+----+  
-      //                    \         |         /             
-      //                      +----+----+----+
-      //                      |    |    |    |
-      //                      +----+----+----+
-      custom::deque<Spy> d;
-      d.numCells = 3;
-      d.numElements = 8;
-      d.numBlocks = 3;
-      d.data = new Spy * [3];
+      //                 iaFront
+      //   +----+----+   +----+----+   +----+----+   +----+----+
+      //   | 67 |    |   |  5 | 11 |   | 28 | 31 |   | 49 | 59 |
+      //   +----+----+   +----+----+   +----+----+   +----+----+
+      //             \         \        /           /
+      //              +----+----+----+----+
+      //              |    |    |    |    |
+      //              +----+----+----+----+
+      Deque2 d;
+      d.numElements = 7;
+      d.numBlocks = 4;
+      d.data = allocateMap(d, 4);
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = d.alloc.allocate(d.numCells);
       d.data[2] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[1][0], Spy(5));
-      d.alloc.construct(&d.data[1][1], Spy(11));
-      d.alloc.construct(&d.data[1][2], Spy(28));
-      d.alloc.construct(&d.data[2][0], Spy(31));
-      d.alloc.construct(&d.data[2][1], Spy(49));
-      d.alloc.construct(&d.data[2][2], Spy(59));
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
-      d.iaFront = 3;
+      d.data[3] = d.alloc.allocate(d.numCells);
+      constructCell(d.alloc, &d.data[1][0], Spy(5));
+      constructCell(d.alloc, &d.data[1][1], Spy(11));
+      constructCell(d.alloc, &d.data[2][0], Spy(28));
+      constructCell(d.alloc, &d.data[2][1], Spy(31));
+      constructCell(d.alloc, &d.data[3][0], Spy(49));
+      constructCell(d.alloc, &d.data[3][1], Spy(59));
+      constructCell(d.alloc, &d.data[0][0], Spy(67));
+      d.iaFront = 2;
       Spy* pFirstBlock = d.data[0];
       Spy* pSecondBlock = d.data[1];
       Spy* pThirdBlock = d.data[2];
+      Spy* pFourthBlock = d.data[3];
       Spy s(99);
       Spy::reset();
       // exercise
@@ -2009,18 +2648,17 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
-      //   iaFront
-      //   +----+----+----+   +----+----+----+   +----+----+----+   +----+----+----+ 
-      //   | 5  | 11 | 28 |   | 31 | 49 | 59 |   | 67 | 79 |    |   |    |    | 99 |
-      //   +----+----+----+   +----+----+----+   +----+----+----+   +----+----+----+    
-      //                          \         \     /             /      
-      //                        +----+----+----+----+----+----+
-      //                        |    |    |    | // | // |    |
-      //                        +----+----+----+----+----+----+
-      assertUnit(d.numElements == 9);
-      assertUnit(d.iaFront == 17);
-      assertUnit(d.numBlocks == 6);
-      assertUnit(d.numCells == 3);
+      //   +----+----+   +----+----+   +----+----+   +----+----+         iaFront
+      //   |  5 | 11 |   | 28 | 31 |   | 49 | 59 |   | 67 |    |   +----+----+
+      //   +----+----+   +----+----+   +----+----+   +----+----+   |    | 99 |
+      //             \         \        /           /             +----+----+
+      //              +----+----+----+----+----+----+----+----+   /
+      //              |    |    |    |    | // | // | // |    |
+      //              +----+----+----+----+----+----+----+----+
+      assertUnit(d.numElements == 8);
+      assertUnit(d.iaFront == 15);
+      assertUnit(d.numBlocks == 8);
+      assertUnit(d.numCells == 2);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
@@ -2029,27 +2667,28 @@ public:
          {
             assertUnit(d.data[0][0] == Spy(5));
             assertUnit(d.data[0][1] == Spy(11));
-            assertUnit(d.data[0][2] == Spy(28));
          }
          assertUnit(d.data[1] == pThirdBlock);
          if (d.data[1] == pThirdBlock)
          {
-            assertUnit(d.data[1][0] == Spy(31));
-            assertUnit(d.data[1][1] == Spy(49));
-            assertUnit(d.data[1][2] == Spy(59));
+            assertUnit(d.data[1][0] == Spy(28));
+            assertUnit(d.data[1][1] == Spy(31));
          }
-         assertUnit(d.data[2] == pFirstBlock);
-         if (d.data[2] == pFirstBlock)
+         assertUnit(d.data[2] == pFourthBlock);
+         if (d.data[2] == pFourthBlock)
          {
-            assertUnit(d.data[2][0] == Spy(67));
-            assertUnit(d.data[2][1] == Spy(79));
+            assertUnit(d.data[2][0] == Spy(49));
+            assertUnit(d.data[2][1] == Spy(59));
          }
-         assertUnit(d.data[3] == nullptr);
+         assertUnit(d.data[3] == pFirstBlock);
+         if (d.data[3] == pFirstBlock)
+            assertUnit(d.data[3][0] == Spy(67));
          assertUnit(d.data[4] == nullptr);
-         assertUnit(d.data[5] != nullptr);
-         if (d.data[5] != nullptr && d.numBlocks >= 4)
-            assertUnit(d.data[5][2] == Spy(99));
-
+         assertUnit(d.data[5] == nullptr);
+         assertUnit(d.data[6] == nullptr);
+         assertUnit(d.data[7] != nullptr);
+         if (d.data[7] != nullptr && d.numBlocks == 8)
+            assertUnit(d.data[7][1] == Spy(99));
       }
       // teardown
       teardownStandardFixture(d);
@@ -2059,27 +2698,22 @@ public:
    void test_pushfront_bigWrap()
    {  // setup
       //   iaFront
-      //   +----+----+----+
-      //   | 67 | 79 |    |
-      //   +----+----+----+
+      //   +----+----+----+----+
+      //   | 67 | 79 |    |    |
+      //   +----+----+----+----+
       //     | 
-      //   +----+----+----+----+----+----+----+
-      //   |    | // | // | // | // | // | // |
-      //   +----+----+----+----+----+----+----+
-      custom::deque<Spy> d;
-      d.numCells = 3;
+      //   +----+----+----+----+----+----+----+----+
+      //   |    | // | // | // | // | // | // | // |
+      //   +----+----+----+----+----+----+----+----+
+      Deque4 d;
       d.numElements = 2;
-      d.numBlocks = 7;
-      d.data = new Spy * [7];
+      d.numBlocks = 8;
+      d.data = allocateMap(d, 8);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.data[1] = nullptr;
-      d.data[2] = nullptr;
-      d.data[3] = nullptr;
-      d.data[4] = nullptr;
-      d.data[5] = nullptr;
-      d.data[6] = nullptr;
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
+      for (int ib = 1; ib < 8; ib++)
+         d.data[ib] = nullptr;
+      constructCell(d.alloc, &d.data[0][0], Spy(67));
+      constructCell(d.alloc, &d.data[0][1], Spy(79));
       d.iaFront = 0;
       Spy* pBlock = d.data[0];
       Spy s(99);
@@ -2096,18 +2730,18 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
-      //   iaFront
-      //   +----+----+----+    +----+----+----+
-      //   | 67 | 79 |    |    |    |    | 99 |
-      //   +----+----+----+    +----+----+----+
-      //     |                             |
-      //   +----+----+----+----+----+----+----+
-      //   |    | // | // | // | // | // |    |
-      //   +----+----+----+----+----+----+----+
+      //                                          iaFront
+      //   +----+----+----+----+    +----+----+----+----+
+      //   | 67 | 79 |    |    |    |    |    |    | 99 |
+      //   +----+----+----+----+    +----+----+----+----+
+      //     |                                       |
+      //   +----+----+----+----+----+----+----+----+
+      //   |    | // | // | // | // | // | // |    |
+      //   +----+----+----+----+----+----+----+----+
       assertUnit(d.numElements == 3);
-      assertUnit(d.iaFront == 20);
-      assertUnit(d.numBlocks == 7);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.iaFront == 31);
+      assertUnit(d.numBlocks == 8);
+      assertUnit(d.numCells == 4);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
@@ -2117,71 +2751,861 @@ public:
             assertUnit(d.data[0][0] == Spy(67));
             assertUnit(d.data[0][1] == Spy(79));
          }
-         assertUnit(d.data[1] == nullptr);
-         assertUnit(d.data[2] == nullptr);
-         assertUnit(d.data[3] == nullptr);
-         assertUnit(d.data[4] == nullptr);
-         assertUnit(d.data[5] == nullptr);
-         assertUnit(d.data[6] != nullptr);
-         if (d.data[6])
+         for (int ib = 1; ib < 7; ib++)
+            assertUnit(d.data[ib] == nullptr);
+         assertUnit(d.data[7] != nullptr);
+         if (d.data[7])
          {
-            assertUnit(d.data[6][2] == Spy(99));
+            assertUnit(d.data[7][3] == Spy(99));
          }
       }
       // teardown
       teardownStandardFixture(d);
    }
 
+   // the front block has room, so a full map does not reallocate
+   void test_pushfront_roomFullMap()
+   {  // setup
+      //        iaFront
+      //      +----+----+----+----+  +----+----+----+----+
+      //      |    | 31 | 49 | 55 |  | 67 | 79 | 85 | 91 |
+      //      +----+----+----+----+  +----+----+----+----+
+      //        |                      |
+      //      +----+----+
+      //      |    |    |
+      //      +----+----+
+      Deque4 d;
+      d.numElements = 7;
+      d.numBlocks = 2;
+      d.data = allocateMap(d, 2);
+      d.data[0] = d.alloc.allocate(d.numCells);
+      d.data[1] = d.alloc.allocate(d.numCells);
+      constructCell(d.alloc, &d.data[0][1], Spy(31));
+      constructCell(d.alloc, &d.data[0][2], Spy(49));
+      constructCell(d.alloc, &d.data[0][3], Spy(55));
+      constructCell(d.alloc, &d.data[1][0], Spy(67));
+      constructCell(d.alloc, &d.data[1][1], Spy(79));
+      constructCell(d.alloc, &d.data[1][2], Spy(85));
+      constructCell(d.alloc, &d.data[1][3], Spy(91));
+      d.iaFront = 1;
+      Spy** pMap = d.data;
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      d.push_front(s);
+      // verify
+      assertUnit(Spy::numCopy() == 1);       // copy 99
+      assertUnit(Spy::numAlloc() == 1);      // allocate 99
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //    iaFront
+      //      +----+----+----+----+  +----+----+----+----+
+      //      | 99 | 31 | 49 | 55 |  | 67 | 79 | 85 | 91 |
+      //      +----+----+----+----+  +----+----+----+----+
+      //        |                      |
+      //      +----+----+
+      //      |    |    |
+      //      +----+----+
+      assertUnit(d.numElements == 8);
+      assertUnit(d.numBlocks == 2);
+      assertUnit(d.iaFront == 0);
+      assertUnit(d.data == pMap);
+      if (d.data && d.data[0])
+         assertUnit(d.data[0][0] == Spy(99));
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // after the map grows at the back, the front grows into the same room
+   void test_pushfront_headroom()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d;
+      for (int i = 0; i < 9; i++)
+         d.push_back(i);
+      int** pMap = d.data;
+      // exercise
+      for (int i = -1; i >= -4; i--)
+         d.push_front(i);
+      // verify
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.data == pMap);
+      assertUnit(d.size() == 13);
+      for (int id = 0; id < 13 && id < (int)d.size(); id++)
+         assertUnit(d[id] == id - 4);
+   }  // teardown
+
    /***************************************
-    * POP FRONT
+    * EMPLACE
     ***************************************/
-   
-  
-   // remove one element from a standard fixture
-   void test_popfront_standard()
+
+   // construct an element in place at the back
+   void test_emplaceback_standard()
    {  // setup
-      //         iaFront
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy::reset();
       // exercise
-      d.pop_front();
+      Spy& s = d.emplace_back(99);
       // verify
-      assertUnit(Spy::numDelete() == 1);        // delete 31
-      assertUnit(Spy::numDestructor() == 1);    // destroy 31
+      assertUnit(Spy::numNondefault() == 1); // construct 99 in place
+      assertUnit(Spy::numAlloc() == 1);      // allocate 99
       assertUnit(Spy::numCopy() == 0);
-      assertUnit(Spy::numAlloc() == 0);      
-      assertUnit(Spy::numAssign() == 0);
-      assertUnit(Spy::numDefault() == 0);
-      assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //             iaFront
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    |    | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      assertUnit(d.numElements == 3);
-      assertUnit(d.iaFront == 5);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 | 99 |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      assertUnit(d.numElements == 5);
       assertUnit(d.data != nullptr);
-      if (d.data)
+      if (d.data && d.data[2])
       {
-         assertUnit(d.data[1] != nullptr);
+         assertUnit(&s == &d.data[2][2]);
+         assertUnit(d.data[2][2] == Spy(99));
+         destroyCell(d.alloc, &d.data[2][2]);
+         d.numElements = 4;
+      }
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // construct an element in place at the front
+   void test_emplacefront_standard()
+   {  // setup
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      Spy::reset();
+      // exercise
+      Spy& s = d.emplace_front(99);
+      // verify
+      assertUnit(Spy::numNondefault() == 1); // construct 99 in place
+      assertUnit(Spy::numAlloc() == 1);      // allocate 99
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    | 99 | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      assertUnit(d.numElements == 5);
+      assertUnit(d.iaFront == 5);
+      assertUnit(d.data != nullptr);
+      if (d.data && d.data[1] && d.numElements == 5)
+      {
+         assertUnit(&s == &d.data[1][1]);
+         assertUnit(d.data[1][1] == Spy(99));
+         destroyCell(d.alloc, &d.data[1][1]);
+         d.numElements = 4;
+         d.iaFront = 6;
+      }
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   /***************************************
+    * APPEND
+    ***************************************/
+
+   // append a range to an empty deque
+   void test_append_empty()
+   {  // setup
+      custom::deque<Spy> d;
+      std::vector<Spy> v = { Spy(11), Spy(26), Spy(31) };
+      Spy::reset();
+      // exercise
+      d.append(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 3);       // copy 11, 26, 31
+      assertUnit(Spy::numAlloc() == 3);      // allocate 11, 26, 31
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      //    iaFront
+      //    +----+----+----+----+--..--+
+      //    | 11 | 26 | 31 |    |      |
+      //    +----+----+----+----+--..--+
+      //        |
+      //     +----+
+      //     |    |
+      //     +----+
+      assertUnit(d.numElements == 3);
+      assertUnit(d.numBlocks == 1);
+      assertUnit(d.iaFront == 0);
+      assertUnit(d.data != nullptr);
+      if (d.data && d.data[0])
+      {
+         assertUnit(d.data[0][0] == Spy(11));
+         assertUnit(d.data[0][1] == Spy(26));
+         assertUnit(d.data[0][2] == Spy(31));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // append enough to the standard fixture that the map grows once
+   void test_append_standard()
+   {  // setup
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      std::vector<Spy> v = { Spy(71), Spy(72), Spy(73), Spy(74), Spy(75), Spy(76),
+                             Spy(77), Spy(78), Spy(79), Spy(80), Spy(81), Spy(82) };
+      Spy* pFirstBlock = d.data[1];
+      Spy* pSecondBlock = d.data[2];
+      Spy::reset();
+      // exercise
+      d.append(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 12);      // copy 71 ... 82
+      assertUnit(Spy::numAlloc() == 12);     // allocate 71 ... 82
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      //      0    1    2    3       0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 | 71 | 72 |  | 73 | 74 | 75 | 76 |  ...
+      //    +----+----+----+----+  +----+----+----+----+  +----+----+----+----+
+      //               |          /          __________/
+      //            +----+----+----+----+----+----+----+----+
+      //            |    |    |    |    |    | // | // | // |
+      //            +----+----+----+----+----+----+----+----+
+      assertUnit(d.numElements == 16);
+      assertUnit(d.numBlocks == 8);
+      assertUnit(d.numCells == 4);
+      assertUnit(d.iaFront == 2);
+      assertUnit(d.data != nullptr);
+      if (d.data && d.numBlocks == 8)
+      {
+         assertUnit(d.data[0] == pFirstBlock);
+         assertUnit(d.data[1] == pSecondBlock);
+         assertUnit(d.data[5] == nullptr);
+      }
+      int expected[] = { 31, 49, 55, 67, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82 };
+      for (int id = 0; id < 16 && id < (int)d.numElements; id++)
+         assertUnit(d[id] == Spy(expected[id]));
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // fill into the partial back block and one new block
+   void test_append_fillStandard()
+   {  // setup
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      d.append(4, s);
+      // verify
+      assertUnit(Spy::numCopy() == 4);       // copy 99 four times
+      assertUnit(Spy::numAlloc() == 4);      // allocate 99 four times
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //      0    1    2    3       0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 | 99 | 99 |  | 99 | 99 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+  +----+----+----+----+
+      //                    \        /          ________/
+      //               +----+----+----+----+
+      //               | // |    |    |    |
+      //               +----+----+----+----+
+      assertUnit(d.numElements == 8);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.iaFront == 6);
+      assertUnit(d.data != nullptr);
+      if (d.data)
+      {
+         assertUnit(d.data[0] == nullptr);
+         assertUnit(d.data[3] != nullptr);
+         if (d.data[2] && d.data[3])
+         {
+            assertUnit(d.data[2][2] == Spy(99));
+            assertUnit(d.data[2][3] == Spy(99));
+            assertUnit(d.data[3][0] == Spy(99));
+            assertUnit(d.data[3][1] == Spy(99));
+         }
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // a trivially copyable range goes in a block at a time
+   void test_append_trivial()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d;
+      d.push_back(3);
+      d.push_front(2);
+      d.push_front(1);
+      int values[11] = { 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+      // exercise
+      d.append(values, values + 11);
+      // verify
+      assertUnit(d.size() == 14);
+      for (int id = 0; id < 14; id++)
+         assertUnit(d[id] == id + 1);
+   }  // teardown
+
+   // strings and arrays are contiguous, so their runs go in whole
+   void test_append_contiguous()
+   {  // setup
+      custom::deque<char, std::allocator<char>, 4> d;
+      d.push_back('a');
+      std::string s = "bcdefghij";
+      std::array<char, 3> a = { 'k', 'l', 'm' };
+      // exercise
+      d.append(s.begin(), s.end());
+      d.append(a.cbegin(), a.cend());
+      // verify
+      assertUnit((custom::is_contiguous<std::string::iterator, char>::value));
+      assertUnit((custom::is_contiguous<std::string::const_iterator, char>::value));
+      assertUnit((custom::is_contiguous<std::array<char, 3>::const_iterator, char>::value));
+      assertUnit(!(custom::is_contiguous<std::list<char>::iterator, char>::value));
+      assertUnit(d.size() == 13);
+      for (int id = 0; id < 13 && id < (int)d.size(); id++)
+         assertUnit(d[id] == 'a' + id);
+   }  // teardown
+
+   // a single-pass range falls back on push_back
+   void test_append_inputIterator()
+   {  // setup
+      custom::deque<int> d;
+      d.push_back(1);
+      std::istringstream in("2 3 4 5");
+      // exercise
+      d.append(std::istream_iterator<int>(in), std::istream_iterator<int>());
+      // verify
+      assertUnit(d.size() == 5);
+      for (int id = 0; id < 5 && id < (int)d.size(); id++)
+         assertUnit(d[id] == id + 1);
+   }  // teardown
+
+   // a copy that throws partway through a block leaves no orphaned cells
+   void test_append_copyThrows()
+   {  // setup
+      int numLive = CopyThrower::numLive();
+      {
+         custom::deque<CopyThrower, std::allocator<CopyThrower>, 4> d;
+         d.push_back(CopyThrower(1));
+         std::vector<CopyThrower> v = { 2, 3, 4, 5, 6, 7 };
+         CopyThrower::copiesLeft() = 4;
+         bool thrown = false;
+         // exercise
+         try
+         {
+            d.append(v.begin(), v.end());
+         }
+         catch (const std::runtime_error&)
+         {
+            thrown = true;
+         }
+         CopyThrower::copiesLeft() = -1;
+         // verify
+         assertUnit(thrown);
+         assertUnit(d.size() == 4);
+         for (int id = 0; id < 4 && id < (int)d.size(); id++)
+            assertUnit(d[id].value == id + 1);
+         assertUnit(CopyThrower::numLive() == numLive + (int)(v.size() + d.size()));
+      }
+      assertUnit(CopyThrower::numLive() == numLive);
+   }  // teardown
+
+   // a fill that throws partway through keeps the copies it made
+   void test_append_fillCopyThrows()
+   {  // setup
+      int numLive = CopyThrower::numLive();
+      {
+         custom::deque<CopyThrower, std::allocator<CopyThrower>, 4> d;
+         d.push_back(CopyThrower(1));
+         CopyThrower t(9);
+         CopyThrower::copiesLeft() = 5;
+         bool thrown = false;
+         // exercise
+         try
+         {
+            d.append(8, t);
+         }
+         catch (const std::runtime_error&)
+         {
+            thrown = true;
+         }
+         CopyThrower::copiesLeft() = -1;
+         // verify
+         assertUnit(thrown);
+         assertUnit(d.size() == 6);
+         assertUnit(CopyThrower::numLive() == numLive + 1 + (int)d.size());
+      }
+      assertUnit(CopyThrower::numLive() == numLive);
+   }  // teardown
+
+   // the blocks set up past a throwing copy are not lost when the map grows
+   void test_append_copyThrowsThenGrow()
+   {  // setup
+      numBytesOutstanding() = 0;
+      {
+         custom::deque<CopyThrower, CountingAllocator<CopyThrower>, 4> d;
+         d.push_back(CopyThrower(1));
+         std::vector<CopyThrower> v(20, CopyThrower(2));
+         CopyThrower::copiesLeft() = 5;
+         try
+         {
+            d.append(v.begin(), v.end());
+         }
+         catch (const std::runtime_error&)
+         {
+         }
+         CopyThrower::copiesLeft() = -1;
+         std::vector<CopyThrower> vMore(1000, CopyThrower(3));
+         // exercise
+         d.append(vMore.begin(), vMore.end());
+         // verify
+         assertUnit(d.size() == 1004);
+      }
+      assertUnit(numBytesOutstanding() == 0);
+   }  // teardown
+
+   /***************************************
+    * PREPEND
+    ***************************************/
+
+   // prepend a range to an empty deque
+   void test_prepend_empty()
+   {  // setup
+      custom::deque<Spy> d;
+      std::vector<Spy> v = { Spy(11), Spy(26), Spy(31) };
+      Spy::reset();
+      // exercise
+      d.prepend(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 3);       // copy 11, 26, 31
+      assertUnit(Spy::numAlloc() == 3);      // allocate 11, 26, 31
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      //                         iaFront
+      //    +--..--+----+----+----+----+
+      //    |      |    | 11 | 26 | 31 |
+      //    +--..--+----+----+----+----+
+      //                       |
+      //                    +----+
+      //                    |    |
+      //                    +----+
+      assertUnit(d.numElements == 3);
+      assertUnit(d.numBlocks == 1);
+      assertUnit(d.iaFront == 13);
+      assertUnit(d.data != nullptr);
+      if (d.data && d.numBlocks == 1 && d.data[0])
+      {
+         assertUnit(d.data[0][13] == Spy(11));
+         assertUnit(d.data[0][14] == Spy(26));
+         assertUnit(d.data[0][15] == Spy(31));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // prepend into the front block and the block before it
+   void test_prepend_standard()
+   {  // setup
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      std::vector<Spy> v = { Spy(11), Spy(26) };
+      Spy::reset();
+      // exercise
+      d.prepend(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 2);       // copy 11, 26
+      assertUnit(Spy::numAlloc() == 2);      // allocate 11, 26
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 11 | 26 | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      assertUnit(d.numElements == 6);
+      assertUnit(d.numBlocks == 4);
+      assertUnit(d.numCells == 4);
+      assertUnit(d.iaFront == 4);
+      assertUnit(d.data != nullptr);
+      if (d.data && d.data[1])
+      {
+         assertUnit(d.data[0] == nullptr);
+         assertUnit(d.data[1][0] == Spy(11));
+         assertUnit(d.data[1][1] == Spy(26));
+         assertUnit(d.data[1][2] == Spy(31));
+      }
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // a trivially copyable range across several blocks keeps its order
+   void test_prepend_trivial()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d;
+      d.push_back(12);
+      d.push_back(13);
+      d.push_front(11);
+      int values[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+      // exercise
+      d.prepend(values, values + 10);
+      // verify
+      assertUnit(d.size() == 13);
+      for (int id = 0; id < 13; id++)
+         assertUnit(d[id] == id + 1);
+      d.prepend(values, values + 3);
+      assertUnit(d.size() == 16);
+      assertUnit(d[0] == 1 && d[2] == 3 && d[3] == 1 && d[15] == 13);
+   }  // teardown
+
+   // a forward-only range is staged first
+   void test_prepend_forwardIterator()
+   {  // setup
+      custom::deque<int> d;
+      d.push_back(5);
+      std::forward_list<int> l = { 1, 2, 3, 4 };
+      // exercise
+      d.prepend(l.begin(), l.end());
+      // verify
+      assertUnit(d.size() == 5);
+      for (int id = 0; id < 5 && id < (int)d.size(); id++)
+         assertUnit(d[id] == id + 1);
+   }  // teardown
+
+   // a copy that throws partway through a block leaves no orphaned cells
+   void test_prepend_copyThrows()
+   {  // setup
+      int numLive = CopyThrower::numLive();
+      {
+         custom::deque<CopyThrower, std::allocator<CopyThrower>, 4> d;
+         d.push_back(CopyThrower(10));
+         std::vector<CopyThrower> v = { 4, 5, 6, 7, 8, 9 };
+         CopyThrower::copiesLeft() = 4;
+         bool thrown = false;
+         // exercise
+         try
+         {
+            d.prepend(v.begin(), v.end());
+         }
+         catch (const std::runtime_error&)
+         {
+            thrown = true;
+         }
+         CopyThrower::copiesLeft() = -1;
+         // verify
+         assertUnit(thrown);
+         assertUnit(d.size() > 1 && d.size() < 7);
+         for (int id = 0; id < (int)d.size(); id++)
+            assertUnit(d[id].value == (int)(11 - d.size()) + id);
+         assertUnit(CopyThrower::numLive() == numLive + (int)(v.size() + d.size()));
+      }
+      assertUnit(CopyThrower::numLive() == numLive);
+   }  // teardown
+
+   // the block set up for a throwing run is not lost when the map grows
+   void test_prepend_copyThrowsThenGrow()
+   {  // setup
+      numBytesOutstanding() = 0;
+      {
+         custom::deque<CopyThrower, CountingAllocator<CopyThrower>, 4> d;
+         d.push_back(CopyThrower(1));
+         std::vector<CopyThrower> v(20, CopyThrower(2));
+         CopyThrower::copiesLeft() = 5;
+         try
+         {
+            d.prepend(v.begin(), v.end());
+         }
+         catch (const std::runtime_error&)
+         {
+         }
+         CopyThrower::copiesLeft() = -1;
+         size_t numKept = d.size();
+         std::vector<CopyThrower> vMore(1000, CopyThrower(3));
+         // exercise
+         d.prepend(vMore.begin(), vMore.end());
+         // verify
+         assertUnit(d.size() == numKept + 1000);
+      }
+      assertUnit(numBytesOutstanding() == 0);
+   }  // teardown
+
+   /***************************************
+    * SPLICE
+    ***************************************/
+
+   // an empty deque takes other's map as it is
+   void test_spliceback_empty()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d;
+      custom::deque<int, std::allocator<int>, 4> other;
+      for (int i = 0; i < 10; i++)
+         other.push_back(i);
+      int** dataOther = other.data;
+      // exercise
+      d.splice_back(other);
+      // verify
+      assertUnit(d.data == dataOther);
+      assertUnit(d.size() == 10);
+      for (int id = 0; id < 10; id++)
+         assertUnit(d[id] == id);
+      assertUnit(other.empty());
+   }  // teardown
+
+   // other's front lines up with our back: its blocks change hands
+   void test_spliceback_wholeBlocks()
+   {  // setup
+      //   d                  other
+      //   +---+---+---+---+  +---+---+---+---+   +---+---+---+---+
+      //   | 0 | 1 | 2 | 3 |  | 4 | 5 | 6 | 7 |   | 8 | 9 |   |   |
+      //   +---+---+---+---+  +---+---+---+---+   +---+---+---+---+
+      custom::deque<int, std::allocator<int>, 4> d;
+      custom::deque<int, std::allocator<int>, 4> other;
+      for (int i = 0; i < 4; i++)
+         d.push_back(i);
+      for (int i = 4; i < 10; i++)
+         other.push_back(i);
+      int* pBlock0 = other.data[other.ibFromID(0)];
+      int* pBlock1 = other.data[other.ibFromID(4)];
+      // exercise
+      d.splice_back(other);
+      // verify
+      assertUnit(d.size() == 10);
+      for (int id = 0; id < 10; id++)
+         assertUnit(d[id] == id);
+      assertUnit(d.data[d.ibFromID(4)] == pBlock0);
+      assertUnit(d.data[d.ibFromID(8)] == pBlock1);
+      assertUnit(other.empty());
+      assertUnit(other.data[0] == nullptr && other.data[1] == nullptr);
+   }  // teardown
+
+   // only the cells of the edge block are moved
+   void test_spliceback_edgeMoves()
+   {  // setup
+      custom::deque<Spy> d;
+      custom::deque<Spy> other;
+      for (int i = 0; i < 3; i++)
+      {
+         d.push_back(Spy(i));
+         other.push_back(Spy(-1));
+      }
+      for (int i = 3; i < 23; i++)
+         other.push_back(Spy(i));
+      for (int i = 0; i < 3; i++)
+         other.pop_front();
+      Spy* pBlock = other.data[other.ibFromID(13)];
+      Spy::reset();
+      // exercise
+      d.splice_back(other);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 13);  // 3 through 15
+      assertUnit(Spy::numDestructor() == 13);
+      assertUnit(d.size() == 23);
+      for (int id = 0; id < 23; id++)
+         assertUnit(d[id] == Spy(id));
+      assertUnit(d.data[d.ibFromID(16)] == pBlock);
+      assertUnit(other.empty());
+   }  // teardown
+
+   // the cells do not line up: the smaller side is moved over
+   void test_spliceback_misaligned()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d;
+      custom::deque<int, std::allocator<int>, 4> other;
+      for (int i = 0; i < 3; i++)
+         d.push_back(i);
+      for (int i = 3; i < 13; i++)
+         other.push_back(i);
+      int* pBlock = other.data[other.ibFromID(4)];
+      // exercise
+      d.splice_back(other);
+      // verify
+      assertUnit(d.size() == 13);
+      for (int id = 0; id < 13; id++)
+         assertUnit(d[id] == id);
+      assertUnit(d.data[d.ibFromID(7)] == pBlock);
+      assertUnit(other.empty());
+   }  // teardown
+
+   // other's back lines up with our front: its blocks change hands
+   void test_splicefront_wholeBlocks()
+   {  // setup
+      //   other                                  d
+      //   +---+---+---+---+   +---+---+---+---+  +---+---+---+---+
+      //   |   |   | 0 | 1 |   | 2 | 3 | 4 | 5 |  | 6 | 7 | 8 | 9 |
+      //   +---+---+---+---+   +---+---+---+---+  +---+---+---+---+
+      custom::deque<int, std::allocator<int>, 4> d;
+      custom::deque<int, std::allocator<int>, 4> other;
+      for (int i = 6; i < 10; i++)
+         d.push_back(i);
+      for (int i = 5; i >= 0; i--)
+         other.push_front(i);
+      int* pBlock0 = other.data[other.ibFromID(0)];
+      int* pBlock1 = other.data[other.ibFromID(2)];
+      // exercise
+      d.splice_front(other);
+      // verify
+      assertUnit(d.size() == 10);
+      for (int id = 0; id < 10; id++)
+         assertUnit(d[id] == id);
+      assertUnit(d.data[d.ibFromID(0)] == pBlock0);
+      assertUnit(d.data[d.ibFromID(2)] == pBlock1);
+      assertUnit(d.icFromID(0) == 2);
+      assertUnit(other.empty());
+   }  // teardown
+
+   // our front block is filled from other's back block first
+   void test_splicefront_edge()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d;
+      custom::deque<int, std::allocator<int>, 4> other;
+      d.push_back(-1);
+      d.push_back(-1);
+      for (int i = 6; i < 12; i++)
+         d.push_back(i);
+      d.pop_front();
+      d.pop_front();
+      for (int i = 0; i < 6; i++)
+         other.push_back(i);
+      int* pBlock = other.data[other.ibFromID(0)];
+      // exercise
+      d.splice_front(other);
+      // verify
+      assertUnit(d.size() == 12);
+      for (int id = 0; id < 12; id++)
+         assertUnit(d[id] == id);
+      assertUnit(d.data[d.ibFromID(0)] == pBlock);
+      assertUnit(other.empty());
+   }  // teardown
+
+   // splicing a deque onto itself does nothing
+   void test_splice_self()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d;
+      for (int i = 0; i < 6; i++)
+         d.push_back(i);
+      // exercise
+      d.splice_back(d);
+      d.splice_front(d);
+      // verify
+      assertUnit(d.size() == 6);
+      for (int id = 0; id < 6; id++)
+         assertUnit(d[id] == id);
+   }  // teardown
+
+   /***************************************
+    * POP FRONT
+    ***************************************/
+   
+  
+   // remove one element from a standard fixture
+   void test_popfront_standard()
+   {  // setup
+      //         iaFront
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      Spy::reset();
+      // exercise
+      d.pop_front();
+      // verify
+      assertUnit(Spy::numDelete() == 1);        // delete 31
+      assertUnit(Spy::numDestructor() == 1);    // destroy 31
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);      
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numNondefault() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      //                   iaFront
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    |    | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      assertUnit(d.numElements == 3);
+      assertUnit(d.iaFront == 7);
+      assertUnit(d.data != nullptr);
+      if (d.data)
+      {
+         assertUnit(d.data[1] != nullptr);
          if (d.data[1])
          {
-            d.alloc.construct(&d.data[1][1], Spy(31));
+            constructCell(d.alloc, &d.data[1][2], Spy(31));
             d.iaFront--;
             d.numElements++;
          }
@@ -2203,15 +3627,14 @@ public:
       //            +----+
       //            |    |
       //            +----+
-      custom::deque<Spy> d;
-      d.numCells = 4;
+      Deque4 d;
       d.numElements = 3;
       d.numBlocks = 1;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][3], Spy(11));
-      d.alloc.construct(&d.data[0][0], Spy(28));
-      d.alloc.construct(&d.data[0][1], Spy(31));
+      constructCell(d.alloc, &d.data[0][3], Spy(11));
+      constructCell(d.alloc, &d.data[0][0], Spy(28));
+      constructCell(d.alloc, &d.data[0][1], Spy(31));
       Spy* pBlock = d.data[0];
       d.iaFront = 3;
       Spy::reset();
@@ -2265,13 +3688,12 @@ public:
       //            +----+
       //            |    |
       //            +----+
-      custom::deque<Spy> d;
-      d.numCells = 4;
+      Deque4 d;
       d.numElements = 1;
       d.numBlocks = 1;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][1], Spy(31));
+      constructCell(d.alloc, &d.data[0][1], Spy(31));
       d.iaFront = 1;
       Spy::reset();
       // exercise
@@ -2303,18 +3725,18 @@ public:
    // remove last element from a block, but there are other blocks
    void test_popfront_lastInBlock()
    {  // setup
-      //         iaFront
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    |    | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //                   iaFront
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    |    | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
-      d.alloc.destroy(&d.data[1][1]);
+      destroyCell(d.alloc, &d.data[1][2]);
       d.iaFront++;
       d.numElements--;
       Spy::reset();
@@ -2330,19 +3752,19 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //             iaFront
-      //                         0    1    2
-      //                      +----+----+----+
-      //                      | 55 | 67 |    |
-      //                      +----+----+----+
-      //                        /
-      //          +----+----+----+----+
-      //          | // | // |    | // |
-      //          +----+----+----+----+
+      //                        iaFront
+      //                           0    1    2    3
+      //                         +----+----+----+----+
+      //                         | 55 | 67 |    |    |
+      //                         +----+----+----+----+
+      //                          /
+      //               +----+----+----+----+
+      //               | // | // |    | // |
+      //               +----+----+----+----+
       assertUnit(d.numElements == 2);
-      assertUnit(d.iaFront == 6);
+      assertUnit(d.iaFront == 8);
       assertUnit(d.numBlocks == 4);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numCells == 4);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
@@ -2363,30 +3785,26 @@ public:
    // pretty much the worst case scenario
    void test_popfront_complex()
    {  // setup
-      //                                iaFront
-      //   +----+----+----+    +----+----+----+
-      //   | 67 | 79 |    |    |    |    | 59 |
-      //   +----+----+----+    +----+----+----+
-      //     |                             |
-      //   +----+----+----+----+----+----+----+
-      //   |    | // | // | // | // | // |    |
-      //   +----+----+----+----+----+----+----+
-      custom::deque<Spy> d;
-      d.numCells = 3;
+      //                                          iaFront
+      //   +----+----+----+----+    +----+----+----+----+
+      //   | 67 | 79 |    |    |    |    |    |    | 59 |
+      //   +----+----+----+----+    +----+----+----+----+
+      //     |                                       |
+      //   +----+----+----+----+----+----+----+----+
+      //   |    | // | // | // | // | // | // |    |
+      //   +----+----+----+----+----+----+----+----+
+      Deque4 d;
       d.numElements = 3;
-      d.numBlocks = 7;
-      d.data = new Spy * [7];
+      d.numBlocks = 8;
+      d.data = allocateMap(d, 8);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.data[1] = nullptr;
-      d.data[2] = nullptr;
-      d.data[3] = nullptr;
-      d.data[4] = nullptr;
-      d.data[5] = nullptr;
-      d.data[6] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[6][2], Spy(59));
-      d.alloc.construct(&d.data[0][0], Spy(67));
-      d.alloc.construct(&d.data[0][1], Spy(79));
-      d.iaFront = 20;
+      for (int ib = 1; ib < 7; ib++)
+         d.data[ib] = nullptr;
+      d.data[7] = d.alloc.allocate(d.numCells);
+      constructCell(d.alloc, &d.data[7][3], Spy(59));
+      constructCell(d.alloc, &d.data[0][0], Spy(67));
+      constructCell(d.alloc, &d.data[0][1], Spy(79));
+      d.iaFront = 31;
       Spy* pBlock = d.data[0];
       Spy::reset();
       // exercise
@@ -2402,17 +3820,17 @@ public:
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       //   iaFront
-      //   +----+----+----+
-      //   | 67 | 79 |    |
-      //   +----+----+----+
-      //     |             
-      //   +----+----+----+----+----+----+----+
-      //   |    | // | // | // | // | // | // |
-      //   +----+----+----+----+----+----+----+
+      //   +----+----+----+----+
+      //   | 67 | 79 |    |    |
+      //   +----+----+----+----+
+      //     |
+      //   +----+----+----+----+----+----+----+----+
+      //   |    | // | // | // | // | // | // | // |
+      //   +----+----+----+----+----+----+----+----+
       assertUnit(d.numElements == 2);
       assertUnit(d.iaFront == 0);
-      assertUnit(d.numBlocks == 7);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numBlocks == 8);
+      assertUnit(d.numCells == 4);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
@@ -2422,17 +3840,59 @@ public:
             assertUnit(d.data[0][0] == Spy(67));
             assertUnit(d.data[0][1] == Spy(79));
          }
-         assertUnit(d.data[1] == nullptr);
-         assertUnit(d.data[2] == nullptr);
-         assertUnit(d.data[3] == nullptr);
-         assertUnit(d.data[4] == nullptr);
-         assertUnit(d.data[5] == nullptr);
-         assertUnit(d.data[6] == nullptr);
+         for (int ib = 1; ib < 8; ib++)
+            assertUnit(d.data[ib] == nullptr);
       }
       // teardown
       teardownStandardFixture(d);
    }
 
+   // the emptied block is kept and the next new block reuses it
+   void test_popfront_spareBlock()
+   {  // setup
+      custom::deque<Spy> d;
+      d.push_back(Spy(99));
+      Spy* pBlock = d.data[0];
+      Spy::reset();
+      // exercise
+      d.pop_front();
+      // verify
+      assertUnit(Spy::numDestructor() == 1); // destroy 99
+      assertUnit(Spy::numDelete() == 1);     // delete 99
+      assertUnit(d.numElements == 0);
+      assertUnit(d.data[0] == nullptr);
+      assertUnit(d.numSpare == 1);
+      assertUnit(d.spare[0] == pBlock);
+      d.push_back(Spy(88));
+      assertUnit(d.numSpare == 0);
+      assertUnit(d.data[d.ibFromID(0)] == pBlock);
+   }  // teardown
+
+   // a queue that holds steady at one depth does not allocate blocks
+   void test_popfront_steadyState()
+   {  // setup
+      custom::deque<Spy, CountingAllocator<Spy>> d;
+      for (int i = 0; i < 40; i++)
+         d.push_back(Spy(i));
+      for (int i = 40; i < 100; i++)
+      {  // let the map settle at its final size
+         d.push_back(Spy(i));
+         d.pop_front();
+      }
+      numAllocations() = 0;
+      // exercise
+      for (int i = 100; i < 1040; i++)
+      {
+         d.push_back(Spy(i));
+         d.pop_front();
+      }
+      // verify
+      assertUnit(numAllocations() == 0);
+      assertUnit(d.size() == 40);
+      assertUnit(d.front() == Spy(1000));
+      assertUnit(d.back() == Spy(1039));
+   }  // teardown
+
    /***************************************
     * POP BACK
     ***************************************/
@@ -2441,15 +3901,15 @@ public:
    void test_popback_standard()
    {  // setup
       //         iaFront
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy::reset();
       // exercise
@@ -2465,14 +3925,14 @@ public:
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       //             iaFront
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 |    |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 |    |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(d.numElements == 3);
       assertUnit(d.data != nullptr);
       if (d.data)
@@ -2480,7 +3940,7 @@ public:
          assertUnit(d.data[2] != nullptr);
          if (d.data[2])
          {
-            d.alloc.construct(&d.data[2][1], Spy(67));
+            constructCell(d.alloc, &d.data[2][1], Spy(67));
             d.numElements++;
          }
       }
@@ -2501,14 +3961,13 @@ public:
       //            +----+
       //            |    |
       //            +----+
-      custom::deque<Spy> d;
-      d.numCells = 4;
+      Deque4 d;
       d.numElements = 2;
       d.numBlocks = 1;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][2], Spy(11));
-      d.alloc.construct(&d.data[0][3], Spy(28));
+      constructCell(d.alloc, &d.data[0][2], Spy(11));
+      constructCell(d.alloc, &d.data[0][3], Spy(28));
       Spy* pBlock = d.data[0];
       d.iaFront = 2;
       Spy::reset();
@@ -2561,13 +4020,12 @@ public:
       //            +----+
       //            |    |
       //            +----+
-      custom::deque<Spy> d;
-      d.numCells = 4;
+      Deque4 d;
       d.numElements = 1;
       d.numBlocks = 1;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][1], Spy(31));
+      constructCell(d.alloc, &d.data[0][1], Spy(31));
       d.iaFront = 1;
       Spy::reset();
       // exercise
@@ -2599,18 +4057,18 @@ public:
    // remove last element from a block, but there are other blocks
    void test_popback_lastInBlock()
    {  // setup
-      //         iaFront
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 |    |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //              iaFront
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 |    |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
-      d.alloc.destroy(&d.data[2][1]);
+      destroyCell(d.alloc, &d.data[2][1]);
       d.numElements--;
       Spy::reset();
       // exercise
@@ -2625,19 +4083,19 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //         iaFront
-      //      0     1    2    
-      //    +----+----+----+  
-      //    |    | 31 | 49 |  
-      //    +----+----+----+  
-      //                 |
-      //          +----+----+----+----+
-      //          | // |    | // | // |
-      //          +----+----+----+----+
+      //              iaFront
+      //      0    1    2    3
+      //    +----+----+----+----+
+      //    |    |    | 31 | 49 |
+      //    +----+----+----+----+
+      //                    |
+      //               +----+----+----+----+
+      //               | // |    | // | // |
+      //               +----+----+----+----+
       assertUnit(d.numElements == 2);
-      assertUnit(d.iaFront == 4);
+      assertUnit(d.iaFront == 6);
       assertUnit(d.numBlocks == 4);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numCells == 4);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
@@ -2645,8 +4103,8 @@ public:
          assertUnit(d.data[1] != nullptr);
          if (d.data[1])
          {
-            assertUnit(d.data[1][1] == Spy(31));
-            assertUnit(d.data[1][2] == Spy(49));
+            assertUnit(d.data[1][2] == Spy(31));
+            assertUnit(d.data[1][3] == Spy(49));
          }
          assertUnit(d.data[2] == nullptr);
          assertUnit(d.data[3] == nullptr);
@@ -2658,31 +4116,27 @@ public:
    // pretty much the worst case scenario
    void test_popback_complex()
    {  // setup
-      //                            iaFront
-      //   +----+----+----+    +----+----+----+
-      //   | 79 |    |    |    |    | 59 | 67 |
-      //   +----+----+----+    +----+----+----+
-      //     |                             |
-      //   +----+----+----+----+----+----+----+
-      //   |    | // | // | // | // | // |    |
-      //   +----+----+----+----+----+----+----+
-      custom::deque<Spy> d;
-      d.numCells = 3;
+      //                                     iaFront
+      //   +----+----+----+----+    +----+----+----+----+
+      //   | 79 |    |    |    |    |    |    | 59 | 67 |
+      //   +----+----+----+----+    +----+----+----+----+
+      //     |                                       |
+      //   +----+----+----+----+----+----+----+----+
+      //   |    | // | // | // | // | // | // |    |
+      //   +----+----+----+----+----+----+----+----+
+      Deque4 d;
       d.numElements = 3;
-      d.numBlocks = 7;
-      d.data = new Spy * [7];
+      d.numBlocks = 8;
+      d.data = allocateMap(d, 8);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.data[1] = nullptr;
-      d.data[2] = nullptr;
-      d.data[3] = nullptr;
-      d.data[4] = nullptr;
-      d.data[5] = nullptr;
-      d.data[6] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[6][1], Spy(59));
-      d.alloc.construct(&d.data[6][2], Spy(67));
-      d.alloc.construct(&d.data[0][0], Spy(79));
-      d.iaFront = 19;
-      Spy* pBlock = d.data[6];
+      for (int ib = 1; ib < 7; ib++)
+         d.data[ib] = nullptr;
+      d.data[7] = d.alloc.allocate(d.numCells);
+      constructCell(d.alloc, &d.data[7][2], Spy(59));
+      constructCell(d.alloc, &d.data[7][3], Spy(67));
+      constructCell(d.alloc, &d.data[0][0], Spy(79));
+      d.iaFront = 30;
+      Spy* pBlock = d.data[7];
       Spy::reset();
       // exercise
       d.pop_back();
@@ -2696,39 +4150,65 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //   iaFront
-      //                            iaFront
-      //                       +----+----+----+
-      //                       |    | 59 | 67 |
-      //                       +----+----+----+
-      //                                   |
-      //   +----+----+----+----+----+----+----+
-      //   | // | // | // | // | // | // |    |
-      //   +----+----+----+----+----+----+----+
+      //                                     iaFront
+      //                            +----+----+----+----+
+      //                            |    |    | 59 | 67 |
+      //                            +----+----+----+----+
+      //                                             |
+      //   +----+----+----+----+----+----+----+----+
+      //   | // | // | // | // | // | // | // |    |
+      //   +----+----+----+----+----+----+----+----+
       assertUnit(d.numElements == 2);
-      assertUnit(d.iaFront == 19);
-      assertUnit(d.numBlocks == 7);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.iaFront == 30);
+      assertUnit(d.numBlocks == 8);
+      assertUnit(d.numCells == 4);
       assertUnit(d.data != nullptr);
       if (d.data)
       {
-         assertUnit(d.data[0] == nullptr);
-         assertUnit(d.data[1] == nullptr);
-         assertUnit(d.data[2] == nullptr);
-         assertUnit(d.data[3] == nullptr);
-         assertUnit(d.data[4] == nullptr);
-         assertUnit(d.data[5] == nullptr);
-         assertUnit(d.data[6] == pBlock);
-         if (d.data[6])
+         for (int ib = 0; ib < 7; ib++)
+            assertUnit(d.data[ib] == nullptr);
+         assertUnit(d.data[7] == pBlock);
+         if (d.data[7])
          {
-            assertUnit(d.data[6][1] == Spy(59));
-            assertUnit(d.data[6][2] == Spy(67));
+            assertUnit(d.data[7][2] == Spy(59));
+            assertUnit(d.data[7][3] == Spy(67));
          }
       }
       // teardown
       teardownStandardFixture(d);
    }
 
+   // dropping a run destroys each element and releases the emptied blocks
+   void test_dropfront_acrossBlocks()
+   {  // setup
+      //    iaFront
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      Spy* pBlock1 = d.data[1];
+      Spy::reset();
+      // exercise
+      d.drop_front(3);
+      // verify
+      //                              iaFront
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    |    |    |  |    | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      assertUnit(Spy::numDelete() == 3);        // delete 31, 49, 55
+      assertUnit(Spy::numDestructor() == 3);    // destroy 31, 49, 55
+      assertUnit(d.numElements == 1);
+      assertUnit(d.iaFront == 9);
+      assertUnit(d.data[1] == nullptr);
+      assertUnit(d.numSpare == std::min<size_t>(1, DEQUE_SPARE_BLOCKS));
+      if (d.numSpare)
+         assertUnit(d.spare[0] == pBlock1);
+      assertUnit(d.front() == Spy(67));
+      // teardown
+      teardownStandardFixture(d);
+   }
+
 
    /***************************************
     * BACK
@@ -2737,15 +4217,15 @@ public:
    // read an element from the back of the standard fixture
    void test_back_readStandard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy s(99);
       Spy::reset();
@@ -2770,28 +4250,27 @@ public:
    // read an element from the back of a deque that is wrapped
    void test_back_readWrapped()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 55 | 67 |    |  |    | 31 | 49 |
-      //    +----+----+----+  +----+----+----+
-      //          \                  /
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 55 | 67 |    |    |  |    |    | 31 | 49 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //          \                       /
       //          +----+----+----+----+
       //          |    | // | // |    |
       //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4 d;
       d.numBlocks = 4;
-      d.numCells = 3;
       d.numElements = 4;
-      d.iaFront = 10;
-      d.data = new Spy * [d.numBlocks];
+      d.iaFront = 14;
+      d.data = allocateMap(d, d.numBlocks);
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][1], Spy(31));
-      d.alloc.construct(&d.data[3][2], Spy(49));
-      d.alloc.construct(&d.data[0][0], Spy(55));
-      d.alloc.construct(&d.data[0][1], Spy(67));
+      constructCell(d.alloc, &d.data[3][2], Spy(31));
+      constructCell(d.alloc, &d.data[3][3], Spy(49));
+      constructCell(d.alloc, &d.data[0][0], Spy(55));
+      constructCell(d.alloc, &d.data[0][1], Spy(67));
       Spy s(99);
       Spy::reset();
       // exercise
@@ -2807,18 +4286,18 @@ public:
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
       assertUnit(Spy(67) == s);
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 55 | 67 |    |  |    | 31 | 49 |
-      //    +----+----+----+  +----+----+----+
-      //          \                  /
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 55 | 67 |    |    |  |    |    | 31 | 49 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //          \                       /
       //          +----+----+----+----+
       //          |    | // | // |    |
       //          +----+----+----+----+
       assertUnit(d.numBlocks == 4);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numCells == 4);
       assertUnit(d.numElements == 4);
-      assertUnit(d.iaFront == 10);
+      assertUnit(d.iaFront == 14);
       assertUnit(d.data != nullptr);
 
       if (d.data)
@@ -2834,8 +4313,8 @@ public:
          assertUnit(d.data[3] != nullptr);
          if (d.data[3])
          {
-            assertUnit(d.data[3][1] == Spy(31));
-            assertUnit(d.data[3][2] == Spy(49));
+            assertUnit(d.data[3][2] == Spy(31));
+            assertUnit(d.data[3][3] == Spy(49));
          }
       }
       // teardown
@@ -2854,14 +4333,13 @@ public:
       //   +----+
       custom::deque<Spy> d;
       d.numBlocks = 1;
-      d.numCells = 16;
       d.numElements = 3;
       d.iaFront = 0;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][0], Spy(59));
-      d.alloc.construct(&d.data[0][1], Spy(67));
-      d.alloc.construct(&d.data[0][2], Spy(89));
+      constructCell(d.alloc, &d.data[0][0], Spy(59));
+      constructCell(d.alloc, &d.data[0][1], Spy(67));
+      constructCell(d.alloc, &d.data[0][2], Spy(89));
       const custom::deque<Spy> d2(d); // need the copy constructor. There is no other way
       Spy s(99);
       Spy::reset();
@@ -2908,15 +4386,15 @@ public:
    // write an element to the back of the standard deque
    void test_back_writeStandard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy s(99);
       Spy::reset();
@@ -2932,14 +4410,14 @@ public:
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 99 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 99 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(d.data != nullptr);
       if (d.data)
       {
@@ -2958,28 +4436,27 @@ public:
    // write an element to the back of a deque that is wrapped
    void test_back_writeWrapped()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 55 | 67 |    |  |    | 31 | 49 |
-      //    +----+----+----+  +----+----+----+
-      //          \                  /
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 55 | 67 |    |    |  |    |    | 31 | 49 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //          \                       /
       //          +----+----+----+----+
       //          |    | // | // |    |
       //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4 d;
       d.numBlocks = 4;
-      d.numCells = 3;
       d.numElements = 4;
-      d.iaFront = 10;
-      d.data = new Spy * [d.numBlocks];
+      d.iaFront = 14;
+      d.data = allocateMap(d, d.numBlocks);
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][1], Spy(31));
-      d.alloc.construct(&d.data[3][2], Spy(49));
-      d.alloc.construct(&d.data[0][0], Spy(55));
-      d.alloc.construct(&d.data[0][1], Spy(67));
+      constructCell(d.alloc, &d.data[3][2], Spy(31));
+      constructCell(d.alloc, &d.data[3][3], Spy(49));
+      constructCell(d.alloc, &d.data[0][0], Spy(55));
+      constructCell(d.alloc, &d.data[0][1], Spy(67));
       Spy s(99);
       Spy::reset();
       // exercise
@@ -2994,18 +4471,18 @@ public:
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 55 | 99 |    |  |    | 31 | 49 |
-      //    +----+----+----+  +----+----+----+
-      //          \                  /
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 55 | 99 |    |    |  |    |    | 31 | 49 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //          \                       /
       //          +----+----+----+----+
       //          |    | // | // |    |
       //          +----+----+----+----+
       assertUnit(d.numBlocks == 4);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numCells == 4);
       assertUnit(d.numElements == 4);
-      assertUnit(d.iaFront == 10);
+      assertUnit(d.iaFront == 14);
       assertUnit(d.data != nullptr);
 
       if (d.data)
@@ -3021,8 +4498,8 @@ public:
          assertUnit(d.data[3] != nullptr);
          if (d.data[3])
          {
-            assertUnit(d.data[3][1] == Spy(31));
-            assertUnit(d.data[3][2] == Spy(49));
+            assertUnit(d.data[3][2] == Spy(31));
+            assertUnit(d.data[3][3] == Spy(49));
          }
       }
       // teardown
@@ -3037,15 +4514,15 @@ public:
    // read an element from the front of a standard deque
    void test_front_readStandard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy s(99);
       Spy::reset();
@@ -3070,15 +4547,15 @@ public:
    // write an element to the front of the standard fixture
    void test_front_writeStandard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy s(99);
       Spy::reset();
@@ -3094,22 +4571,22 @@ public:
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 99 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 99 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(d.data != nullptr);
       if (d.data)
       {
          assertUnit(d.data[1] != nullptr);
          if (d.data[1])
          {
-            assertUnit(d.data[1][1] == Spy(99));
-            d.data[1][1] = Spy(31);
+            assertUnit(d.data[1][2] == Spy(99));
+            d.data[1][2] = Spy(31);
          }
       }
       assertStandardFixture(d);
@@ -3129,14 +4606,13 @@ public:
       //   +----+
       custom::deque<Spy> d;
       d.numBlocks = 1;
-      d.numCells = 16;
       d.numElements = 3;
       d.iaFront = 0;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][0], Spy(59));
-      d.alloc.construct(&d.data[0][1], Spy(67));
-      d.alloc.construct(&d.data[0][2], Spy(89));
+      constructCell(d.alloc, &d.data[0][0], Spy(59));
+      constructCell(d.alloc, &d.data[0][1], Spy(67));
+      constructCell(d.alloc, &d.data[0][2], Spy(89));
       const custom::deque<Spy> d2(d); // need the copy constructor. There is no other way
       Spy s(99);
       Spy::reset();
@@ -3187,15 +4663,15 @@ public:
    // read from a deque using the subscript operator
    void test_subscript_readStandard()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy s0(99);
       Spy s1(99);
@@ -3221,14 +4697,14 @@ public:
       assertUnit(s1 == Spy(49));
       assertUnit(s2 == Spy(55));
       assertUnit(s3 == Spy(67));
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertStandardFixture(d);
       // teardown
       teardownStandardFixture(d);
@@ -3236,28 +4712,27 @@ public:
 
    void test_subscript_readWrapped()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 55 | 67 |    |  |    | 31 | 49 |
-      //    +----+----+----+  +----+----+----+
-      //          \                  /
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 55 | 67 |    |    |  |    |    | 31 | 49 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //          \                       /
       //          +----+----+----+----+
       //          |    | // | // |    |
       //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4 d;
       d.numBlocks = 4;
-      d.numCells = 3;
       d.numElements = 4;
-      d.iaFront = 10;
-      d.data = new Spy * [d.numBlocks];
+      d.iaFront = 14;
+      d.data = allocateMap(d, d.numBlocks);
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][1], Spy(31));
-      d.alloc.construct(&d.data[3][2], Spy(49));
-      d.alloc.construct(&d.data[0][0], Spy(55));
-      d.alloc.construct(&d.data[0][1], Spy(67));
+      constructCell(d.alloc, &d.data[3][2], Spy(31));
+      constructCell(d.alloc, &d.data[3][3], Spy(49));
+      constructCell(d.alloc, &d.data[0][0], Spy(55));
+      constructCell(d.alloc, &d.data[0][1], Spy(67));
       Spy s0(99);
       Spy s1(99);
       Spy s2(99);
@@ -3278,18 +4753,18 @@ public:
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 55 | 99 |    |  |    | 31 | 49 |
-      //    +----+----+----+  +----+----+----+
-      //          \                  /
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 55 | 99 |    |    |  |    |    | 31 | 49 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //          \                       /
       //          +----+----+----+----+
       //          |    | // | // |    |
       //          +----+----+----+----+
       assertUnit(d.numBlocks == 4);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numCells == 4);
       assertUnit(d.numElements == 4);
-      assertUnit(d.iaFront == 10);
+      assertUnit(d.iaFront == 14);
       assertUnit(d.data != nullptr);
 
       if (d.data)
@@ -3305,8 +4780,8 @@ public:
          assertUnit(d.data[3] != nullptr);
          if (d.data[3])
          {
-            assertUnit(d.data[3][1] == Spy(31));
-            assertUnit(d.data[3][2] == Spy(49));
+            assertUnit(d.data[3][2] == Spy(31));
+            assertUnit(d.data[3][3] == Spy(49));
          }
       }
       // teardown
@@ -3323,17 +4798,16 @@ public:
       //   +----+
       //   |    |
       //   +----+
-      custom::deque<Spy> d;
+      Deque4 d;
       d.numBlocks = 1;
-      d.numCells = 16;
       d.numElements = 3;
       d.iaFront = 0;
-      d.data = new Spy * [1];
+      d.data = allocateMap(d, 1);
       d.data[0] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[0][0], Spy(59));
-      d.alloc.construct(&d.data[0][1], Spy(67));
-      d.alloc.construct(&d.data[0][2], Spy(89));
-      const custom::deque<Spy> d2(d); // need the copy constructor. There is no other way
+      constructCell(d.alloc, &d.data[0][0], Spy(59));
+      constructCell(d.alloc, &d.data[0][1], Spy(67));
+      constructCell(d.alloc, &d.data[0][2], Spy(89));
+      const Deque4 d2(d); // need the copy constructor. There is no other way
       Spy s(99);
       Spy::reset();
       // exercise
@@ -3357,7 +4831,7 @@ public:
       //   |    |
       //   +----+
       assertUnit(d2.numBlocks == 1);
-      assertUnit(d2.numCells == 16);
+      assertUnit(d2.numCells == 4);
       assertUnit(d2.numElements == 3);
       assertUnit(d2.iaFront == 0);
       assertUnit(d2.data != nullptr);
@@ -3378,15 +4852,15 @@ public:
    
    void test_subscript_writeStandard()
    {
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy s0(10);
       Spy s1(11);
@@ -3408,18 +4882,18 @@ public:
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    |    | 10 | 11 |  | 12 | 13 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 10 | 11 |  | 12 | 13 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(d.numBlocks == 4);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numCells == 4);
       assertUnit(d.numElements == 4);
-      assertUnit(d.iaFront == 4);
+      assertUnit(d.iaFront == 6);
       assertUnit(d.data != nullptr);
 
       if (d.data)
@@ -3428,8 +4902,8 @@ public:
          assertUnit(d.data[1] != nullptr);
          if (d.data[1])
          {
-            assertUnit(d.data[1][1] == Spy(10));
-            assertUnit(d.data[1][2] == Spy(11));
+            assertUnit(d.data[1][2] == Spy(10));
+            assertUnit(d.data[1][3] == Spy(11));
          }
          assertUnit(d.data[2] != nullptr);
          if (d.data[2])
@@ -3444,28 +4918,27 @@ public:
 
    void test_subscript_writeWrapped()
    {  // setup
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 55 | 67 |    |  |    | 31 | 49 |
-      //    +----+----+----+  +----+----+----+
-      //          \                  /
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 55 | 67 |    |    |  |    |    | 31 | 49 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //          \                       /
       //          +----+----+----+----+
       //          |    | // | // |    |
       //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4 d;
       d.numBlocks = 4;
-      d.numCells = 3;
       d.numElements = 4;
-      d.iaFront = 10;
-      d.data = new Spy * [d.numBlocks];
+      d.iaFront = 14;
+      d.data = allocateMap(d, d.numBlocks);
       d.data[0] = d.alloc.allocate(d.numCells);
       d.data[1] = nullptr;
       d.data[2] = nullptr;
       d.data[3] = d.alloc.allocate(d.numCells);
-      d.alloc.construct(&d.data[3][1], Spy(31));
-      d.alloc.construct(&d.data[3][2], Spy(49));
-      d.alloc.construct(&d.data[0][0], Spy(55));
-      d.alloc.construct(&d.data[0][1], Spy(67));
+      constructCell(d.alloc, &d.data[3][2], Spy(31));
+      constructCell(d.alloc, &d.data[3][3], Spy(49));
+      constructCell(d.alloc, &d.data[0][0], Spy(55));
+      constructCell(d.alloc, &d.data[0][1], Spy(67));
       Spy s0(10);
       Spy s1(11);
       Spy s2(12);
@@ -3486,18 +4959,18 @@ public:
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(Spy::numDestructor() == 0);
-      //      0     1    2       0    1    2
-      //    +----+----+----+  +----+----+----+
-      //    | 12 | 13 |    |  |    | 10 | 11 |
-      //    +----+----+----+  +----+----+----+
-      //          \                  /
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    | 12 | 13 |    |    |  |    |    | 10 | 11 |
+      //    +----+----+----+----+  +----+----+----+----+
+      //          \                       /
       //          +----+----+----+----+
       //          |    | // | // |    |
       //          +----+----+----+----+
       assertUnit(d.numBlocks == 4);
-      assertUnit(d.numCells == 3);
+      assertUnit(d.numCells == 4);
       assertUnit(d.numElements == 4);
-      assertUnit(d.iaFront == 10);
+      assertUnit(d.iaFront == 14);
       assertUnit(d.data != nullptr);
 
       if (d.data)
@@ -3513,8 +4986,8 @@ public:
          assertUnit(d.data[3] != nullptr);
          if (d.data[3])
          {
-            assertUnit(d.data[3][1] == Spy(10));
-            assertUnit(d.data[3][2] == Spy(11));
+            assertUnit(d.data[3][2] == Spy(10));
+            assertUnit(d.data[3][3] == Spy(11));
          }
       }
       // teardown
@@ -3555,15 +5028,15 @@ public:
    // test the iterator at the beginning of the standard fixture
    void test_iterator_begin_standard()
    {  // setup
-      custom::deque<Spy>::iterator it;
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4::iterator it;
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy::reset();
       // exercise
@@ -3582,14 +5055,14 @@ public:
       assertUnit(Spy::numAssignMove() == 0);
       assertUnit(it.id == 0);
       assertUnit(it.d == &d);
-      //           it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //                it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertStandardFixture(d);
       // teardown
       teardownStandardFixture(d);
@@ -3598,15 +5071,15 @@ public:
    // test the iterator at the end of the standard fixture
    void test_iterator_end_standard()
    {  // setup
-      custom::deque<Spy>::iterator it;
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4::iterator it;
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       Spy::reset();
       // exercise
@@ -3623,14 +5096,14 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //                                  it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //                                       it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(it.id == 4);
       assertUnit(it.d == &d);
       assertStandardFixture(d);
@@ -3641,16 +5114,16 @@ public:
    // test the iterator to increment from the middle of the standard fixture
    void test_iterator_increment_standardMiddle()
    {  // setup
-      custom::deque<Spy>::iterator it;
-      //                it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4::iterator it;
+      //                     it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       it.d = &d;
       it.id = 1;
@@ -3669,14 +5142,14 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //                        it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //                             it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(it.id == 2);
       assertUnit(it.d == &d);
       assertStandardFixture(d);
@@ -3684,19 +5157,102 @@ public:
       teardownStandardFixture(d);
    }
 
+   // increment off the end of a block and find the next one
+   void test_iterator_increment_betweenBlocks()
+   {  // setup
+      //                     it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      Deque4::iterator it = d.begin();
+      ++it;
+      assertUnit(*it == Spy(49));
+      Spy::reset();
+      // exercise
+      ++it;
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //                             it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      assertUnit(it.id == 2);
+      assertUnit(it.pCur == nullptr);
+      assertUnit(*it == Spy(55));
+      assertUnit(it.pCur == &d.data[2][0]);
+      assertUnit(*(++it) == Spy(67));
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // decrement off the start of a block and find the previous one
+   void test_iterator_decrement_betweenBlocks()
+   {  // setup
+      //                             it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      Deque4::iterator it = d.begin();
+      it += 2;
+      assertUnit(*it == Spy(55));
+      Spy::reset();
+      // exercise
+      --it;
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //                     it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      assertUnit(it.id == 1);
+      assertUnit(*it == Spy(49));
+      assertUnit(it.pCur == &d.data[1][3]);
+      assertUnit(*(--it) == Spy(31));
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
    // the the iterator's dereference operator to access an item from the list
    void test_iterator_dereference_read()
    {  // setup
-      custom::deque<Spy>::iterator it;
-      //                it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4::iterator it;
+      //                     it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       it.d = &d;
       it.id = 1;
@@ -3716,14 +5272,14 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //                it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //                     it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(s == Spy(49));
       assertUnit(it.id == 1);
       assertUnit(it.d == &d);
@@ -3735,16 +5291,16 @@ public:
    // the the iterator's dereference operator to update an item from the list
    void test_iterator_dereference_update()
    {  // setup
-      custom::deque<Spy>::iterator it;
-      //                it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4::iterator it;
+      //                     it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       it.d = &d;
       it.id = 1;
@@ -3764,22 +5320,22 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //                it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 99 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //                     it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 99 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(d.data != nullptr);
       if (d.data)
       {
          assertUnit(d.data[1] != nullptr);
          if (d.data[1])
          {
-            assertUnit(d.data[1][2] == Spy(99));
-            d.data[1][2] = Spy(49);
+            assertUnit(d.data[1][3] == Spy(99));
+            d.data[1][3] = Spy(49);
          }
       }
       assertUnit(it.id == 1);
@@ -3792,16 +5348,16 @@ public:
    // the the iterator's dereference operator to update an item from the list
    void test_iterator_add_withinBlock()
    {  // setup
-      custom::deque<Spy>::iterator it;
-      //           it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4::iterator it;
+      //                it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       it.d = &d;
       it.id = 0;
@@ -3820,14 +5376,14 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //                it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //                     it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(it.id == 1);
       assertUnit((*(it.d))[it.id] == Spy(49));
       assertUnit(it.d == &d);
@@ -3839,16 +5395,16 @@ public:
    // the the iterator's dereference operator to update an item from the list
    void test_iterator_add_betweenBlocks()
    {  // setup
-      custom::deque<Spy>::iterator it;
-      //           it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4::iterator it;
+      //                it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       it.d = &d;
       it.id = 0;
@@ -3867,14 +5423,14 @@ public:
       assertUnit(Spy::numNondefault() == 0);
       assertUnit(Spy::numCopyMove() == 0);
       assertUnit(Spy::numAssignMove() == 0);
-      //                             it
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
+      //                                  it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
       assertUnit(it.id == 3);
       assertUnit((*(it.d))[it.id] == Spy(67));
       assertUnit(it.d == &d);
@@ -3886,18 +5442,18 @@ public:
    // the the iterator's dereference operator to update an item from the list
    void test_iterator_difference_standard()
    {  // setup
-      custom::deque<Spy>::iterator it1;
-      custom::deque<Spy>::iterator it2;
-      //           it1          it2
-      // id        0    1       2     3
-      //    +----+----+----+  +----+----+----+
-      //    |    | 31 | 49 |  | 55 | 67 |    |
-      //    +----+----+----+  +----+----+----+
-      //               \        /
-      //          +----+----+----+----+
-      //          | // |    |    | // |
-      //          +----+----+----+----+
-      custom::deque<Spy> d;
+      Deque4::iterator it1;
+      Deque4::iterator it2;
+      //                it1          it2
+      //        id      0    1       2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
       setupStandardFixture(d);
       it1.d = &d;
       it1.id = 0;
@@ -3925,49 +5481,268 @@ public:
    }
 
 
+   // random access through the iterator's subscript operator
+   void test_iterator_subscript_standard()
+   {  // setup
+      //                it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      Deque4::iterator it = d.begin();
+      Spy::reset();
+      // exercise
+      Spy& s3 = it[3];
+      Spy& s1 = (3 + it)[-2];
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(&s3 == &d.data[2][1]);
+      assertUnit(&s1 == &d.data[1][3]);
+      assertUnit((it + 3) - it == 3);
+      assertUnit((d.end() - 4) == it);
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // iterators order by their position in the deque
+   void test_iterator_compare_standard()
+   {  // setup
+      Deque4 d;
+      setupStandardFixture(d);
+      Deque4::iterator it1 = d.begin() + 1;
+      Deque4::iterator it2 = d.begin() + 2;
+      // exercise and verify
+      assertUnit(it1 < it2);
+      assertUnit(it1 <= it2);
+      assertUnit(it2 > it1);
+      assertUnit(it2 >= it1);
+      assertUnit(!(it1 < it1));
+      assertUnit(it1 <= it1);
+      assertUnit(d.begin() < d.end());
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // the standard algorithms run on a wrapped, multi-block deque
+   void test_iterator_sort_wrapped()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d;
+      for (int i = 0; i < 20; i++)
+         d.push_back((i * 7) % 20);
+      for (int i = 20; i < 37; i++)
+         d.push_front((i * 7) % 37);
+      // exercise
+      std::sort(d.begin(), d.end());
+      // verify
+      assertUnit(std::is_sorted(d.begin(), d.end()));
+      assertUnit(d.size() == 37);
+      assertUnit(std::lower_bound(d.begin(), d.end(), 12) - d.begin()
+                 == std::count_if(d.begin(), d.end(), [](int v) { return v < 12; }));
+      std::nth_element(d.begin(), d.begin() + 18, d.end(), std::greater<int>());
+      assertUnit(std::is_partitioned(d.begin(), d.end(), [&](int v) { return v >= d[18]; }));
+   }  // teardown
+
+   // read through a const_iterator
+   void test_iterator_const_standard()
+   {  // setup
+      Deque4 d;
+      setupStandardFixture(d);
+      const Deque4& dConst = d;
+      Spy::reset();
+      // exercise
+      Deque4::const_iterator it = dConst.begin();
+      Deque4::const_iterator itFromMutable = d.begin();
+      // verify
+      assertUnit(*it == Spy(31));
+      assertUnit(it[3] == Spy(67));
+      assertUnit(it == itFromMutable);
+      assertUnit(d.begin() == it);
+      assertUnit(dConst.end() - it == 4);
+      assertUnit(d.cend() == d.end());
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // walk the standard fixture backwards
+   void test_iterator_reverse_standard()
+   {  // setup
+      Deque4 d;
+      setupStandardFixture(d);
+      int values[4];
+      int i = 0;
+      // exercise
+      for (Deque4::reverse_iterator it = d.rbegin(); it != d.rend(); ++it)
+         values[i++] = it->get();
+      // verify
+      assertUnit(i == 4);
+      assertUnit(values[0] == 67);
+      assertUnit(values[1] == 55);
+      assertUnit(values[2] == 49);
+      assertUnit(values[3] == 31);
+      assertUnit(d.crbegin()[1] == Spy(55));
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   /***************************************
+    * SEGMENTS
+    ***************************************/
+
+   // an empty deque has no segments
+   void test_segments_empty()
+   {  // setup
+      custom::deque<Spy> d;
+      int count = 0;
+      size_t numVisited = 0;
+      // exercise
+      for (custom::span<Spy> seg : d.segments())
+      {
+         count++;
+         numVisited += seg.size();
+      }
+      // verify
+      assertUnit(count == 0);
+      assertUnit(numVisited == 0);
+      assertEmptyFixture(d);
+   }  // teardown
+
+   // one span per block
+   void test_segments_standard()
+   {  // setup
+      //      0    1    2    3       0    1    2    3
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      //                    \        /
+      //               +----+----+----+----+
+      //               | // |    |    | // |
+      //               +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      std::vector<custom::span<Spy>> segs;
+      Spy::reset();
+      // exercise
+      for (custom::span<Spy> seg : d.segments())
+         segs.push_back(seg);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(segs.size() == 2);
+      if (segs.size() == 2)
+      {
+         assertUnit(segs[0].data() == &d.data[1][2]);
+         assertUnit(segs[0].size() == 2);
+         assertUnit(segs[1].data() == &d.data[2][0]);
+         assertUnit(segs[1].size() == 2);
+      }
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // a subrange is clipped at both ends
+   void test_segments_subrange()
+   {  // setup
+      //                     it           it
+      //    +----+----+----+----+  +----+----+----+----+
+      //    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+      //    +----+----+----+----+  +----+----+----+----+
+      Deque4 d;
+      setupStandardFixture(d);
+      const Deque4& dConst = d;
+      std::vector<custom::span<const Spy>> segs;
+      // exercise
+      for (custom::span<const Spy> seg : dConst.segments(dConst.begin() + 1, dConst.begin() + 3))
+         segs.push_back(seg);
+      // verify
+      assertUnit(segs.size() == 2);
+      if (segs.size() == 2)
+      {
+         assertUnit(segs[0].data() == &d.data[1][3]);
+         assertUnit(segs[0].size() == 1);
+         assertUnit(segs[1].data() == &d.data[2][0]);
+         assertUnit(segs[1].size() == 1);
+      }
+      assertStandardFixture(d);
+      // teardown
+      teardownStandardFixture(d);
+   }
+
+   // a kernel over the segments of a wrapped deque sees every element in order
+   void test_segments_wrapped()
+   {  // setup
+      custom::deque<int, std::allocator<int>, 4> d;
+      for (int i = 5; i < 15; i++)
+         d.push_back(i);
+      for (int i = 4; i >= 0; i--)
+         d.push_front(i);
+      int numSegments = 0;
+      // exercise
+      for (custom::span<int> seg : d.segments())
+      {
+         std::transform(seg.begin(), seg.end(), seg.begin(), [](int v) { return v * 2; });
+         numSegments++;
+      }
+      // verify
+      assertUnit(numSegments == 5);
+      for (int i = 0; i < 15; i++)
+         assertUnit(d[i] == i * 2);
+   }  // teardown
+
    /*************************************************************
     * SETUP STANDARD FIXTURE
     *    [31, 49, 55, 67]
     *
-    *      0     1    2       0    1    2
-    *    +----+----+----+  +----+----+----+
-    *    |    | 31 | 49 |  | 55 | 67 |    |
-    *    +----+----+----+  +----+----+----+
-    *               \        /
-    *          +----+----+----+----+
-    *          | // |    |    | // |
-    *          +----+----+----+----+
-    *    iaFront     = 4
+    *      0    1    2    3       0    1    2    3
+    *    +----+----+----+----+  +----+----+----+----+
+    *    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+    *    +----+----+----+----+  +----+----+----+----+
+    *                    \        /
+    *               +----+----+----+----+
+    *               | // |    |    | // |
+    *               +----+----+----+----+
+    *    iaFront     = 6
     *    numElements = 4
-    *    numCell     = 3
+    *    numCell     = 4
     *    numBlock    = 4
     *************************************************************/
-   void setupStandardFixture(custom::deque<Spy>& d)
+   void setupStandardFixture(Deque4& d)
    {
       d.numBlocks   = 4;
-      d.numCells    = 3;
       d.numElements = 4;
-      d.iaFront     = 4;
-      d.data = new Spy * [d.numBlocks];
+      d.iaFront     = 6;
+      d.data = allocateMap(d, d.numBlocks);
 
       d.data[0] = nullptr;
       d.data[1] = d.alloc.allocate(d.numCells);
       d.data[2] = d.alloc.allocate(d.numCells);
       d.data[3] = nullptr;
 
-      d.alloc.construct(&d.data[1][1], Spy(31));
-      d.alloc.construct(&d.data[1][2], Spy(49));
-      d.alloc.construct(&d.data[2][0], Spy(55));
-      d.alloc.construct(&d.data[2][1], Spy(67));
+      constructCell(d.alloc, &d.data[1][2], Spy(31));
+      constructCell(d.alloc, &d.data[1][3], Spy(49));
+      constructCell(d.alloc, &d.data[2][0], Spy(55));
+      constructCell(d.alloc, &d.data[2][1], Spy(67));
    }
 
    /*************************************************************
     * VERIFY EMPTY FIXTURE
     *************************************************************/
-   void assertEmptyFixtureParameters(const custom::deque<Spy>& d, int line, const char* function)
+   template <size_t BS>
+   void assertEmptyFixtureParameters(const custom::deque<Spy, std::allocator<Spy>, BS>& d,
+                                     int line, const char* function)
    {
       assertIndirect(d.numBlocks == 0);
-      assertIndirect(d.numCells == 16);
       assertIndirect(d.numElements == 0);
       assertIndirect(d.iaFront == 0);
       assertIndirect(d.data == nullptr);
@@ -3977,25 +5752,25 @@ public:
     * VERIFY STANDARD FIXTURE
     *    [31, 49, 55, 67]
     *
-    *      0     1    2       0    1    2
-    *    +----+----+----+  +----+----+----+
-    *    |    | 31 | 49 |  | 55 | 67 |    |
-    *    +----+----+----+  +----+----+----+
-    *               \        /
-    *          +----+----+----+----+
-    *          | // |    |    | // |
-    *          +----+----+----+----+
-    *    iaFront     = 4
+    *      0    1    2    3       0    1    2    3
+    *    +----+----+----+----+  +----+----+----+----+
+    *    |    |    | 31 | 49 |  | 55 | 67 |    |    |
+    *    +----+----+----+----+  +----+----+----+----+
+    *                    \        /
+    *               +----+----+----+----+
+    *               | // |    |    | // |
+    *               +----+----+----+----+
+    *    iaFront     = 6
     *    numElements = 4
-    *    numCell     = 3
+    *    numCell     = 4
     *    numBlock    = 4
     *************************************************************/
-   void assertStandardFixtureParameters(const custom::deque<Spy>& d, int line, const char* function)
+   void assertStandardFixtureParameters(const Deque4& d, int line, const char* function)
    {
       assertIndirect(d.numBlocks == 4);
-      assertIndirect(d.numCells == 3);
+      assertIndirect(d.numCells == 4);
       assertIndirect(d.numElements == 4);
-      assertIndirect(d.iaFront == 4);
+      assertIndirect(d.iaFront == 6);
       assertIndirect(d.data != nullptr);
 
       if (d.data)
@@ -4004,8 +5779,8 @@ public:
          assertIndirect(d.data[1] != nullptr);
          if (d.data[1])
          {
-            assertIndirect(d.data[1][1] == Spy(31));
-            assertIndirect(d.data[1][2] == Spy(49));
+            assertIndirect(d.data[1][2] == Spy(31));
+            assertIndirect(d.data[1][3] == Spy(49));
          }
          assertIndirect(d.data[2] != nullptr);
          if (d.data[2])
@@ -4024,7 +5799,8 @@ public:
     *    |    |    |    |    |
     *    +----+----+----+----+
     *************************************************************/
-   void teardownStandardFixture(custom::deque<Spy>& d)
+   template <size_t BS>
+   void teardownStandardFixture(custom::deque<Spy, std::allocator<Spy>, BS>& d)
    {
       if (d.data)
       {
@@ -4033,28 +5809,52 @@ public:
             int ib = d.ibFromID((int)id);
             int ic = d.icFromID((int)id);
             if (ib != -1 && ic != -1)
-               d.alloc.destroy(&d.data[ib][ic]);
+               destroyCell(d.alloc, &d.data[ib][ic]);
          }
 
-         if (d.numBlocks > 0 && d.data[0])
-            d.alloc.deallocate(d.data[0], d.numCells);
-         if (d.numBlocks > 1 && d.data[1])
-            d.alloc.deallocate(d.data[1], d.numCells);
-         if (d.numBlocks > 2 && d.data[2])
-            d.alloc.deallocate(d.data[2], d.numCells);
-         if (d.numBlocks > 3 && d.data[3])
-            d.alloc.deallocate(d.data[3], d.numCells);
-         if (d.numBlocks > 4 && d.data[4])
-            d.alloc.deallocate(d.data[4], d.numCells);
+         for (size_t ib = 0; ib < d.numBlocks; ib++)
+            if (d.data[ib])
+               d.alloc.deallocate(d.data[ib], d.numCells);
 
-         delete [] d.data;
+         freeMap(d);
       }
+      while (d.numSpare)
+         d.alloc.deallocate(d.spare[--d.numSpare], d.numCells);
       d.data = nullptr;
       d.numBlocks = 0;
       d.numElements = 0;
-      d.numCells = 0;
    }
 
+   /*************************************************************
+    * MAP AND CELLS
+    * Hand-built fixtures get their map and build their cells
+    * through the allocator the deque uses, so the deque can
+    * free what the test made and the other way round
+    *************************************************************/
+   template <size_t BS>
+   Spy** allocateMap(custom::deque<Spy, std::allocator<Spy>, BS>& d, size_t numBlocks)
+   {
+      typedef custom::deque<Spy, std::allocator<Spy>, BS> Deque;
+      typename Deque::map_allocator mapAlloc(d.alloc);
+      return Deque::map_traits::allocate(mapAlloc, numBlocks);
+   }
+   template <size_t BS>
+   void freeMap(custom::deque<Spy, std::allocator<Spy>, BS>& d)
+   {
+      typedef custom::deque<Spy, std::allocator<Spy>, BS> Deque;
+      typename Deque::map_allocator mapAlloc(d.alloc);
+      Deque::map_traits::deallocate(mapAlloc, d.data, d.numBlocks);
+   }
+   template <typename Alloc, typename ... Args>
+   static void constructCell(Alloc& alloc, Spy* p, Args&& ... args)
+   {
+      std::allocator_traits<Alloc>::construct(alloc, p, std::forward<Args>(args)...);
+   }
+   template <typename Alloc>
+   static void destroyCell(Alloc& alloc, Spy* p)
+   {
+      std::allocator_traits<Alloc>::destroy(alloc, p);
+   }
 };
 
 #endif // DEBUG
@@ -0,0 +1,406 @@
+/***********************************************************************
+ * Header:
+ *    TEST MAPPED DEQUE
+ * Summary:
+ *    Unit tests for the deque in a memory-mapped file
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "mappedDeque.h"  // class under test
+#include "unitTest.h"     // unit test baseclass
+
+#ifdef DEQUE_POSIX
+
+#include <cstdio>         // for std::remove
+#include <string>
+#include <unistd.h>       // for truncate
+
+/***********************************************
+ * TEST MAPPED DEQUE
+ * Unit tests for mapped_deque
+ ***********************************************/
+class TestMappedDeque : public UnitTest
+{
+   // four cells to a block so a short deque spans several blocks
+   typedef custom::mapped_deque<int, 4> Deque;
+
+public:
+   void run()
+   {
+      reset();
+
+      // Open
+      test_open_new();
+      test_open_reopen();
+      test_open_reopenWrapped();
+      test_open_wrongType();
+      test_open_truncated();
+      test_open_badTable();
+      test_open_badNumBlocks();
+
+      // Push and pop
+      test_pushback_order();
+      test_pushfront_order();
+      test_pushback_growMap();
+      test_pushback_growFile();
+      test_popfront_freeSlot();
+      test_clear_freeSlots();
+      test_pushback_mapFull();
+
+      report("MappedDeque");
+   }
+
+   /***************************************
+    * OPEN
+    ***************************************/
+
+   // a new file is laid out empty
+   void test_open_new()
+   {  // setup
+      std::remove(path());
+      {
+         // exercise
+         Deque d(path());
+         // verify
+         assertUnit(d.empty());
+         assertUnit(std::string(d.pHeader->magic) == "CDEQUE1");
+         assertUnit(d.pHeader->numBlocks == 2);
+         assertUnit(d.pHeader->numSlots == 4);
+         assertUnit(d.pHeader->numSlotsUsed == 0);
+         assertUnit(d.bytesMapped == d.offsetSlots + 4 * 4 * sizeof(int));
+      }
+      // teardown
+      std::remove(path());
+   }
+
+   // a reopened file has the deque as it was
+   void test_open_reopen()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         for (int i = 0; i < 10; i++)
+            d.push_back(i);
+         d.sync();
+      }
+      // exercise
+      Deque d(path());
+      // verify
+      assertUnit(d.size() == 10);
+      for (int i = 0; i < 10; i++)
+         assertUnit(d[i] == i);
+      d.push_back(10);
+      assertUnit(d.back() == 10);
+      // teardown
+      std::remove(path());
+   }
+
+   // the front, wrapped around the map, is where it was
+   void test_open_reopenWrapped()
+   {  // setup
+      std::remove(path());
+      size_t iaFront;
+      {
+         Deque d(path());
+         for (int i = 0; i < 3; i++)
+            d.push_back(i);
+         for (int i = -1; i >= -3; i--)
+            d.push_front(i);
+         iaFront = (size_t)d.pHeader->iaFront;
+      }
+      // exercise
+      Deque d(path());
+      // verify
+      assertUnit(d.pHeader->iaFront == iaFront);
+      assertUnit(d.size() == 6);
+      for (int i = 0; i < 6; i++)
+         assertUnit(d[i] == i - 3);
+      // teardown
+      std::remove(path());
+   }
+
+   // a file made for another element type will not open
+   void test_open_wrongType()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         d.push_back(26);
+      }
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::mapped_deque<long long, 4> d(path());
+      }
+      catch (const std::runtime_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      Deque d(path());
+      assertUnit(d.size() == 1);
+      assertUnit(d.front() == 26);
+      // teardown
+      std::remove(path());
+   }
+
+   // a file cut short of its slots will not open
+   void test_open_truncated()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         for (int i = 0; i < 40; i++)
+            d.push_back(i);
+      }
+      // the header and table are whole, most of the slots are gone
+      assertUnit(truncate(path(), (off_t)(Deque::headerBytes(4096) + 16)) == 0);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         Deque d(path());
+      }
+      catch (const std::runtime_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      // teardown
+      std::remove(path());
+   }
+
+   // a table entry past the slots the file has will not open
+   void test_open_badTable()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         for (int i = 0; i < 40; i++)
+            d.push_back(i);
+         d.pHeader->table[0] = d.pHeader->numSlotsUsed + 1000;
+      }
+      bool thrown = false;
+      // exercise
+      try
+      {
+         Deque d(path());
+      }
+      catch (const std::runtime_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      // teardown
+      std::remove(path());
+   }
+
+   // a map size the ids cannot be masked with will not open
+   void test_open_badNumBlocks()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         for (int i = 0; i < 40; i++)
+            d.push_back(i);
+         d.pHeader->numBlocks = 3;
+      }
+      bool thrown = false;
+      // exercise
+      try
+      {
+         Deque d(path());
+      }
+      catch (const std::runtime_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      // teardown
+      std::remove(path());
+   }
+
+   /***************************************
+    * PUSH AND POP
+    ***************************************/
+
+   // first in, first out across blocks
+   void test_pushback_order()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         // exercise
+         for (int i = 0; i < 7; i++)
+            d.push_back(i);
+         // verify
+         assertUnit(d.size() == 7);
+         assertUnit(d.pHeader->numSlotsUsed == 2);
+         for (int i = 0; i < 7; i++)
+            assertUnit(d[i] == i);
+         assertUnit(d.front() == 0);
+         assertUnit(d.back() == 6);
+      }
+      // teardown
+      std::remove(path());
+   }
+
+   // push_front wraps the front to the end of the map
+   void test_pushfront_order()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         // exercise
+         d.push_front(26);
+         d.push_front(11);
+         // verify
+         //   +----+----+----+----+   +----+----+----+----+
+         //   |    |    |    |    |   |    |    | 11 | 26 |
+         //   +----+----+----+----+   +----+----+----+----+
+         assertUnit(d.pHeader->iaFront == 6);
+         assertUnit(d.pHeader->table[0] == 0);
+         assertUnit(d.pHeader->table[1] == 1);
+         assertUnit(d.front() == 11);
+         assertUnit(d.back() == 26);
+      }
+      // teardown
+      std::remove(path());
+   }
+
+   // growing the map reorders the table but not the slots
+   void test_pushback_growMap()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         d.push_back(0);
+         d.push_front(-1);
+         uint64_t slotFront = d.pHeader->table[1];
+         uint64_t slotBack = d.pHeader->table[0];
+         for (int i = 1; i < 4; i++)
+            d.push_back(i);
+         // exercise
+         d.push_back(4);
+         // verify
+         assertUnit(d.pHeader->numBlocks == 4);
+         assertUnit(d.pHeader->iaFront == 3);
+         assertUnit(d.pHeader->table[0] == slotFront);
+         assertUnit(d.pHeader->table[1] == slotBack);
+         for (int i = 0; i < 6; i++)
+            assertUnit(d[i] == i - 1);
+      }
+      // teardown
+      std::remove(path());
+   }
+
+   // running out of slots doubles the file
+   void test_pushback_growFile()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         // exercise
+         for (int i = 0; i < 100; i++)
+            d.push_back(i);
+         // verify
+         assertUnit(d.pHeader->numSlotsUsed == 25);
+         assertUnit(d.pHeader->numSlots == 32);
+         assertUnit(d.bytesMapped == d.offsetSlots + 32 * 4 * sizeof(int));
+         for (int i = 0; i < 100; i++)
+            assertUnit(d[i] == i);
+      }
+      // teardown
+      std::remove(path());
+   }
+
+   // an emptied block's slot is reused before a new one
+   void test_popfront_freeSlot()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         for (int i = 0; i < 6; i++)
+            d.push_back(i);
+         uint64_t slotFront = d.pHeader->table[0];
+         // exercise
+         for (int i = 0; i < 4; i++)
+            d.pop_front();
+         // verify
+         assertUnit(d.pHeader->freeSlot == slotFront);
+         assertUnit(d.pHeader->table[0] == 0);
+         d.push_back(6);
+         d.push_back(7);
+         d.push_back(8);
+         assertUnit(d.pHeader->freeSlot == 0);
+         assertUnit(d.pHeader->numSlotsUsed == 2);
+         assertUnit(d.front() == 4);
+         assertUnit(d.back() == 8);
+      }
+      // teardown
+      std::remove(path());
+   }
+
+   // clear frees every slot
+   void test_clear_freeSlots()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path());
+         for (int i = 0; i < 10; i++)
+            d.push_back(i);
+         // exercise
+         d.clear();
+         // verify
+         assertUnit(d.empty());
+         for (int i = 0; i < 10; i++)
+            d.push_back(i);
+         assertUnit(d.pHeader->numSlotsUsed == 3);
+         assertUnit(d[9] == 9);
+      }
+      // teardown
+      std::remove(path());
+   }
+
+   // the table cannot grow past maxBlocks
+   void test_pushback_mapFull()
+   {  // setup
+      std::remove(path());
+      {
+         Deque d(path(), 2);
+         for (int i = 0; i < 8; i++)
+            d.push_back(i);
+         bool thrown = false;
+         // exercise
+         try
+         {
+            d.push_back(8);
+         }
+         catch (const std::length_error&)
+         {
+            thrown = true;
+         }
+         // verify
+         assertUnit(thrown);
+         assertUnit(d.size() == 8);
+      }
+      // teardown
+      std::remove(path());
+   }
+
+private:
+   static const char* path() { return "testMappedDeque.tmp"; }
+};
+
+#endif // DEQUE_POSIX
+#endif // DEBUG
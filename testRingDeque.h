@@ -0,0 +1,349 @@
+/***********************************************************************
+ * Header:
+ *    TEST RING DEQUE
+ * Summary:
+ *    Unit tests for the fixed-capacity, overwrite-oldest deque
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "ringDeque.h"  // class under test
+#include "unitTest.h"   // unit test baseclass
+#include "spy.h"        // for the Spy class
+
+#include <stdexcept>
+#include <memory_resource>
+
+/***********************************************
+ * TEST RING DEQUE
+ * Unit tests for ring_deque
+ ***********************************************/
+class TestRingDeque : public UnitTest
+{
+   // four cells to a block so a short ring spans several blocks
+   typedef custom::ring_deque<int, std::allocator<int>, 4> Deque;
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_blocks();
+      test_construct_move();
+      test_assign_move();
+      test_assign_moveUnequal();
+
+      // Push back
+      test_pushback_underCapacity();
+      test_pushback_overwrite();
+      test_pushback_partialBlock();
+      test_pushback_noAllocation();
+      test_pushback_assignSpy();
+      test_emplaceback_fullSpy();
+      test_emplaceback_fullThrows();
+
+      // Remove
+      test_popfront_wrapped();
+      test_popback_wrapped();
+      test_destruct_spy();
+
+      report("RingDeque");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // every block is allocated up front
+   void test_construct_blocks()
+   {  // setup
+      // exercise
+      Deque d(10);
+      // verify
+      assertUnit(d.capacity() == 10);
+      assertUnit(d.numBlocks == 3);
+      assertUnit(d.data[0] != nullptr);
+      assertUnit(d.data[1] != nullptr);
+      assertUnit(d.data[2] != nullptr);
+      assertUnit(d.empty());
+      assertUnit(!d.full());
+   }  // teardown
+
+   // a move takes the blocks
+   void test_construct_move()
+   {  // setup
+      Deque d1(6);
+      for (int i = 0; i < 8; i++)
+         d1.push_back(i);
+      int** data = d1.data;
+      // exercise
+      Deque d2(std::move(d1));
+      // verify
+      assertUnit(d2.data == data);
+      assertUnit(d2.size() == 6);
+      assertUnit(d2.front() == 2);
+      assertUnit(d1.data == nullptr);
+      assertUnit(d1.size() == 0);
+   }  // teardown
+
+   // move assign frees our ring and takes rhs's
+   void test_assign_move()
+   {  // setup
+      Deque d1(6);
+      for (int i = 0; i < 8; i++)
+         d1.push_back(i);
+      int** data = d1.data;
+      Deque d2(3);
+      d2.push_back(99);
+      // exercise
+      d2 = std::move(d1);
+      // verify
+      assertUnit(d2.data == data);
+      assertUnit(d2.capacity() == 6);
+      assertUnit(d2.size() == 6);
+      assertUnit(d2.front() == 2);
+      assertUnit(d1.data == nullptr);
+      assertUnit(d1.size() == 0);
+   }  // teardown
+
+   // an allocator that stays put and differs gets a ring of its own
+   void test_assign_moveUnequal()
+   {  // setup
+      std::pmr::unsynchronized_pool_resource resource1;
+      std::pmr::unsynchronized_pool_resource resource2;
+      typedef custom::ring_deque<int, std::pmr::polymorphic_allocator<int>, 4> PmrDeque;
+      PmrDeque d1(6, &resource1);
+      for (int i = 0; i < 8; i++)
+         d1.push_back(i);
+      int** data = d1.data;
+      PmrDeque d2(3, &resource2);
+      // exercise
+      d2 = std::move(d1);
+      // verify
+      assertUnit(d2.alloc.resource() == &resource2);
+      assertUnit(d2.data != data);
+      assertUnit(d2.capacity() == 6);
+      assertUnit(d2.size() == 6);
+      for (int id = 0; id < 6 && id < (int)d2.size(); id++)
+         assertUnit(d2[id] == id + 2);
+      assertUnit(d1.alloc.resource() == &resource1);
+      assertUnit(d1.size() == 0);
+   }  // teardown
+
+   /***************************************
+    * PUSH BACK
+    ***************************************/
+
+   // below capacity it is an ordinary deque
+   void test_pushback_underCapacity()
+   {  // setup
+      Deque d(5);
+      // exercise
+      d.push_back(11);
+      d.push_back(26);
+      d.push_back(31);
+      // verify
+      assertUnit(d.size() == 3);
+      assertUnit(d.iaFront == 0);
+      assertUnit(d[0] == 11);
+      assertUnit(d[1] == 26);
+      assertUnit(d[2] == 31);
+   }  // teardown
+
+   // a full deque drops the oldest and moves the front up
+   void test_pushback_overwrite()
+   {  // setup
+      //   +----+----+----+----+   +----+----+----+----+
+      //   | 0  | 1  | 2  | 3  |   | 4  |    |    |    |
+      //   +----+----+----+----+   +----+----+----+----+
+      Deque d(5);
+      for (int i = 0; i < 5; i++)
+         d.push_back(i);
+      int* pOldest = &d.front();
+      // exercise
+      d.push_back(5);
+      // verify
+      //   +----+----+----+----+   +----+----+----+----+
+      //   | 5  | 1  | 2  | 3  |   | 4  |    |    |    |
+      //   +----+----+----+----+   +----+----+----+----+
+      assertUnit(d.size() == 5);
+      assertUnit(d.full());
+      assertUnit(d.iaFront == 1);
+      assertUnit(&d.back() == pOldest);
+      assertUnit(d.front() == 1);
+      assertUnit(d.back() == 5);
+   }  // teardown
+
+   // the ring wraps inside the last, partly used block
+   void test_pushback_partialBlock()
+   {  // setup
+      Deque d(6);
+      // exercise
+      for (int i = 0; i < 14; i++)
+         d.push_back(i);
+      // verify
+      //   +----+----+----+----+   +----+----+----+----+
+      //   | 12 | 13 | 8  | 9  |   | 10 | 11 |    |    |
+      //   +----+----+----+----+   +----+----+----+----+
+      assertUnit(d.iaFront == 2);
+      for (int i = 0; i < 6; i++)
+         assertUnit(d[i] == i + 8);
+      assertUnit(d.data[0][0] == 12);
+      assertUnit(d.data[1][1] == 11);
+   }  // teardown
+
+   // the map and blocks never change
+   void test_pushback_noAllocation()
+   {  // setup
+      Deque d(10);
+      int** data = d.data;
+      int* block0 = d.data[0];
+      int* block2 = d.data[2];
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(d.data == data);
+      assertUnit(d.data[0] == block0);
+      assertUnit(d.data[2] == block2);
+      assertUnit(d.front() == 990);
+      assertUnit(d.back() == 999);
+   }  // teardown
+
+   // overwriting assigns rather than destroying and constructing
+   void test_pushback_assignSpy()
+   {  // setup
+      custom::ring_deque<Spy, std::allocator<Spy>, 4> d(2);
+      d.push_back(Spy(11));
+      d.push_back(Spy(26));
+      Spy s(31);
+      Spy::reset();
+      // exercise
+      d.push_back(s);
+      // verify
+      assertUnit(Spy::numAssign() == 1);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(d.front().get() == 26);
+      assertUnit(d.back().get() == 31);
+   }  // teardown
+
+   // emplace on a full deque destroys the oldest and builds in its cell
+   void test_emplaceback_fullSpy()
+   {  // setup
+      custom::ring_deque<Spy, std::allocator<Spy>, 4> d(2);
+      d.emplace_back(11);
+      d.emplace_back(26);
+      Spy* pOldest = &d.front();
+      Spy::reset();
+      // exercise
+      Spy& s = d.emplace_back(31);
+      // verify
+      assertUnit(&s == pOldest);
+      assertUnit(Spy::numDestructor() == 1);
+      assertUnit(Spy::numNondefault() == 1);
+      assertUnit(d.front().get() == 26);
+      assertUnit(d.back().get() == 31);
+   }  // teardown
+
+   // a constructor that throws on a full deque loses only the oldest
+   void test_emplaceback_fullThrows()
+   {  // setup
+      struct Counted
+      {
+         int* numLive;
+         Counted(int* numLive, bool fail) : numLive(numLive)
+         {
+            if (fail)
+               throw std::runtime_error("construct failed");
+            ++*numLive;
+         }
+         ~Counted() { --*numLive; }
+      };
+      int numLive = 0;
+      {
+         custom::ring_deque<Counted, std::allocator<Counted>, 4> d(3);
+         for (int i = 0; i < 3; i++)
+            d.emplace_back(&numLive, false);
+         bool thrown = false;
+         // exercise
+         try
+         {
+            d.emplace_back(&numLive, true);
+         }
+         catch (const std::runtime_error&)
+         {
+            thrown = true;
+         }
+         // verify
+         assertUnit(thrown);
+         assertUnit(d.size() == 2);
+         assertUnit(numLive == 2);
+         d.emplace_back(&numLive, false);
+         assertUnit(d.full());
+      }
+      assertUnit(numLive == 0);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // pop_front wraps the front around the ring
+   void test_popfront_wrapped()
+   {  // setup
+      Deque d(5);
+      for (int i = 0; i < 9; i++)
+         d.push_back(i);
+      // exercise
+      d.pop_front();
+      d.pop_front();
+      // verify
+      assertUnit(d.size() == 3);
+      assertUnit(d.iaFront == 1);
+      assertUnit(d.front() == 6);
+      assertUnit(d.back() == 8);
+      d.push_back(9);
+      d.push_back(10);
+      d.push_back(11);
+      assertUnit(d.full());
+      assertUnit(d.front() == 7);
+   }  // teardown
+
+   // pop_back takes the newest across the wrap
+   void test_popback_wrapped()
+   {  // setup
+      Deque d(5);
+      for (int i = 0; i < 7; i++)
+         d.push_back(i);
+      // exercise
+      d.pop_back();
+      d.pop_back();
+      d.pop_back();
+      // verify
+      assertUnit(d.size() == 2);
+      assertUnit(d.front() == 2);
+      assertUnit(d.back() == 3);
+   }  // teardown
+
+   // whatever is left is destroyed with the deque
+   void test_destruct_spy()
+   {  // setup
+      {
+         custom::ring_deque<Spy, std::allocator<Spy>, 4> d(3);
+         for (int i = 0; i < 5; i++)
+            d.emplace_back(i);
+         Spy::reset();
+      }  // exercise
+      // verify
+      assertUnit(Spy::numDestructor() == 3);
+      assertUnit(Spy::numDelete() == 3);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,316 @@
+/***********************************************************************
+ * Header:
+ *    TEST SPILL DEQUE
+ * Summary:
+ *    Unit tests for the queue that spills its middle blocks to disk
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "spillDeque.h"  // class under test
+#include "unitTest.h"    // unit test baseclass
+
+#ifdef DEQUE_POSIX
+
+#include <deque>         // to check against
+#include <mutex>         // for std::lock_guard, std::unique_lock
+#include <random>        // for std::mt19937
+#include <system_error>  // for std::system_error
+#include <fcntl.h>       // for open
+#include <unistd.h>      // for close
+
+/***********************************************
+ * TEST SPILL DEQUE
+ * Unit tests for spill_deque
+ ***********************************************/
+class TestSpillDeque : public UnitTest
+{
+   // four cells to a block so a short queue spans many blocks
+   typedef custom::spill_deque<int, std::allocator<int>, 4> Deque;
+   static const size_t blockBytes = 4 * sizeof(int);
+
+public:
+   void run()
+   {
+      reset();
+
+      // Budget
+      test_construct_minimumBudget();
+      test_pushback_underBudget();
+      test_pushback_spillMiddle();
+      test_pushback_writeFails();
+
+      // Reading back
+      test_popfront_order();
+      test_popfront_prefetch();
+      test_popfront_noRewrite();
+      test_popfront_reuseSlots();
+      test_popfront_readFailsThenRetry();
+      test_random_againstStd();
+
+      report("SpillDeque");
+   }
+
+   /***************************************
+    * BUDGET
+    ***************************************/
+
+   // the back, the front and the window always fit
+   void test_construct_minimumBudget()
+   {  // setup
+      // exercise
+      Deque d(0, 2);
+      // verify
+      assertUnit(d.maxResident == 4);
+      assertUnit(d.empty());
+      assertUnit(d.numSlots == 0);
+   }  // teardown
+
+   // nothing is spilled within the budget
+   void test_pushback_underBudget()
+   {  // setup
+      Deque d(8 * blockBytes);
+      // exercise
+      for (int i = 0; i < 30; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(d.size() == 30);
+      assertUnit(d.numBlocksResident() == 8);
+      assertUnit(d.numBlocksSpilled() == 0);
+      assertUnit(d.numSlots == 0);
+      assertUnit(d.front() == 0);
+      assertUnit(d.back() == 29);
+   }  // teardown
+
+   // over budget, the newest block before the back goes each time
+   void test_pushback_spillMiddle()
+   {  // setup
+      Deque d(4 * blockBytes, 1);
+      // exercise
+      for (int i = 0; i < 40; i++)
+         d.push_back(i);
+      // verify
+      //   +---+---+---+---+---+---+---+---+---+---+
+      //   | R | R | R | S | S | S | S | S | S | R |
+      //   +---+---+---+---+---+---+---+---+---+---+
+      //   front                               back
+      assertUnit(d.numBlocksResident() == 4);
+      assertUnit(d.numBlocksSpilled() == 6);
+      assertUnit(d.numSlots == 6);
+      assertUnit(d.blocks[0]->state == Deque::RESIDENT);
+      assertUnit(d.blocks[1]->state == Deque::RESIDENT);
+      assertUnit(d.blocks[2]->state == Deque::RESIDENT);
+      for (int ib = 3; ib < 9; ib++)
+         assertUnit(d.blocks[ib]->state == Deque::SPILLED && d.blocks[ib]->p == nullptr);
+      assertUnit(d.blocks[9]->state == Deque::RESIDENT);
+   }  // teardown
+
+   // a spill that cannot be written leaves the queue as it was
+   void test_pushback_writeFails()
+   {  // setup
+      Deque d(4 * blockBytes, 1);
+      for (int i = 0; i < 16; i++)
+         d.push_back(i);
+      int fdGood = d.fd;
+      d.fd = ::open("/dev/null", O_RDONLY);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         d.push_back(16);
+      }
+      catch (const std::system_error&)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(d.size() == 16);
+      assertUnit(d.blocks.size() == 4);
+      assertUnit(d.numBlocksResident() == 4);
+      assertUnit(d.numSlots == 0);
+      for (int ib = 0; ib < 4 && ib < (int)d.blocks.size(); ib++)
+         assertUnit(d.blocks[ib]->slot == 0 && d.blocks[ib]->state == Deque::RESIDENT);
+      ::close(d.fd);
+      d.fd = fdGood;
+      for (int i = 16; i < 24; i++)
+         d.push_back(i);
+      for (int i = 0; i < 24 && !d.empty(); i++)
+      {
+         assertUnit(d.front() == i);
+         d.pop_front();
+      }
+      // teardown
+   }
+
+   /***************************************
+    * READING BACK
+    ***************************************/
+
+   // every element comes back, in order
+   void test_popfront_order()
+   {  // setup
+      Deque d(4 * blockBytes, 1);
+      for (int i = 0; i < 100; i++)
+         d.push_back(i);
+      bool inOrder = true;
+      // exercise
+      for (int i = 0; i < 100; i++)
+      {
+         inOrder &= (d.front() == i);
+         d.pop_front();
+      }
+      // verify
+      assertUnit(inOrder);
+      assertUnit(d.empty());
+      assertUnit(d.numBlocksResident() == 0);
+   }  // teardown
+
+   // entering a block starts reading the window back
+   void test_popfront_prefetch()
+   {  // setup
+      Deque d(4 * blockBytes, 1);
+      for (int i = 0; i < 40; i++)
+         d.push_back(i);
+      // exercise
+      for (int i = 0; i < 8; i++)
+         d.pop_front();
+      // verify
+      assertUnit(d.blocks[0]->state == Deque::RESIDENT);
+      assertUnit(d.blocks[1]->state != Deque::SPILLED);
+      assertUnit(d.blocks[1]->p != nullptr);
+      assertUnit(d.blocks[1]->slot != 0);
+      assertUnit(d.front() == 8);
+      d.pop_front();
+      assertUnit(d.front() == 9);
+   }  // teardown
+
+   // a block read back and spilled again is not written again
+   void test_popfront_noRewrite()
+   {  // setup
+      Deque d(4 * blockBytes, 1);
+      for (int i = 0; i < 40; i++)
+         d.push_back(i);
+      for (int i = 0; i < 8; i++)
+         d.pop_front();
+      uint64_t slot = d.blocks[1]->slot;
+      d.waitResident(d.blocks[1]);
+      // exercise
+      d.spill(d.blocks[1]);
+      // verify
+      assertUnit(d.blocks[1]->slot == slot);
+      assertUnit(d.numSlots == 6);
+      for (int i = 8; i < 40; i++)
+      {
+         assertUnit(d.front() == i);
+         d.pop_front();
+      }
+   }  // teardown
+
+   // slots of popped blocks are reused
+   void test_popfront_reuseSlots()
+   {  // setup
+      Deque d(4 * blockBytes, 1);
+      for (int i = 0; i < 40; i++)
+         d.push_back(i);
+      while (!d.empty())
+         d.pop_front();
+      // exercise
+      for (int i = 0; i < 40; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(d.numSlots == 6);
+      assertUnit(d.freeSlots.empty());
+      assertUnit(d.front() == 0);
+   }  // teardown
+
+   // a block that cannot be read back is read again on the next pop
+   void test_popfront_readFailsThenRetry()
+   {  // setup
+      Deque d(4 * blockBytes, 1);
+      for (int i = 0; i < 40; i++)
+         d.push_back(i);
+      int fdGood = d.fd;
+      {
+         std::lock_guard<std::mutex> lock(d.mutex);
+         d.fd = ::open("/dev/null", O_WRONLY);
+      }
+      bool thrown = false;
+      try
+      {
+         while (!d.empty())
+         {
+            d.front();
+            d.pop_front();
+         }
+      }
+      catch (const std::system_error&)
+      {
+         thrown = true;
+      }
+      {
+         // let the reads already queued finish on the bad descriptor
+         std::unique_lock<std::mutex> lock(d.mutex);
+         d.cvDone.wait(lock, [&d]
+         {
+            for (size_t ib = 0; ib < d.blocks.size(); ib++)
+               if (d.blocks[(int)ib]->state.load() == Deque::LOADING)
+                  return false;
+            return d.loads.empty();
+         });
+         ::close(d.fd);
+         d.fd = fdGood;
+      }
+      int next = 40 - (int)d.size();
+      bool inOrder = true;
+      // exercise
+      while (!d.empty())
+      {
+         inOrder &= (d.front() == next++);
+         d.pop_front();
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(inOrder);
+      assertUnit(next == 40);
+      assertUnit(d.numBlocksResident() == 0);
+   }  // teardown
+
+   // pushes and pops in bursts agree with std::deque
+   void test_random_againstStd()
+   {  // setup
+      Deque d(6 * blockBytes, 2);
+      std::deque<int> expected;
+      std::mt19937 random(26);
+      int next = 0;
+      bool same = true;
+      // exercise
+      for (int burst = 0; burst < 200; burst++)
+      {
+         int numPush = (int)(random() % 40);
+         for (int i = 0; i < numPush; i++)
+         {
+            d.push_back(next);
+            expected.push_back(next++);
+         }
+         int numPop = (int)(random() % 40);
+         for (int i = 0; i < numPop && !expected.empty(); i++)
+         {
+            same &= (d.front() == expected.front());
+            d.pop_front();
+            expected.pop_front();
+         }
+         same &= (d.size() == expected.size());
+         same &= (d.numBlocksResident() <= d.maxResident);
+      }
+      // verify
+      assertUnit(same);
+   }  // teardown
+};
+
+#endif // DEQUE_POSIX
+#endif // DEBUG
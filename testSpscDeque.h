@@ -0,0 +1,168 @@
+/***********************************************************************
+ * Header:
+ *    TEST SPSC DEQUE
+ * Summary:
+ *    Unit tests for the single-producer, single-consumer deque
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "spscDeque.h"  // class under test
+#include "unitTest.h"   // unit test baseclass
+#include "spy.h"        // for the Spy class
+
+#include <thread>
+
+/***********************************************
+ * TEST SPSC DEQUE
+ * Unit tests for spsc_deque
+ ***********************************************/
+class TestSpscDeque : public UnitTest
+{
+   // four cells to a block so a short deque spans several blocks
+   typedef custom::spsc_deque<int, std::allocator<int>, 4> Deque;
+
+public:
+   void run()
+   {
+      reset();
+
+      // Push and pop
+      test_pop_empty();
+      test_push_standard();
+      test_push_betweenBlocks();
+      test_pop_spareBlock();
+      test_destruct_spy();
+
+      // Threads
+      test_threads_order();
+
+      report("SpscDeque");
+   }
+
+   /***************************************
+    * PUSH AND POP
+    ***************************************/
+
+   // nothing to pop
+   void test_pop_empty()
+   {  // setup
+      Deque d;
+      int value = 99;
+      // exercise
+      bool popped = d.pop_front(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+      assertUnit(d.empty());
+   }  // teardown
+
+   // first in, first out within a block
+   void test_push_standard()
+   {  // setup
+      Deque d;
+      int value = 0;
+      // exercise
+      d.push_back(11);
+      d.push_back(26);
+      d.push_back(31);
+      // verify
+      assertUnit(d.size() == 3);
+      assertUnit(d.pop_front(value) && value == 11);
+      assertUnit(d.pop_front(value) && value == 26);
+      assertUnit(d.pop_front(value) && value == 31);
+      assertUnit(!d.pop_front(value));
+   }  // teardown
+
+   // the producer chains on new blocks as it goes
+   void test_push_betweenBlocks()
+   {  // setup
+      Deque d;
+      // exercise
+      for (int i = 0; i < 10; i++)
+         d.push_back(i);
+      // verify
+      //   +----+----+----+----+   +----+----+----+----+   +----+----+----+----+
+      //   | 0  | 1  | 2  | 3  |-->| 4  | 5  | 6  | 7  |-->| 8  | 9  |    |    |
+      //   +----+----+----+----+   +----+----+----+----+   +----+----+----+----+
+      assertUnit(d.size() == 10);
+      assertUnit(d.pFront->next != nullptr);
+      assertUnit(d.pFront->next->next == d.pBack);
+      assertUnit(d.pBack->next == nullptr);
+      int value = -1;
+      for (int i = 0; i < 10; i++)
+         assertUnit(d.pop_front(value) && value == i);
+      assertUnit(d.empty());
+   }  // teardown
+
+   // an emptied block goes back to the producer for the next block
+   void test_pop_spareBlock()
+   {  // setup
+      Deque d;
+      for (int i = 0; i < 5; i++)
+         d.push_back(i);
+      auto* pFirst = d.pFront;
+      int value = -1;
+      // exercise
+      for (int i = 0; i < 5; i++)
+         d.pop_front(value);
+      // verify
+      assertUnit(d.spare.load() == pFirst);
+      for (int i = 5; i < 9; i++)
+         d.push_back(i);
+      assertUnit(d.pBack == pFirst);
+      assertUnit(d.spare.load() == nullptr);
+      for (int i = 5; i < 9; i++)
+         assertUnit(d.pop_front(value) && value == i);
+   }  // teardown
+
+   // whatever was not popped is destroyed with the deque
+   void test_destruct_spy()
+   {  // setup
+      {
+         custom::spsc_deque<Spy, std::allocator<Spy>, 4> d;
+         for (int i = 0; i < 10; i++)
+            d.push_back(Spy(i));
+         Spy s;
+         d.pop_front(s);
+         d.pop_front(s);
+         Spy::reset();
+      }  // exercise
+      // verify
+      assertUnit(Spy::numDestructor() == 9);  // 2 ... 9 and s
+      assertUnit(Spy::numDelete() == 9);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // one thread pushes, the other sees every element in order
+   void test_threads_order()
+   {  // setup
+      Deque d;
+      const int num = 200000;
+      bool inOrder = true;
+      // exercise
+      std::thread consumer([&]
+      {
+         int expected = 0;
+         int value;
+         while (expected < num)
+            if (d.pop_front(value))
+               inOrder &= (value == expected++);
+      });
+      for (int i = 0; i < num; i++)
+         d.push_back(i);
+      consumer.join();
+      // verify
+      assertUnit(inOrder);
+      assertUnit(d.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,219 @@
+/***********************************************************************
+ * Header:
+ *    TEST WORK STEALING DEQUE
+ * Summary:
+ *    Unit tests for the work-stealing deque and the epoch domain
+ * Author:
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "workStealingDeque.h"  // class under test
+#include "unitTest.h"           // unit test baseclass
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+/***********************************************
+ * TEST WORK STEALING DEQUE
+ * Unit tests for ws_deque
+ ***********************************************/
+class TestWorkStealingDeque : public UnitTest
+{
+   // four cells to a block so a short deque grows often
+   typedef custom::ws_deque<int, 4> Deque;
+
+public:
+   void run()
+   {
+      reset();
+
+      // Owner and thief
+      test_pop_empty();
+      test_pop_lifo();
+      test_steal_fifo();
+      test_steal_lastElement();
+
+      // Grow
+      test_grow_keepsBlocks();
+      test_grow_wrapped();
+      test_grow_retire();
+
+      // Threads
+      test_threads_everyOnce();
+
+      report("WsDeque");
+   }
+
+   /***************************************
+    * OWNER AND THIEF
+    ***************************************/
+
+   // nothing to pop or steal
+   void test_pop_empty()
+   {  // setup
+      Deque d;
+      int value = 99;
+      // exercise and verify
+      assertUnit(!d.pop_back(value));
+      assertUnit(!d.steal(value));
+      assertUnit(value == 99);
+      assertUnit(d.idFront == 0);
+      assertUnit(d.idBack == 0);
+   }  // teardown
+
+   // the owner works last in, first out
+   void test_pop_lifo()
+   {  // setup
+      Deque d;
+      for (int i = 0; i < 6; i++)
+         d.push_back(i);
+      int value = -1;
+      // exercise and verify
+      for (int i = 5; i >= 0; i--)
+         assertUnit(d.pop_back(value) && value == i);
+      assertUnit(!d.pop_back(value));
+      assertUnit(d.empty());
+   }  // teardown
+
+   // thieves take the oldest first
+   void test_steal_fifo()
+   {  // setup
+      Deque d;
+      for (int i = 0; i < 6; i++)
+         d.push_back(i);
+      int value = -1;
+      // exercise and verify
+      assertUnit(d.steal(value) && value == 0);
+      assertUnit(d.steal(value) && value == 1);
+      assertUnit(d.pop_back(value) && value == 5);
+      assertUnit(d.size() == 3);
+   }  // teardown
+
+   // the owner can still pop the last element after steals
+   void test_steal_lastElement()
+   {  // setup
+      Deque d;
+      d.push_back(11);
+      d.push_back(26);
+      int value = -1;
+      d.steal(value);
+      // exercise
+      bool popped = d.pop_back(value);
+      // verify
+      assertUnit(popped);
+      assertUnit(value == 26);
+      assertUnit(!d.steal(value));
+      assertUnit(d.idFront == 2);
+      assertUnit(d.idBack == 2);
+   }  // teardown
+
+   /***************************************
+    * GROW
+    ***************************************/
+
+   // the old blocks move into the new map at the same ids
+   void test_grow_keepsBlocks()
+   {  // setup
+      //   +----+----+----+----+   +----+----+----+----+
+      //   | 0  | 1  | 2  | 3  |   |    |    |    |    |
+      //   +----+----+----+----+   +----+----+----+----+
+      Deque d;
+      for (int i = 0; i < 4; i++)
+         d.push_back(i);
+      std::atomic<int>* pBlock0 = d.pMap.load()->blocks[0];
+      std::atomic<int>* pBlock1 = d.pMap.load()->blocks[1];
+      // exercise
+      d.push_back(4);
+      // verify
+      assertUnit(d.pMap.load()->numBlocks == 4);
+      assertUnit(d.pMap.load()->blocks[0] == pBlock0);
+      assertUnit(d.pMap.load()->blocks[1] == pBlock1);
+      int value = -1;
+      for (int i = 0; i < 5; i++)
+         assertUnit(d.steal(value) && value == i);
+   }  // teardown
+
+   // grow while the front is part way around the map
+   void test_grow_wrapped()
+   {  // setup
+      Deque d;
+      int value = -1;
+      for (int i = 0; i < 6; i++)
+         d.push_back(i);
+      for (int i = 0; i < 5; i++)
+         d.steal(value);
+      // exercise
+      for (int i = 6; i < 20; i++)
+         d.push_back(i);
+      // verify
+      assertUnit(d.size() == 15);
+      for (int i = 5; i < 20; i++)
+         assertUnit(d.steal(value) && value == i);
+   }  // teardown
+
+   // a map is not freed while a guard from before it was retired is out
+   void test_grow_retire()
+   {  // setup
+      Deque d;
+      {
+         custom::epoch_guard guard;
+         // exercise
+         for (int i = 0; i < 64; i++)
+            d.push_back(i);
+         // verify
+         assertUnit(d.retired.size() >= 2);
+      }
+      for (int i = 0; i < 3; i++)
+         d.reclaim();
+      assertUnit(d.retired.empty());
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // with thieves at work every element is taken exactly once
+   void test_threads_everyOnce()
+   {  // setup
+      Deque d;
+      const int num = 100000;
+      std::vector<std::atomic<int>> taken(num);
+      for (std::atomic<int>& t : taken)
+         t.store(0);
+      std::atomic<bool> done(false);
+      // exercise
+      std::vector<std::thread> thieves;
+      for (int t = 0; t < 3; t++)
+         thieves.emplace_back([&]
+         {
+            int value;
+            while (!done.load() || !d.empty())
+               if (d.steal(value))
+                  taken[value]++;
+         });
+      int value;
+      for (int i = 0; i < num; i++)
+      {
+         d.push_back(i);
+         if (i % 4 == 0 && d.pop_back(value))
+            taken[value]++;
+      }
+      while (d.pop_back(value))
+         taken[value]++;
+      done.store(true);
+      for (std::thread& thief : thieves)
+         thief.join();
+      // verify
+      int numWrong = 0;
+      for (std::atomic<int>& t : taken)
+         numWrong += (t.load() != 1);
+      assertUnit(numWrong == 0);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,272 @@
+/***********************************************************************
+ * Header:
+ *    WORK STEALING DEQUE
+ * Summary:
+ *    A Chase-Lev work-stealing deque. The thread that owns it pushes
+ *    and pops at the back without a lock; any other thread may steal
+ *    from the front. A steal and the owner only contend for the last
+ *    element.
+ *
+ *    The storage is the deque's: a circular map of fixed-size blocks.
+ *    Growing doubles the map but not the elements. Every old block
+ *    moves into the new map at the slot its indices land in, and
+ *    fresh blocks fill the rest. A thief still reading the old map
+ *    therefore reads the same blocks as one reading the new map. No
+ *    block is freed until the deque is. Only the old map itself is
+ *    retired, and the epoch domain frees it once no thief can be
+ *    looking at it.
+ *
+ *    Elements are read by thieves that may lose the race for them, so
+ *    T must be trivially copyable (a task pointer, typically).
+ *
+ *    This will contain the class definition of:
+ *        ws_deque : A work-stealing deque
+ * Author
+ *    Nathan Bird, Brock Hoskins
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>      // for std::atomic
+#include <cstddef>     // for size_t, ptrdiff_t
+#include <cstdint>     // for int64_t
+#include <type_traits> // for std::is_trivially_copyable
+#include <utility>     // for std::pair
+#include <vector>      // for the retired maps
+#include "epoch.h"     // for epoch_guard
+#include "deque.h"     // for deque_block
+
+class TestWorkStealingDeque;  // forward declaration for the unit test class
+
+namespace custom
+{
+
+/******************************************************
+ * WS DEQUE
+ * push_back and pop_back from the owner thread only,
+ * steal from any thread. BS cells to a block.
+ *****************************************************/
+   template <typename T, size_t BS = deque_block<T>::numCells>
+   class ws_deque
+   {
+      friend class ::TestWorkStealingDeque; // give unit tests access to the privates
+      static_assert(std::is_trivially_copyable<T>::value, "thieves copy elements they may not win");
+      static_assert(isPowerOfTwo(BS), "block size must be a power of two");
+
+      typedef std::atomic<T> cell;
+
+      // the blocks, indexed by id / BS modulo numBlocks. Never changes once published
+      struct map
+      {
+         size_t numBlocks;   // a power of two
+         cell** blocks;
+
+         explicit map(size_t numBlocks) : numBlocks(numBlocks), blocks(new cell*[numBlocks]) {}
+         ~map() { delete [] blocks; }
+         size_t capacity() const { return numBlocks * BS; }
+         cell& operator [] (int64_t id) const
+         {
+            return blocks[(size_t)(id / (int64_t)BS) & (numBlocks - 1)][(size_t)id & (BS - 1)];
+         }
+      };
+
+   public:
+      explicit ws_deque(size_t numBlocks = 2);
+      ws_deque(const ws_deque&) = delete;
+      ws_deque& operator = (const ws_deque&) = delete;
+      ~ws_deque();
+
+      //
+      // Owner
+      //
+      void push_back(T t);
+      bool pop_back(T& t);
+
+      //
+      // Thieves. False when empty or when another thread won the front
+      //
+      bool steal(T& t);
+
+      //
+      // Status: a snapshot
+      //
+      size_t size() const
+      {
+         int64_t b = idBack.load(std::memory_order_relaxed);
+         int64_t f = idFront.load(std::memory_order_relaxed);
+         return b > f ? (size_t)(b - f) : 0;
+      }
+      bool empty() const { return size() == 0; }
+
+   private:
+      map* grow(map* pOld, int64_t f);
+      void reclaim();
+
+      alignas(64) std::atomic<int64_t> idFront;  // next id to steal
+      alignas(64) std::atomic<int64_t> idBack;   // next id to push
+      std::atomic<map*> pMap;                    // the current map
+
+      // owner only: maps thieves may still be reading, with the epoch they left in
+      std::vector<std::pair<uint64_t, map*>> retired;
+   };
+
+   /*****************************************
+    * WS DEQUE :: CONSTRUCTOR
+    ****************************************/
+   template <typename T, size_t BS>
+   ws_deque <T, BS> ::ws_deque(size_t numBlocks)
+      : idFront(0), idBack(0), pMap(nullptr)
+   {
+      // at least two: one block is always kept free
+      size_t numBlocksPow = 2;
+      while (numBlocksPow < numBlocks)
+         numBlocksPow *= 2;
+      map* p = new map(numBlocksPow);
+      for (size_t ib = 0; ib < p->numBlocks; ib++)
+         p->blocks[ib] = new cell[BS];
+      pMap.store(p, std::memory_order_relaxed);
+   }
+
+   /*****************************************
+    * WS DEQUE :: DESTRUCTOR
+    * No thread may be stealing. The blocks all
+    * live in the current map
+    ****************************************/
+   template <typename T, size_t BS>
+   ws_deque <T, BS> ::~ws_deque()
+   {
+      map* p = pMap.load(std::memory_order_relaxed);
+      for (size_t ib = 0; ib < p->numBlocks; ib++)
+         delete [] p->blocks[ib];
+      delete p;
+      for (std::pair<uint64_t, map*>& old : retired)
+         delete old.second;
+   }
+
+   /*****************************************
+    * WS DEQUE :: PUSH BACK
+    * Owner only. Grow first if the back would reach
+    * the front's block
+    ****************************************/
+   template <typename T, size_t BS>
+   void ws_deque <T, BS> ::push_back(T t)
+   {
+      int64_t b = idBack.load(std::memory_order_relaxed);
+      int64_t f = idFront.load(std::memory_order_acquire);
+      map* p = pMap.load(std::memory_order_relaxed);
+
+      // keep a block free so no block holds two laps of ids
+      if (b - f >= (int64_t)(p->capacity() - BS))
+         p = grow(p, f);
+
+      (*p)[b].store(t, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      idBack.store(b + 1, std::memory_order_relaxed);
+   }
+
+   /*****************************************
+    * WS DEQUE :: POP BACK
+    * Owner only. Claim the back, then race the
+    * thieves only if it is also the front
+    ****************************************/
+   template <typename T, size_t BS>
+   bool ws_deque <T, BS> ::pop_back(T& t)
+   {
+      int64_t b = idBack.load(std::memory_order_relaxed) - 1;
+      map* p = pMap.load(std::memory_order_relaxed);
+      idBack.store(b, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t f = idFront.load(std::memory_order_relaxed);
+
+      bool popped = true;
+      if (f <= b)
+      {
+         t = (*p)[b].load(std::memory_order_relaxed);
+         if (f == b)
+         {
+            // the last one: a thief may be after it too
+            if (!idFront.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst,
+                                                            std::memory_order_relaxed))
+               popped = false;
+            idBack.store(b + 1, std::memory_order_relaxed);
+         }
+      }
+      else
+      {
+         popped = false;
+         idBack.store(b + 1, std::memory_order_relaxed);
+      }
+      return popped;
+   }
+
+   /*****************************************
+    * WS DEQUE :: STEAL
+    * Any thread. Read the front, then claim it. The
+    * guard keeps the map we read alive until we are done
+    ****************************************/
+   template <typename T, size_t BS>
+   bool ws_deque <T, BS> ::steal(T& t)
+   {
+      epoch_guard guard;
+      int64_t f = idFront.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t b = idBack.load(std::memory_order_acquire);
+      if (f >= b)
+         return false;
+
+      map* p = pMap.load(std::memory_order_acquire);
+      T value = (*p)[f].load(std::memory_order_relaxed);
+      if (!idFront.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst,
+                                                      std::memory_order_relaxed))
+         return false;
+      t = value;
+      return true;
+   }
+
+   /*****************************************
+    * WS DEQUE :: GROW
+    * Owner only. Double the map, moving every old
+    * block to the slot its ids land in from the
+    * front's block on, then retire the old map
+    ****************************************/
+   template <typename T, size_t BS>
+   auto ws_deque <T, BS> ::grow(map* pOld, int64_t f) -> map*
+   {
+      map* pNew = new map(pOld->numBlocks * 2);
+      for (size_t ib = 0; ib < pNew->numBlocks; ib++)
+         pNew->blocks[ib] = nullptr;
+
+      // the old blocks hold ids from the front's block through the back's
+      int64_t kFirst = f / (int64_t)BS;
+      for (int64_t k = kFirst; k < kFirst + (int64_t)pOld->numBlocks; k++)
+         pNew->blocks[(size_t)k & (pNew->numBlocks - 1)] = pOld->blocks[(size_t)k & (pOld->numBlocks - 1)];
+      for (size_t ib = 0; ib < pNew->numBlocks; ib++)
+         if (!pNew->blocks[ib])
+            pNew->blocks[ib] = new cell[BS];
+
+      pMap.store(pNew, std::memory_order_release);
+      retired.push_back(std::make_pair(epoch_domain::instance().current(), pOld));
+      reclaim();
+      return pNew;
+   }
+
+   /*****************************************
+    * WS DEQUE :: RECLAIM
+    * Owner only. Free the retired maps no thief
+    * can still be reading
+    ****************************************/
+   template <typename T, size_t BS>
+   void ws_deque <T, BS> ::reclaim()
+   {
+      epoch_domain& domain = epoch_domain::instance();
+      domain.tryAdvance();
+      size_t iKeep = 0;
+      for (size_t i = 0; i < retired.size(); i++)
+         if (domain.isSafe(retired[i].first))
+            delete retired[i].second;
+         else
+            retired[iKeep++] = retired[i];
+      retired.resize(iKeep);
+   }
+
+} // namespace custom